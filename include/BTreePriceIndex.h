@@ -0,0 +1,427 @@
+/**
+ * @file BTreePriceIndex.h
+ * @brief Cache-conscious B+-tree keyed by price, a drop-in for the book's std::map
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+
+namespace OrderBook {
+
+    /**
+     * @class BTreePriceIndex
+     * @brief Ordered price -> value index with cache-line key blocks
+     *
+     * Each node keeps its sorted keys and count in one 64-byte line, so a
+     * search step reads one line and then one child pointer. Leaves hold
+     * pointers to separately allocated (price, value) entries, so
+     * references stay valid across inserts and erases as with std::map,
+     * and are linked both ways for iteration. The first and last leaves
+     * are tracked, making begin() and rbegin() (best ask, best bid) O(1).
+     *
+     * Erase frees a leaf once it is empty and prunes inner nodes that lose
+     * their last child, but does not merge underfull siblings: book levels
+     * churn near the touch, where empty leaves are reclaimed promptly.
+     *
+     * Provides the subset of the std::map interface the order book uses.
+     * Nodes and entries come from the allocator's memory resource, and the
+     * value is constructed with it when it is allocator-aware.
+     */
+    template<typename V>
+    class BTreePriceIndex {
+    public:
+        using key_type = uint64_t;
+        using mapped_type = V;
+        using value_type = std::pair<const uint64_t, V>;
+        using size_type = size_t;
+        using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+
+        static constexpr uint32_t kMaxKeys = 7;   ///< Keys per node (fills the first cache line)
+
+    private:
+        struct alignas(64) Node {
+            uint64_t keys[kMaxKeys];              ///< Sorted; separators in inner nodes
+            uint32_t count = 0;                   ///< Keys in use
+            bool leaf = true;
+            void* slots[kMaxKeys + 1] = {};       ///< Children (count + 1) or entries (count)
+            Node* parent = nullptr;
+            Node* prev = nullptr;                 ///< Leaf chain
+            Node* next = nullptr;
+
+            Node* child(uint32_t i) const { return static_cast<Node*>(slots[i]); }
+            value_type* entry(uint32_t i) const { return static_cast<value_type*>(slots[i]); }
+        };
+
+    public:
+        template<bool Const>
+        class Iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = BTreePriceIndex::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+            Iterator() = default;
+            Iterator(const BTreePriceIndex* tree, Node* leaf, uint32_t index)
+                : tree_(tree), leaf_(leaf), index_(index) {}
+
+            // Mutable to const conversion
+            template<bool C = Const, typename = std::enable_if_t<C>>
+            Iterator(const Iterator<false>& other) : tree_(other.tree_), leaf_(other.leaf_), index_(other.index_) {}
+
+            reference operator*() const { return *leaf_->entry(index_); }
+            pointer operator->() const { return leaf_->entry(index_); }
+
+            Iterator& operator++() {
+                if (++index_ >= leaf_->count) {
+                    leaf_ = leaf_->next;
+                    index_ = 0;
+                }
+                return *this;
+            }
+
+            Iterator& operator--() {
+                if (!leaf_) {
+                    leaf_ = tree_->last_leaf_;
+                    index_ = leaf_->count - 1;
+                } else if (index_ == 0) {
+                    leaf_ = leaf_->prev;
+                    index_ = leaf_->count - 1;
+                } else {
+                    --index_;
+                }
+                return *this;
+            }
+
+            Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+            Iterator operator--(int) { Iterator old = *this; --*this; return old; }
+
+            bool operator==(const Iterator& other) const { return leaf_ == other.leaf_ && index_ == other.index_; }
+            bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+        private:
+            friend class BTreePriceIndex;
+            friend class Iterator<!Const>;
+            const BTreePriceIndex* tree_ = nullptr;
+            Node* leaf_ = nullptr;                ///< nullptr at end()
+            uint32_t index_ = 0;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        explicit BTreePriceIndex(const allocator_type& alloc = {}) : alloc_(alloc) {}
+        ~BTreePriceIndex() { clear(); }
+
+        BTreePriceIndex(const BTreePriceIndex&) = delete;
+        BTreePriceIndex& operator=(const BTreePriceIndex&) = delete;
+
+        iterator begin() { return iterator(this, first_leaf_, 0); }
+        iterator end() { return iterator(this, nullptr, 0); }
+        const_iterator begin() const { return const_iterator(this, first_leaf_, 0); }
+        const_iterator end() const { return const_iterator(this, nullptr, 0); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        bool empty() const { return size_ == 0; }
+        size_type size() const { return size_; }
+
+        iterator find(uint64_t key) {
+            auto [leaf, index] = locate(key);
+            return (leaf && index < leaf->count && leaf->keys[index] == key) ? iterator(this, leaf, index) : end();
+        }
+
+        const_iterator find(uint64_t key) const {
+            return const_cast<BTreePriceIndex*>(this)->find(key);
+        }
+
+        /**
+         * @brief First entry with price >= key
+         */
+        iterator lower_bound(uint64_t key) {
+            auto [leaf, index] = locate(key);
+            if (!leaf) return end();
+            return index < leaf->count ? iterator(this, leaf, index) : iterator(this, leaf->next, 0);
+        }
+
+        /**
+         * @brief Insert (key, V(args...)) unless key is present
+         * @return Iterator to the entry for key, and whether it was inserted
+         */
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(uint64_t key, Args&&... args) {
+            if (!root_) {
+                root_ = first_leaf_ = last_leaf_ = newNode(true);
+            }
+            auto [leaf, index] = locate(key);
+            if (index < leaf->count && leaf->keys[index] == key) {
+                return {iterator(this, leaf, index), false};
+            }
+
+            value_type* entry = alloc_.allocate(1);
+            alloc_.construct(entry, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+            size_++;
+
+            if (leaf->count < kMaxKeys) {
+                insertAt(leaf, index, key, entry);
+                return {iterator(this, leaf, index), true};
+            }
+            return {splitLeaf(leaf, index, key, entry), true};
+        }
+
+        /**
+         * @brief Remove the entry at pos
+         * @return Iterator to the following entry
+         */
+        iterator erase(const_iterator pos) {
+            Node* leaf = pos.leaf_;
+            uint32_t index = pos.index_;
+            destroyEntry(leaf->entry(index));
+            size_--;
+
+            for (uint32_t i = index + 1; i < leaf->count; ++i) {
+                leaf->keys[i - 1] = leaf->keys[i];
+                leaf->slots[i - 1] = leaf->slots[i];
+            }
+            leaf->count--;
+
+            if (leaf->count > 0) {
+                return index < leaf->count ? iterator(this, leaf, index) : iterator(this, leaf->next, 0);
+            }
+            Node* next = leaf->next;
+            removeLeaf(leaf);
+            return iterator(this, next, 0);
+        }
+
+        void clear() {
+            if (root_) destroySubtree(root_);
+            root_ = first_leaf_ = last_leaf_ = nullptr;
+            size_ = 0;
+        }
+
+        /**
+         * @brief Tree height (1 for a single leaf, 0 when empty)
+         */
+        size_t height() const {
+            size_t h = 0;
+            for (Node* n = root_; n; n = n->leaf ? nullptr : n->child(0)) h++;
+            return h;
+        }
+
+    private:
+        allocator_type alloc_;
+        Node* root_ = nullptr;
+        Node* first_leaf_ = nullptr;
+        Node* last_leaf_ = nullptr;
+        size_type size_ = 0;
+
+        /**
+         * @brief Number of keys in a node that are <= key (inner) or < key (leaf)
+         */
+        static uint32_t rank(const Node* node, uint64_t key, bool inclusive) {
+            uint32_t r = 0;
+            for (uint32_t i = 0; i < node->count; ++i) {
+                r += inclusive ? (node->keys[i] <= key) : (node->keys[i] < key);
+            }
+            return r;
+        }
+
+        /**
+         * @brief Leaf that owns key and the key's insertion position in it
+         */
+        std::pair<Node*, uint32_t> locate(uint64_t key) const {
+            Node* node = root_;
+            if (!node) return {nullptr, 0};
+            while (!node->leaf) {
+                node = node->child(rank(node, key, true));
+            }
+            return {node, rank(node, key, false)};
+        }
+
+        Node* newNode(bool leaf) {
+            void* memory = alloc_.resource()->allocate(sizeof(Node), alignof(Node));
+            Node* node = new (memory) Node();
+            node->leaf = leaf;
+            return node;
+        }
+
+        void freeNode(Node* node) {
+            node->~Node();
+            alloc_.resource()->deallocate(node, sizeof(Node), alignof(Node));
+        }
+
+        void destroyEntry(value_type* entry) {
+            entry->~value_type();
+            alloc_.deallocate(entry, 1);
+        }
+
+        void destroySubtree(Node* node) {
+            if (node->leaf) {
+                for (uint32_t i = 0; i < node->count; ++i) destroyEntry(node->entry(i));
+            } else {
+                for (uint32_t i = 0; i <= node->count; ++i) destroySubtree(node->child(i));
+            }
+            freeNode(node);
+        }
+
+        static void insertAt(Node* leaf, uint32_t index, uint64_t key, value_type* entry) {
+            for (uint32_t i = leaf->count; i > index; --i) {
+                leaf->keys[i] = leaf->keys[i - 1];
+                leaf->slots[i] = leaf->slots[i - 1];
+            }
+            leaf->keys[index] = key;
+            leaf->slots[index] = entry;
+            leaf->count++;
+        }
+
+        iterator splitLeaf(Node* leaf, uint32_t index, uint64_t key, value_type* entry) {
+            // Merge the new entry into a full leaf's contents, then split evenly
+            uint64_t keys[kMaxKeys + 1];
+            void* slots[kMaxKeys + 1];
+            for (uint32_t i = 0, j = 0; i <= kMaxKeys; ++i) {
+                if (i == index) {
+                    keys[i] = key;
+                    slots[i] = entry;
+                } else {
+                    keys[i] = leaf->keys[j];
+                    slots[i] = leaf->slots[j++];
+                }
+            }
+
+            Node* right = newNode(true);
+            const uint32_t left_count = (kMaxKeys + 1) / 2;
+            leaf->count = left_count;
+            right->count = kMaxKeys + 1 - left_count;
+            for (uint32_t i = 0; i < left_count; ++i) {
+                leaf->keys[i] = keys[i];
+                leaf->slots[i] = slots[i];
+            }
+            for (uint32_t i = 0; i < right->count; ++i) {
+                right->keys[i] = keys[left_count + i];
+                right->slots[i] = slots[left_count + i];
+            }
+
+            right->next = leaf->next;
+            right->prev = leaf;
+            if (leaf->next) leaf->next->prev = right; else last_leaf_ = right;
+            leaf->next = right;
+
+            insertIntoParent(leaf, right->keys[0], right);
+            return index < left_count ? iterator(this, leaf, index) : iterator(this, right, index - left_count);
+        }
+
+        void insertIntoParent(Node* left, uint64_t separator, Node* right) {
+            Node* parent = left->parent;
+            if (!parent) {
+                Node* root = newNode(false);
+                root->keys[0] = separator;
+                root->slots[0] = left;
+                root->slots[1] = right;
+                root->count = 1;
+                left->parent = right->parent = root;
+                root_ = root;
+                return;
+            }
+
+            uint32_t at = 0;
+            while (parent->child(at) != left) ++at;
+
+            if (parent->count < kMaxKeys) {
+                for (uint32_t i = parent->count; i > at; --i) {
+                    parent->keys[i] = parent->keys[i - 1];
+                    parent->slots[i + 1] = parent->slots[i];
+                }
+                parent->keys[at] = separator;
+                parent->slots[at + 1] = right;
+                parent->count++;
+                right->parent = parent;
+                return;
+            }
+
+            // Full inner node: merge, push the middle key up, split the rest
+            uint64_t keys[kMaxKeys + 1];
+            void* children[kMaxKeys + 2];
+            for (uint32_t i = 0, j = 0; i <= kMaxKeys; ++i) {
+                keys[i] = (i == at) ? separator : parent->keys[j++];
+            }
+            for (uint32_t i = 0, j = 0; i <= kMaxKeys + 1; ++i) {
+                children[i] = (i == at + 1) ? static_cast<void*>(right) : parent->slots[j++];
+            }
+
+            const uint32_t middle = (kMaxKeys + 1) / 2;
+            Node* sibling = newNode(false);
+            parent->count = middle;
+            for (uint32_t i = 0; i < middle; ++i) parent->keys[i] = keys[i];
+            for (uint32_t i = 0; i <= middle; ++i) {
+                parent->slots[i] = children[i];
+                static_cast<Node*>(children[i])->parent = parent;
+            }
+            sibling->count = kMaxKeys - middle;
+            for (uint32_t i = 0; i < sibling->count; ++i) sibling->keys[i] = keys[middle + 1 + i];
+            for (uint32_t i = 0; i <= sibling->count; ++i) {
+                sibling->slots[i] = children[middle + 1 + i];
+                static_cast<Node*>(children[middle + 1 + i])->parent = sibling;
+            }
+            for (uint32_t i = middle + 1; i <= kMaxKeys; ++i) parent->slots[i] = nullptr;
+
+            insertIntoParent(parent, keys[middle], sibling);
+        }
+
+        void removeLeaf(Node* leaf) {
+            if (leaf->prev) leaf->prev->next = leaf->next; else first_leaf_ = leaf->next;
+            if (leaf->next) leaf->next->prev = leaf->prev; else last_leaf_ = leaf->prev;
+            removeNode(leaf);
+        }
+
+        /**
+         * @brief Detach an empty node from its parent, pruning upward
+         */
+        void removeNode(Node* node) {
+            Node* parent = node->parent;
+            freeNode(node);
+            if (!parent) {
+                root_ = nullptr;
+                return;
+            }
+
+            uint32_t at = 0;
+            while (parent->child(at) != node) ++at;
+
+            if (parent->count == 0) {
+                // It was the only child
+                removeNode(parent);
+                return;
+            }
+
+            // Drop the child and the separator on its left (or right, for the first child)
+            uint32_t key_at = at > 0 ? at - 1 : 0;
+            for (uint32_t i = key_at + 1; i < parent->count; ++i) parent->keys[i - 1] = parent->keys[i];
+            for (uint32_t i = at + 1; i <= parent->count; ++i) parent->slots[i - 1] = parent->slots[i];
+            parent->slots[parent->count] = nullptr;
+            parent->count--;
+
+            // Collapse a root left with a single child
+            while (root_ && !root_->leaf && root_->count == 0) {
+                Node* only = root_->child(0);
+                freeNode(root_);
+                root_ = only;
+                root_->parent = nullptr;
+            }
+        }
+    };
+
+} // namespace OrderBook
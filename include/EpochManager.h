@@ -0,0 +1,174 @@
+/**
+ * @file EpochManager.h
+ * @brief Epoch-based memory reclamation for lock-free readers
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace OrderBook {
+
+    /**
+     * @class EpochManager
+     * @brief Defers frees until no reader can still hold the object
+     *
+     * Readers bracket lock-free accesses with enter()/exit() (or an
+     * EpochGuard), which only publishes the current global epoch in the
+     * thread's slot. Writers unlink an object and retire() it; it is
+     * tagged with the epoch at retirement and freed once the global epoch
+     * has advanced twice, when every reader that could have seen it has
+     * exited. Retired objects go on the retiring thread's own list, so
+     * neither side takes a lock. retire() only appends, so it is cheap
+     * enough to call under a writer's lock; the epoch scan and the frees
+     * happen in reclaimIfDue() or reclaim(), which the writer calls once
+     * its lock is released.
+     *
+     * Each thread that uses a manager claims one of kMaxThreads slots on
+     * first use and gives it back when the thread exits, so only threads
+     * using the manager at the same time count against the limit. A
+     * released slot keeps its pending retirements; its next owner or the
+     * manager's destructor frees them. The manager must outlive every
+     * thread's use of it, though not the threads themselves; destroying
+     * it frees everything still retired.
+     */
+    class EpochManager {
+    public:
+        static constexpr size_t kMaxThreads = 128;   ///< Slots per manager
+        static constexpr size_t kRetireBatch = 64;   ///< Retirements before reclaimIfDue() works
+
+        EpochManager();
+        ~EpochManager();
+
+        EpochManager(const EpochManager&) = delete;
+        EpochManager& operator=(const EpochManager&) = delete;
+
+        /**
+         * @brief Enter a read-side critical section (nestable)
+         * @throws std::runtime_error if kMaxThreads live threads already hold slots
+         */
+        void enter();
+
+        /**
+         * @brief Leave the read-side critical section
+         */
+        void exit();
+
+        /**
+         * @brief Free an object once no reader can reach it
+         * @param object Pointer already unlinked from every shared structure
+         * @param deleter Called with object when it is safe
+         *
+         * Only queues the object on this thread's list; nothing is freed here.
+         * @throws std::runtime_error if kMaxThreads live threads already hold slots
+         */
+        void retire(void* object, void (*deleter)(void*));
+
+        /**
+         * @brief Drop a shared reference once no reader can reach it
+         * @param object Reference to release (aliasing keeps it allocation-free)
+         */
+        void retire(std::shared_ptr<void> object);
+
+        /**
+         * @brief Retire a heap object of type T
+         */
+        template<typename T>
+        void retire(T* object) {
+            retire(static_cast<void*>(object), [](void* p) { delete static_cast<T*>(p); });
+        }
+
+        /**
+         * @brief Try to advance the epoch and free this thread's safe retirements
+         * @return Number of objects freed
+         */
+        size_t reclaim();
+
+        /**
+         * @brief reclaim(), once this thread has retired kRetireBatch objects since the last one
+         * @return Number of objects freed
+         *
+         * Call where frees are acceptable, e.g. after releasing a lock.
+         */
+        size_t reclaimIfDue();
+
+        /**
+         * @brief Get the global epoch
+         */
+        uint64_t getEpoch() const { return global_epoch_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Get total objects retired
+         */
+        uint64_t getRetiredCount() const { return retired_count_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Get total objects freed
+         */
+        uint64_t getReclaimedCount() const { return reclaimed_count_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Retired {
+            uint64_t epoch;                  ///< Global epoch at retirement
+            void* object;                    ///< Raw object, or nullptr for owner
+            void (*deleter)(void*);
+            std::shared_ptr<void> owner;     ///< Shared reference to drop
+        };
+
+        /**
+         * @brief Per-thread state; only the owning thread touches nesting and limbo
+         */
+        struct alignas(64) Slot {
+            std::atomic<uint64_t> state{0};  ///< (epoch << 1) | active
+            std::atomic<bool> claimed{false};
+            uint32_t nesting = 0;
+            uint32_t since_drain = 0;        ///< Retirements since the last reclaim
+            std::vector<Retired> limbo;      ///< Oldest first
+        };
+
+        const uint64_t id_;                  ///< Distinguishes managers in thread-local caches
+        alignas(64) std::atomic<uint64_t> global_epoch_;
+        std::atomic<uint64_t> retired_count_;
+        std::atomic<uint64_t> reclaimed_count_;
+        std::array<Slot, kMaxThreads> slots_;
+
+        /**
+         * @brief This thread's slot, claiming one on first use
+         *
+         * The claim is recorded in a thread_local list whose destructor
+         * releases it at thread exit, unless the manager is gone by then.
+         */
+        Slot& localSlot();
+
+        /**
+         * @brief Advance the global epoch if every active reader has seen it
+         */
+        bool tryAdvance();
+
+        void push(Retired retired);
+        size_t drain(Slot& slot);
+    };
+
+    /**
+     * @class EpochGuard
+     * @brief RAII read-side critical section
+     */
+    class EpochGuard {
+    public:
+        explicit EpochGuard(EpochManager& epochs) : epochs_(epochs) { epochs_.enter(); }
+        ~EpochGuard() { epochs_.exit(); }
+
+        EpochGuard(const EpochGuard&) = delete;
+        EpochGuard& operator=(const EpochGuard&) = delete;
+
+    private:
+        EpochManager& epochs_;
+    };
+
+} // namespace OrderBook
@@ -0,0 +1,327 @@
+/**
+ * @file EventArchive.h
+ * @brief Segmented, indexed archive of order events and trades for audit lookups
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "JournalCodec.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace OrderBook {
+
+    /**
+     * @struct ArchiveConfig
+     * @brief Where and how an archive is written
+     */
+    struct ArchiveConfig {
+        std::string directory = "archive";
+        uint32_t segment_records = 65536;   ///< Records per segment file
+        uint32_t block_records = 512;       ///< Records per index entry (decode unit)
+        uint32_t bloom_bits_per_key = 10;   ///< Segment bloom size (~1% false positives)
+    };
+
+    /**
+     * @struct ArchiveQueryStats
+     * @brief How much of the archive a lookup had to touch
+     */
+    struct ArchiveQueryStats {
+        size_t segments_total = 0;          ///< Sealed segments in the archive
+        size_t segments_probed = 0;         ///< Segments whose index was read
+        size_t segments_read = 0;           ///< Segments whose data was read
+        size_t blocks_decoded = 0;
+        uint64_t bytes_read = 0;            ///< Index and data bytes read
+
+        ArchiveQueryStats& operator+=(const ArchiveQueryStats& other);
+        std::string toString() const;
+    };
+
+    /**
+     * @struct SegmentSummary
+     * @brief Head of a segment's .idx file; all a reader keeps in memory
+     *
+     * The .idx file is this summary, then one ArchiveBlockEntry per
+     * block, then a fixed-size bloom filter per block, then the bloom
+     * filter over every order ID in the segment. Times are clock ticks
+     * (high_resolution_clock).
+     */
+    struct SegmentSummary {
+        static constexpr uint32_t kMagic = 0x4f425831;   ///< "OBX1"
+
+        uint32_t magic = kMagic;
+        uint8_t kind = 0;                   ///< Codec kKind
+        uint8_t bloom_hashes = 0;
+        uint16_t reserved = 0;
+        uint32_t blocks = 0;
+        uint32_t bloom_words = 0;         ///< Segment filter
+        uint32_t block_bloom_words = 0;   ///< Each block's filter
+        uint32_t reserved2 = 0;
+        uint64_t records = 0;
+        uint64_t data_bytes = 0;
+        int64_t min_time = 0;
+        int64_t max_time = 0;
+        uint64_t min_order_id = 0;
+        uint64_t max_order_id = 0;
+    };
+
+    static_assert(sizeof(SegmentSummary) == 72, "SegmentSummary must stay 72 bytes");
+
+    /**
+     * @struct ArchiveBlockEntry
+     * @brief Sparse index entry: where one block starts and what it covers
+     */
+    struct ArchiveBlockEntry {
+        uint64_t offset = 0;                ///< Block header's offset in the .seg file
+        uint32_t bytes = 0;                 ///< Header plus payload
+        uint32_t records = 0;
+        int64_t min_time = 0;
+        int64_t max_time = 0;
+        uint64_t min_order_id = 0;
+        uint64_t max_order_id = 0;
+    };
+
+    static_assert(sizeof(ArchiveBlockEntry) == 48, "ArchiveBlockEntry must stay 48 bytes");
+
+    /**
+     * @class BloomFilter
+     * @brief Bit array probed by double hashing
+     *
+     * Hashes are mapped onto the bits by multiply-shift, so the array is
+     * sized to keys * bits_per_key (in whole words) rather than rounded
+     * up to a power of two.
+     */
+    class BloomFilter {
+    public:
+        BloomFilter() = default;
+        BloomFilter(size_t keys, uint32_t bits_per_key);
+
+        void add(uint64_t key);
+        bool mayContain(uint64_t key) const;
+
+        /**
+         * @brief Test a filter that is not in memory
+         * @param word Reads word i of the stored filter; called at most hashes times
+         */
+        template<typename ReadWord>
+        static bool mayContain(uint64_t key, size_t word_count, uint32_t hashes, ReadWord&& word);
+
+        const std::vector<uint64_t>& words() const { return words_; }
+        uint32_t hashes() const { return hashes_; }
+
+    private:
+        std::vector<uint64_t> words_;
+        uint32_t hashes_ = 0;
+
+        static uint64_t hash(uint64_t x) {
+            x += 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        static uint64_t bitFor(uint64_t h, size_t word_count) {
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(h) * (word_count * 64)) >> 64);
+        }
+    };
+
+    template<typename ReadWord>
+    bool BloomFilter::mayContain(uint64_t key, size_t word_count, uint32_t hashes, ReadWord&& word) {
+        if (word_count == 0) return false;
+        uint64_t h = hash(key);
+        uint64_t step = hash(h) | 1;
+        for (uint32_t i = 0; i < hashes; ++i, h += step) {
+            uint64_t bit = bitFor(h, word_count);
+            if (!(word(bit >> 6) & (uint64_t(1) << (bit & 63)))) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief What the archive indexes for each record type
+     *
+     * time() and the kOrderIds IDs from forEachOrderId() feed the index;
+     * empty() is a placeholder for decoding into.
+     */
+    template<typename Record>
+    struct ArchiveKeys;
+
+    template<>
+    struct ArchiveKeys<JournalRecord> {
+        static constexpr size_t kOrderIds = 1;
+        static JournalRecord empty() { return JournalRecord{}; }
+        static int64_t time(const JournalRecord& record) { return record.timestamp; }
+
+        template<typename F>
+        static void forEachOrderId(const JournalRecord& record, F&& f) { f(record.order_id); }
+    };
+
+    template<>
+    struct ArchiveKeys<Trade> {
+        static constexpr size_t kOrderIds = 2;
+        static Trade empty() { return Trade(0, 0, 0, 0, {}); }
+        static int64_t time(const Trade& trade) { return trade.timestamp.time_since_epoch().count(); }
+
+        template<typename F>
+        static void forEachOrderId(const Trade& trade, F&& f) {
+            f(trade.buy_order_id);
+            f(trade.sell_order_id);
+        }
+    };
+
+    /**
+     * @class SegmentWriter
+     * @brief Appends one record stream to <prefix>-NNNNNN.seg/.idx files
+     *
+     * Records are block-encoded into the open .seg file. Every
+     * block_records records the block is written out and its time and
+     * order-ID ranges become an index entry, its IDs a block bloom
+     * filter; every segment_records the segment is sealed by writing its
+     * .idx (summary, entries, block filters, segment filter).
+     * The .idx is written under a temporary name and renamed, so readers
+     * only ever see complete segments. Numbering continues after any
+     * segments already in the directory.
+     *
+     * @tparam Codec JournalCodec or TradeCodec
+     * @throws std::runtime_error if a file cannot be written
+     */
+    template<typename Codec>
+    class SegmentWriter {
+    public:
+        using Record = typename Codec::Record;
+        using Keys = ArchiveKeys<Record>;
+
+        SegmentWriter(const ArchiveConfig& config, const std::string& prefix);
+        ~SegmentWriter();
+
+        SegmentWriter(const SegmentWriter&) = delete;
+        SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+        void append(const Record& record) {
+            if (!data_.is_open()) openSegment();
+            encoder_.append(record);
+
+            int64_t time = Keys::time(record);
+            if (block_.records == 0) {
+                block_.min_time = block_.max_time = time;
+                block_.min_order_id = UINT64_MAX;
+                block_.max_order_id = 0;
+            }
+            block_.min_time = std::min(block_.min_time, time);
+            block_.max_time = std::max(block_.max_time, time);
+            Keys::forEachOrderId(record, [this](uint64_t id) {
+                block_.min_order_id = std::min(block_.min_order_id, id);
+                block_.max_order_id = std::max(block_.max_order_id, id);
+                block_ids_.push_back(id);
+            });
+            records_++;
+
+            if (++block_.records == block_records_) writeBlock();
+            if (records_in_segment_ + block_.records == segment_records_) sealSegment();
+        }
+
+        /**
+         * @brief Seal the open segment, if any
+         */
+        void close();
+
+        uint64_t recordCount() const { return records_; }
+        uint32_t segmentsWritten() const { return segments_written_; }
+
+    private:
+        std::string directory_;
+        std::string prefix_;
+        uint32_t segment_records_;
+        uint32_t block_records_;
+        uint32_t bloom_bits_per_key_;
+        uint32_t next_segment_ = 0;
+        uint32_t segments_written_ = 0;
+        uint64_t records_ = 0;
+        uint64_t records_in_segment_ = 0;   ///< Records in written blocks of the open segment
+        std::string segment_path_;          ///< Open segment, without extension
+        std::ofstream data_;
+        BlockEncoder<Codec> encoder_;
+        ArchiveBlockEntry block_;           ///< Open block's ranges
+        std::vector<ArchiveBlockEntry> entries_;
+        std::vector<uint64_t> block_blooms_;        ///< Written blocks' filters, back to back
+        std::vector<uint64_t> block_ids_;
+        std::vector<uint64_t> segment_ids_;
+
+        void openSegment();
+        void writeBlock();
+        void sealSegment();
+    };
+
+    /**
+     * @class EventArchiveWriter
+     * @brief Order-event and trade streams of one engine, side by side
+     *
+     * Events go to events-*.seg and trades to trades-*.seg in the same
+     * directory. Not thread-safe: the engine calls it under its matching
+     * lock. Segments are sealed on close() or destruction.
+     */
+    class EventArchiveWriter {
+    public:
+        explicit EventArchiveWriter(const ArchiveConfig& config = ArchiveConfig());
+
+        void appendEvent(const JournalRecord& record) { events_.append(record); }
+        void appendTrade(const Trade& trade) { trades_.append(trade); }
+
+        void close();
+
+        uint64_t getEventCount() const { return events_.recordCount(); }
+        uint64_t getTradeCount() const { return trades_.recordCount(); }
+        uint32_t getSegmentCount() const { return events_.segmentsWritten() + trades_.segmentsWritten(); }
+
+    private:
+        SegmentWriter<JournalCodec> events_;
+        SegmentWriter<TradeCodec> trades_;
+    };
+
+    /**
+     * @class EventArchiveReader
+     * @brief Answers audit lookups from the sealed segments of an archive
+     *
+     * Only the segment summaries are loaded up front. A by-order lookup
+     * skips segments whose order-ID range or bloom filter rules the ID
+     * out and, in the rest, decodes only blocks whose ID range and bloom
+     * filter admit it.
+     * A by-time lookup decodes only blocks whose time range overlaps.
+     * Results come back in archive order. Lookups are const and open
+     * their own file handles, so they may run concurrently.
+     */
+    class EventArchiveReader {
+    public:
+        /**
+         * @throws std::runtime_error if the directory or an index is unreadable
+         */
+        explicit EventArchiveReader(const std::string& directory);
+
+        std::vector<JournalRecord> eventsForOrder(uint64_t order_id, ArchiveQueryStats* stats = nullptr) const;
+        std::vector<Trade> tradesForOrder(uint64_t order_id, ArchiveQueryStats* stats = nullptr) const;
+
+        /**
+         * @brief Records with from <= time <= to (clock ticks)
+         */
+        std::vector<JournalRecord> eventsBetween(int64_t from, int64_t to, ArchiveQueryStats* stats = nullptr) const;
+        std::vector<Trade> tradesBetween(int64_t from, int64_t to, ArchiveQueryStats* stats = nullptr) const;
+
+        struct Segment {
+            std::string path;               ///< Without extension
+            SegmentSummary summary;
+        };
+
+        const std::vector<Segment>& getEventSegments() const { return event_segments_; }
+        const std::vector<Segment>& getTradeSegments() const { return trade_segments_; }
+
+    private:
+        std::vector<Segment> event_segments_;
+        std::vector<Segment> trade_segments_;
+    };
+
+} // namespace OrderBook
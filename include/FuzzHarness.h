@@ -0,0 +1,211 @@
+/**
+ * @file FuzzHarness.h
+ * @brief Differential fuzzing of the matching engine against a reference book
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "Order.h"
+#include "Trade.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OrderBook {
+
+    class MatchingEngine;
+
+    /**
+     * @enum FuzzCommandType
+     * @brief Commands the fuzzer can issue against a book
+     */
+    enum class FuzzCommandType {
+        ADD,        ///< New limit order near the touch
+        CANCEL,     ///< Cancel by order ID (may target dead IDs)
+        AMEND,      ///< Amend price and/or quantity
+        SWEEP       ///< Large order priced through several levels
+    };
+
+    /**
+     * @struct FuzzCommand
+     * @brief One step of a fuzz command stream
+     *
+     * Commands are self-contained so any subsequence can be replayed,
+     * which is what makes shrinking possible.
+     */
+    struct FuzzCommand {
+        FuzzCommandType type;
+        OrderSide side;
+        Order::OrderID order_id;
+        uint64_t price;
+        uint64_t quantity;
+
+        std::string toString() const;
+    };
+
+    /**
+     * @struct FuzzConfig
+     * @brief Parameters for a differential fuzzing run
+     */
+    struct FuzzConfig {
+        uint64_t seed = 1;                 ///< Base RNG seed
+        uint64_t num_commands = 1000000;   ///< Total commands across all episodes
+        size_t episode_length = 2000;      ///< Commands per fresh book
+        uint64_t base_price = 10000;       ///< Centre of generated prices
+        uint64_t price_range = 16;         ///< Prices drawn from base +/- range
+        uint64_t max_quantity = 100;       ///< Largest generated order size
+        size_t depth_levels = 5;           ///< Levels compared after every step
+        bool shrink = true;                ///< Minimize failing episodes
+        bool lazy_cancel = false;          ///< Run the engine with lazy cancellation
+    };
+
+    /**
+     * @class ReferenceBook
+     * @brief Deliberately simple price-time priority book used as the oracle
+     *
+     * Resting orders live in one flat vector and every match does a linear
+     * scan for the best price and earliest arrival. Nothing here is meant
+     * to be fast; it is meant to be obviously correct.
+     */
+    class ReferenceBook {
+    public:
+        struct Fill {
+            Order::OrderID buy_order_id;
+            Order::OrderID sell_order_id;
+            uint64_t price;
+            uint64_t quantity;
+        };
+
+        using DepthSide = std::vector<std::pair<uint64_t, uint64_t>>;
+
+        /**
+         * @brief Match an incoming limit order, resting any remainder
+         * @param timestamp Arrival time in clock ticks, only used for checksum()
+         * @param fills Receives the trades generated
+         */
+        void submit(Order::OrderID id, OrderSide side, uint64_t price, uint64_t quantity,
+                    uint64_t timestamp, std::vector<Fill>& fills);
+
+        /**
+         * @brief Remove a resting order
+         * @return true if the order was resting
+         */
+        bool cancel(Order::OrderID id);
+
+        /**
+         * @brief Amend with the engine's rules (reduce in place, else cancel/replace)
+         * @return true if the order was resting
+         */
+        bool amend(Order::OrderID id, uint64_t new_price, uint64_t new_quantity,
+                   uint64_t timestamp, std::vector<Fill>& fills);
+
+        /**
+         * @brief Aggregated depth, best price first
+         */
+        DepthSide depth(OrderSide side, size_t levels) const;
+
+        size_t orderCount() const { return resting_.size(); }
+
+        /**
+         * @brief Recompute the book state hash from scratch
+         * @see BookChecksum
+         */
+        uint64_t checksum() const;
+
+    private:
+        struct Resting {
+            Order::OrderID id;
+            OrderSide side;
+            uint64_t price;
+            uint64_t remaining;
+            uint64_t sequence;
+            uint64_t timestamp;
+        };
+
+        std::vector<Resting> resting_;
+        std::map<uint64_t, uint64_t> bid_levels_;
+        std::map<uint64_t, uint64_t> ask_levels_;
+        uint64_t next_sequence_ = 0;
+
+        std::map<uint64_t, uint64_t>& levels(OrderSide side) {
+            return side == OrderSide::BUY ? bid_levels_ : ask_levels_;
+        }
+        void reduceLevel(OrderSide side, uint64_t price, uint64_t qty);
+    };
+
+    /**
+     * @struct FuzzResult
+     * @brief Outcome of a fuzzing run
+     */
+    struct FuzzResult {
+        bool passed = true;
+        uint64_t commands_run = 0;
+        uint64_t trades_compared = 0;
+        uint64_t episodes = 0;
+        double elapsed_seconds = 0.0;
+        std::string failure;                  ///< First divergence, if any
+        std::vector<FuzzCommand> minimized;   ///< Shrunk reproducer
+    };
+
+    /**
+     * @class DifferentialFuzzer
+     * @brief Drives MatchingEngine and ReferenceBook with identical command streams
+     *
+     * The run is split into short episodes, each on a fresh engine, with a
+     * per-episode seed. Every order is owned by ownerFor(its ID), so
+     * trades must carry the owners of both orders, amends included.
+     * After every command the return value, emitted
+     * trades with their owners, top-of-book depth, resting order count and the book's
+     * rolling state checksum (against one recomputed from scratch) are
+     * compared. A
+     * diverging episode is replayed and shrunk by removing chunks of
+     * commands while the divergence persists.
+     */
+    class DifferentialFuzzer {
+    public:
+        explicit DifferentialFuzzer(const FuzzConfig& config);
+
+        /**
+         * @brief Run the configured number of commands
+         * @return Result with throughput figures and any minimized failure
+         */
+        FuzzResult run();
+
+        /**
+         * @brief Replay a command stream against a fresh engine and reference
+         * @param commands Commands to apply
+         * @param failing_step Receives the index of the first divergence
+         * @param trades_compared Incremented by the number of trades checked
+         * @return Empty string if both sides agree, else a description
+         */
+        std::string replay(const std::vector<FuzzCommand>& commands,
+                           size_t* failing_step = nullptr,
+                           uint64_t* trades_compared = nullptr) const;
+
+        /**
+         * @brief Shrink a failing command stream to a small reproducer
+         */
+        std::vector<FuzzCommand> shrink(std::vector<FuzzCommand> commands) const;
+
+        /**
+         * @brief Generate the command stream for one episode
+         */
+        std::vector<FuzzCommand> generateEpisode(uint64_t episode) const;
+
+        /**
+         * @brief Owner given to an order; never 0, so a lost owner shows up
+         */
+        static uint32_t ownerFor(Order::OrderID id) { return static_cast<uint32_t>(1 + id % 61); }
+
+    private:
+        FuzzConfig config_;
+
+        std::string compareStep(const MatchingEngine& engine, const ReferenceBook& reference,
+                                const std::vector<Trade>& engine_trades,
+                                const std::vector<ReferenceBook::Fill>& reference_fills) const;
+    };
+
+} // namespace OrderBook
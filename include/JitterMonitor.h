@@ -0,0 +1,108 @@
+/**
+ * @file JitterMonitor.h
+ * @brief OS jitter and platform noise measurement
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace OrderBook {
+
+    /**
+     * @struct JitterConfig
+     * @brief Parameters for a jitter measurement run
+     */
+    struct JitterConfig {
+        std::vector<int> cores;            ///< Cores to measure (empty = all online)
+        uint64_t duration_ms = 1000;       ///< Measurement time per core
+        uint64_t gap_threshold_ns = 1000;  ///< Gaps above this count as interruptions
+    };
+
+    /**
+     * @struct CoreJitterReport
+     * @brief Noise observed on a single core
+     */
+    struct CoreJitterReport {
+        static constexpr size_t kBuckets = 40;    ///< log2(ns) histogram buckets
+
+        int core = -1;
+        bool isolated = false;             ///< Listed in /sys/.../cpu/isolated
+        bool pinned = false;               ///< Affinity was applied successfully
+        uint64_t samples = 0;              ///< Timestamp reads taken
+        uint64_t max_gap_ns = 0;           ///< Longest gap between consecutive reads
+        uint64_t interruptions = 0;        ///< Gaps above the threshold
+        uint64_t interrupted_ns = 0;       ///< Time lost to those gaps
+        double clock_read_ns = 0.0;        ///< Mean steady_clock::now() cost
+        double tsc_read_ns = 0.0;          ///< Mean rdtsc cost (0 if unavailable)
+        double timer_slack_ns = 0.0;       ///< Mean oversleep of a 1us sleep
+        std::array<uint64_t, kBuckets> gap_histogram{};  ///< Bucket i holds gaps in [2^(i-1), 2^i)
+
+        /**
+         * @brief Approximate gap percentile from the histogram
+         * @param percentile Percentile (0.0 to 1.0)
+         * @return Upper bound of the bucket holding the percentile, in ns
+         */
+        uint64_t gapPercentile(double percentile) const;
+
+        /**
+         * @brief Fraction of wall time lost to interruptions
+         */
+        double noiseRatio(uint64_t duration_ns) const {
+            return duration_ns ? static_cast<double>(interrupted_ns) / duration_ns : 0.0;
+        }
+    };
+
+    /**
+     * @class JitterMonitor
+     * @brief Measures how much the platform steals from a spinning thread
+     *
+     * Runs a tight timestamp loop pinned to each configured core and
+     * histograms the gaps between consecutive reads. Gaps well above the
+     * clock read cost are interrupts, SMIs or scheduler preemption. Also
+     * measures clock read and timer overhead so engine latencies can be
+     * read against the noise floor of the box.
+     */
+    class JitterMonitor {
+    public:
+        explicit JitterMonitor(const JitterConfig& config);
+
+        /**
+         * @brief Measure all configured cores concurrently
+         * @return One report per core
+         */
+        std::vector<CoreJitterReport> run();
+
+        /**
+         * @brief Print a per-core noise table
+         */
+        void printReports(const std::vector<CoreJitterReport>& reports) const;
+
+        /**
+         * @brief Cores listed as isolated by the kernel (isolcpus)
+         */
+        static std::vector<int> isolatedCores();
+
+        /**
+         * @brief Parse a CPU list such as "0-3,6"
+         */
+        static std::vector<int> parseCpuList(const std::string& list);
+
+        /**
+         * @brief Pin the calling thread to a core
+         * @return true if the affinity was applied
+         */
+        static bool pinCurrentThread(int core);
+
+    private:
+        JitterConfig config_;
+
+        CoreJitterReport measureCore(int core, const std::vector<int>& isolated) const;
+    };
+
+} // namespace OrderBook
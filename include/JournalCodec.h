@@ -0,0 +1,424 @@
+/**
+ * @file JournalCodec.h
+ * @brief Delta + zig-zag varint block encoding for journals and trade logs
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "OrderJournal.h"
+#include "Trade.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace OrderBook {
+
+    /**
+     * @brief Map signed deltas to unsigned so small magnitudes stay small
+     */
+    inline uint64_t zigzagEncode(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t zigzagDecode(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    /**
+     * @brief Append a LEB128 varint (at most 10 bytes)
+     */
+    inline uint8_t* writeVarint(uint8_t* out, uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = static_cast<uint8_t>(value) | 0x80;
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    /**
+     * @brief Read a LEB128 varint
+     * @return false if the input ends or runs past 10 bytes
+     */
+    inline bool readVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+        if (in < end && *in < 0x80) {
+            value = *in++;
+            return true;
+        }
+        uint64_t result = 0;
+        for (unsigned shift = 0; in < end && shift < 64; shift += 7) {
+            uint8_t byte = *in++;
+            result |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Encode a field as the zig-zag varint of its change from prev
+     */
+    inline uint8_t* writeDelta(uint8_t* out, uint64_t value, uint64_t& prev) {
+        out = writeVarint(out, zigzagEncode(static_cast<int64_t>(value - prev)));
+        prev = value;
+        return out;
+    }
+
+    inline bool readDelta(const uint8_t*& in, const uint8_t* end, uint64_t& prev) {
+        uint64_t raw;
+        if (!readVarint(in, end, raw)) return false;
+        prev += static_cast<uint64_t>(zigzagDecode(raw));
+        return true;
+    }
+
+    /**
+     * @struct JournalCodec
+     * @brief Field coding for JournalRecord
+     *
+     * A leading byte packs op, side and which optional fields follow, so
+     * a CANCEL carries no price, quantity or timestamp. Sequence, order
+     * ID, price and both timestamps are deltas against the last record
+     * that carried them; quantity and owner are plain varints; the
+     * checksum sequence is a delta and its hash is 8 raw bytes.
+     */
+    struct JournalCodec {
+        using Record = JournalRecord;
+        static constexpr uint8_t kKind = 1;
+        static constexpr size_t kMaxRecordBytes = 1 + 8 * 10 + 8;
+
+        struct State {
+            uint64_t sequence = 0;
+            uint64_t order_id = 0;
+            uint64_t price = 0;
+            uint64_t timestamp = 0;
+            uint64_t published_ns = 0;
+            uint64_t checksum_sequence = 0;
+        };
+
+        enum : uint8_t {
+            kHasPrice = 1 << 3,
+            kHasQuantity = 1 << 4,
+            kHasTimestamp = 1 << 5,
+            kHasPublished = 1 << 6,
+            kHasChecksum = 1 << 7
+        };
+
+        static uint8_t* encode(uint8_t* out, const Record& record, State& state) {
+            uint8_t flags = static_cast<uint8_t>(record.op) | (record.side == OrderSide::SELL ? 4 : 0);
+            if (record.price) flags |= kHasPrice;
+            if (record.quantity) flags |= kHasQuantity;
+            if (record.timestamp) flags |= kHasTimestamp;
+            if (record.published_ns) flags |= kHasPublished;
+            if (record.checksum.sequence || record.checksum.hash) flags |= kHasChecksum;
+            *out++ = flags;
+            out = writeDelta(out, record.sequence, state.sequence);
+            out = writeDelta(out, record.order_id, state.order_id);
+            if (flags & kHasPrice) out = writeDelta(out, record.price, state.price);
+            if (flags & kHasQuantity) out = writeVarint(out, record.quantity);
+            if (flags & kHasTimestamp) out = writeDelta(out, static_cast<uint64_t>(record.timestamp), state.timestamp);
+            if (flags & kHasPublished) out = writeDelta(out, static_cast<uint64_t>(record.published_ns), state.published_ns);
+            if (flags & kHasChecksum) {
+                out = writeDelta(out, record.checksum.sequence, state.checksum_sequence);
+                std::memcpy(out, &record.checksum.hash, sizeof(uint64_t));
+                out += sizeof(uint64_t);
+            }
+            return writeVarint(out, record.owner);
+        }
+
+        static bool decode(const uint8_t*& in, const uint8_t* end, Record& record, State& state) {
+            if (in >= end) return false;
+            uint8_t flags = *in++;
+            uint64_t owner = 0;
+            bool ok = readDelta(in, end, state.sequence) && readDelta(in, end, state.order_id);
+            record.op = static_cast<JournalOp>(flags & 3);
+            record.side = (flags & 4) ? OrderSide::SELL : OrderSide::BUY;
+            record.sequence = state.sequence;
+            record.order_id = state.order_id;
+            record.price = 0;
+            record.quantity = 0;
+            record.timestamp = 0;
+            record.published_ns = 0;
+            record.checksum = BookChecksum{};
+            if (ok && (flags & kHasPrice)) {
+                ok = readDelta(in, end, state.price);
+                record.price = state.price;
+            }
+            if (ok && (flags & kHasQuantity)) ok = readVarint(in, end, record.quantity);
+            if (ok && (flags & kHasTimestamp)) {
+                ok = readDelta(in, end, state.timestamp);
+                record.timestamp = static_cast<int64_t>(state.timestamp);
+            }
+            if (ok && (flags & kHasPublished)) {
+                ok = readDelta(in, end, state.published_ns);
+                record.published_ns = static_cast<int64_t>(state.published_ns);
+            }
+            if (ok && (flags & kHasChecksum)) {
+                ok = readDelta(in, end, state.checksum_sequence) && end - in >= 8;
+                if (ok) {
+                    record.checksum.sequence = state.checksum_sequence;
+                    std::memcpy(&record.checksum.hash, in, sizeof(uint64_t));
+                    in += sizeof(uint64_t);
+                }
+            }
+            ok = ok && readVarint(in, end, owner);
+            record.owner = static_cast<uint32_t>(owner);
+            return ok;
+        }
+    };
+
+    /**
+     * @struct TradeCodec
+     * @brief Field coding for Trade
+     *
+     * Both order IDs, price and timestamp (clock ticks) are deltas;
+     * quantity and owners are plain varints.
+     */
+    struct TradeCodec {
+        using Record = Trade;
+        static constexpr uint8_t kKind = 2;
+        static constexpr size_t kMaxRecordBytes = 7 * 10;
+
+        struct State {
+            uint64_t buy_order_id = 0;
+            uint64_t sell_order_id = 0;
+            uint64_t price = 0;
+            uint64_t timestamp = 0;
+        };
+
+        static uint8_t* encode(uint8_t* out, const Record& trade, State& state) {
+            out = writeDelta(out, trade.buy_order_id, state.buy_order_id);
+            out = writeDelta(out, trade.sell_order_id, state.sell_order_id);
+            out = writeDelta(out, trade.price, state.price);
+            out = writeVarint(out, trade.quantity);
+            out = writeDelta(out, static_cast<uint64_t>(trade.timestamp.time_since_epoch().count()), state.timestamp);
+            out = writeVarint(out, trade.buy_owner_id);
+            return writeVarint(out, trade.sell_owner_id);
+        }
+
+        static bool decode(const uint8_t*& in, const uint8_t* end, Record& trade, State& state) {
+            uint64_t buy_owner = 0, sell_owner = 0;
+            bool ok = readDelta(in, end, state.buy_order_id) && readDelta(in, end, state.sell_order_id) &&
+                      readDelta(in, end, state.price) && readVarint(in, end, trade.quantity) &&
+                      readDelta(in, end, state.timestamp) && readVarint(in, end, buy_owner) &&
+                      readVarint(in, end, sell_owner);
+            trade.buy_order_id = state.buy_order_id;
+            trade.sell_order_id = state.sell_order_id;
+            trade.price = state.price;
+            trade.timestamp = std::chrono::high_resolution_clock::time_point(
+                std::chrono::high_resolution_clock::duration(static_cast<int64_t>(state.timestamp)));
+            trade.buy_owner_id = static_cast<uint32_t>(buy_owner);
+            trade.sell_owner_id = static_cast<uint32_t>(sell_owner);
+            return ok;
+        }
+    };
+
+    /**
+     * @struct BlockHeader
+     * @brief Framing in front of every encoded block
+     *
+     * Delta state restarts at every block, so each block decodes on its
+     * own: blocks are the restart points for seeking and for splitting a
+     * file across readers.
+     */
+    struct BlockHeader {
+        static constexpr uint32_t kMagic = 0x4a424f31;   ///< "OBJ1"
+
+        uint32_t magic = kMagic;
+        uint8_t kind = 0;                 ///< Codec kKind
+        uint8_t reserved[3] = {};
+        uint32_t records = 0;
+        uint32_t payload_bytes = 0;       ///< Encoded bytes following the header
+    };
+
+    static_assert(sizeof(BlockHeader) == 16, "BlockHeader must stay 16 bytes");
+
+    /**
+     * @class BlockEncoder
+     * @brief Appends records to a buffer of framed, delta-coded blocks
+     *
+     * Blocks are closed every block_records records. Completed blocks can
+     * be drained with takeBlocks() and written out while encoding goes
+     * on, so memory stays bounded by one block. Integers are stored in
+     * host (little-endian) order.
+     *
+     * @tparam Codec JournalCodec or TradeCodec
+     */
+    template<typename Codec>
+    class BlockEncoder {
+    public:
+        using Record = typename Codec::Record;
+
+        static constexpr uint32_t kDefaultBlockRecords = 4096;
+
+        explicit BlockEncoder(uint32_t block_records = kDefaultBlockRecords)
+            : block_records_(block_records ? block_records : kDefaultBlockRecords) {}
+
+        void append(const Record& record) {
+            if (block_records_in_ == 0) openBlock();
+            size_t used = buffer_.size();
+            buffer_.resize(used + Codec::kMaxRecordBytes);
+            uint8_t* end = Codec::encode(buffer_.data() + used, record, state_);
+            buffer_.resize(end - buffer_.data());
+            records_++;
+            if (++block_records_in_ == block_records_) closeBlock();
+        }
+
+        /**
+         * @brief Close the open block, if any
+         */
+        void flush() {
+            if (block_records_in_ > 0) closeBlock();
+        }
+
+        /**
+         * @brief Remove and return the completed blocks
+         */
+        std::vector<uint8_t> takeBlocks() {
+            std::vector<uint8_t> done(buffer_.begin(), buffer_.begin() + closed_bytes_);
+            buffer_.erase(buffer_.begin(), buffer_.begin() + closed_bytes_);
+            if (block_records_in_ > 0) header_offset_ -= closed_bytes_;
+            closed_bytes_ = 0;
+            return done;
+        }
+
+        /**
+         * @brief Encoded bytes, including the open block's
+         */
+        const std::vector<uint8_t>& bytes() const { return buffer_; }
+
+        uint64_t recordCount() const { return records_; }
+
+    private:
+        uint32_t block_records_;
+        uint32_t block_records_in_ = 0;
+        uint64_t records_ = 0;
+        size_t header_offset_ = 0;        ///< Open block's header in buffer_
+        size_t closed_bytes_ = 0;         ///< Prefix of buffer_ holding complete blocks
+        typename Codec::State state_;
+        std::vector<uint8_t> buffer_;
+
+        void openBlock() {
+            state_ = typename Codec::State{};
+            header_offset_ = buffer_.size();
+            buffer_.resize(header_offset_ + sizeof(BlockHeader));
+        }
+
+        void closeBlock() {
+            BlockHeader header;
+            header.kind = Codec::kKind;
+            header.records = block_records_in_;
+            header.payload_bytes = static_cast<uint32_t>(buffer_.size() - header_offset_ - sizeof(BlockHeader));
+            std::memcpy(buffer_.data() + header_offset_, &header, sizeof(header));
+            closed_bytes_ = buffer_.size();
+            block_records_in_ = 0;
+        }
+    };
+
+    /**
+     * @class BlockDecoder
+     * @brief Streaming reader over framed blocks in memory
+     *
+     * Decodes one record per next() call with constant state, block by
+     * block. seekBlock() jumps to any block offset, e.g. one found by
+     * scanning headers with blockOffsets().
+     *
+     * @throws std::runtime_error on a bad header or a truncated record
+     */
+    template<typename Codec>
+    class BlockDecoder {
+    public:
+        using Record = typename Codec::Record;
+
+        BlockDecoder(const uint8_t* data, size_t size)
+            : data_(data), end_(data + size), cursor_(data), block_end_(data) {}
+
+        /**
+         * @brief Decode the next record
+         * @return false at the end of the data
+         */
+        bool next(Record& record) {
+            while (block_left_ == 0) {
+                cursor_ = block_end_;
+                if (cursor_ == end_) return false;
+                openBlock();
+            }
+            if (!Codec::decode(cursor_, block_end_, record, state_)) {
+                throw std::runtime_error("BlockDecoder: truncated record");
+            }
+            block_left_--;
+            return true;
+        }
+
+        /**
+         * @brief Continue decoding from the block starting at offset
+         */
+        void seekBlock(size_t offset) {
+            cursor_ = data_ + offset;
+            block_end_ = cursor_;
+            block_left_ = 0;
+        }
+
+        /**
+         * @brief Offset of the next undecoded byte
+         */
+        size_t offset() const { return cursor_ - data_; }
+
+        /**
+         * @brief Offsets of every block, read from the headers alone
+         */
+        static std::vector<size_t> blockOffsets(const uint8_t* data, size_t size) {
+            std::vector<size_t> offsets;
+            for (size_t offset = 0; offset < size;) {
+                BlockHeader header = readHeader(data + offset, size - offset);
+                offsets.push_back(offset);
+                offset += sizeof(BlockHeader) + header.payload_bytes;
+            }
+            return offsets;
+        }
+
+        /**
+         * @brief Header of the block at data, validated against size
+         */
+        static BlockHeader readHeader(const uint8_t* data, size_t size) {
+            BlockHeader header;
+            if (size < sizeof(header)) {
+                throw std::runtime_error("BlockDecoder: truncated block header");
+            }
+            std::memcpy(&header, data, sizeof(header));
+            if (header.magic != BlockHeader::kMagic || header.kind != Codec::kKind) {
+                throw std::runtime_error("BlockDecoder: bad block header");
+            }
+            if (header.payload_bytes > size - sizeof(header)) {
+                throw std::runtime_error("BlockDecoder: truncated block");
+            }
+            return header;
+        }
+
+    private:
+        const uint8_t* data_;
+        const uint8_t* end_;
+        const uint8_t* cursor_;
+        const uint8_t* block_end_;
+        uint32_t block_left_ = 0;
+        typename Codec::State state_;
+
+        void openBlock() {
+            BlockHeader header = readHeader(cursor_, end_ - cursor_);
+            cursor_ += sizeof(BlockHeader);
+            block_end_ = cursor_ + header.payload_bytes;
+            block_left_ = header.records;
+            state_ = typename Codec::State{};
+        }
+    };
+
+    using JournalEncoder = BlockEncoder<JournalCodec>;
+    using JournalDecoder = BlockDecoder<JournalCodec>;
+    using TradeLogEncoder = BlockEncoder<TradeCodec>;
+    using TradeLogDecoder = BlockDecoder<TradeCodec>;
+
+} // namespace OrderBook
@@ -15,9 +15,35 @@
 #include <atomic>
 #include <mutex>
 #include <fstream>
+#include <memory_resource>
 
 namespace OrderBook {
 
+    class EventArchiveWriter;
+    enum class JournalOp : uint8_t;
+
+    /**
+     * @struct WarmupConfig
+     * @brief Parameters for MatchingEngine::warmup()
+     */
+    struct WarmupConfig {
+        size_t orders = 20000;             ///< Synthetic orders to run
+        size_t reserve_orders = 100000;    ///< Resting orders to pre-size the index for
+        size_t reserve_trades = 100000;    ///< Trades to pre-fault storage for
+        uint64_t mid_price = 10000;        ///< Centre of synthetic prices
+        uint64_t price_range = 50;         ///< Synthetic prices within mid +/- range
+    };
+
+    /**
+     * @enum BookMemory
+     * @brief Where the engine's order book gets container memory from
+     */
+    enum class BookMemory {
+        HEAP,       ///< Straight to the upstream resource (global heap by default)
+        POOL,       ///< Per-book pool that recycles nodes and vectors locally
+        MONOTONIC   ///< Bump allocation that never frees; for benchmarks
+    };
+
     /**
      * @class MatchingEngine
      * @brief High-performance matching engine with price-time priority
@@ -25,6 +51,11 @@ namespace OrderBook {
      * Implements a continuous double auction matching algorithm with
      * price-time priority. Optimized for low-latency order processing
      * and trade execution logging.
+     *
+     * Order entry (submit, cancel, amend, clear) is serialized on one
+     * matching mutex, so it is safe to call from several threads; book
+     * queries do not take it. Trade and order callbacks run under that
+     * mutex and must not call back into order entry.
      */
     class MatchingEngine {
     public:
@@ -34,8 +65,16 @@ namespace OrderBook {
         /**
          * @brief Constructor
          * @param symbol Trading symbol
+         * @param memory Book container memory strategy
+         * @param upstream Resource the strategy draws from; must outlive the engine
+         *
+         * The pool is unsynchronized: the book only allocates with its
+         * lock held exclusively. MONOTONIC grows until the engine is
+         * destroyed, clear() included, so keep it to bounded runs.
          */
-        explicit MatchingEngine(const std::string& symbol = "DEFAULT");
+        explicit MatchingEngine(const std::string& symbol = "DEFAULT",
+                                BookMemory memory = BookMemory::POOL,
+                                std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
 
         /**
          * @brief Destructor
@@ -62,12 +101,62 @@ namespace OrderBook {
          */
         bool cancelOrder(Order::OrderID order_id);
 
+        /**
+         * @brief Amend price and/or quantity of a resting order
+         * @param order_id Order ID to amend
+         * @param new_price New limit price
+         * @param new_quantity New remaining quantity (0 cancels the order)
+         * @param timestamp Priority timestamp used if the order is re-queued
+         * @return true if order was found and amended
+         *
+         * Reducing quantity at an unchanged price keeps queue priority.
+         * Any other amend is a cancel/replace under the same order ID and
+         * may match immediately at the new price.
+         */
+        bool amendOrder(Order::OrderID order_id, uint64_t new_price, uint64_t new_quantity,
+                        Order::TimePoint timestamp);
+
+        /**
+         * @brief Amend a resting order, re-queueing with the current time
+         */
+        bool amendOrder(Order::OrderID order_id, uint64_t new_price, uint64_t new_quantity);
+
         /**
          * @brief Get reference to the order book
          * @return Const reference to order book
          */
         const OrderBook& getOrderBook() const { return order_book_; }
 
+        /**
+         * @brief Attach epoch-based reclamation to the order book
+         * @param epochs Manager that outlives the engine, nullptr to detach
+         * @see OrderBook::setEpochManager
+         */
+        void setEpochManager(EpochManager* epochs) { order_book_.setEpochManager(epochs); }
+
+        /**
+         * @brief Cancel by tombstoning instead of unlinking from level queues
+         * @see OrderBook::setLazyCancel
+         */
+        void setLazyCancel(bool enable, double compact_ratio = 0.5) { order_book_.setLazyCancel(enable, compact_ratio); }
+
+        /**
+         * @brief Drop lazily cancelled entries from the book
+         * @see OrderBook::compactTombstones
+         */
+        size_t compactTombstones(size_t max_levels = SIZE_MAX) { return order_book_.compactTombstones(max_levels); }
+
+        /**
+         * @brief Get the book's memory strategy
+         */
+        BookMemory getBookMemory() const { return book_memory_kind_; }
+
+        /**
+         * @brief Get live and peak bytes of the book and retained trades
+         * @see OrderBook::getMemoryStats
+         */
+        MemoryStats getMemoryStats() const;
+
         /**
          * @brief Get total number of trades executed
          * @return Trade count
@@ -89,9 +178,22 @@ namespace OrderBook {
         /**
          * @brief Get all executed trades
          * @return Const reference to trades vector
+         *
+         * With a trade retention limit this holds only the trades since
+         * the last roll-over.
          */
         const std::vector<Trade>& getTrades() const { return trades_; }
 
+        /**
+         * @brief Bound the in-memory trade history
+         * @param max_trades Trades kept before storage is recycled (0 = unlimited)
+         *
+         * Once the limit is reached the stored trades are discarded and the
+         * storage reused; CSV logging and the trade callback still see every
+         * trade, so they are the streaming outlet for long runs.
+         */
+        void setTradeRetention(size_t max_trades) { trade_retention_ = max_trades; }
+
         /**
          * @brief Set trade callback function
          * @param callback Function to call on trade execution
@@ -111,6 +213,22 @@ namespace OrderBook {
          */
         void setCSVLogging(bool enable, const std::string& filename = "trades.csv");
 
+        /**
+         * @brief Archive every order entry call and trade
+         * @param archive Writer to append to, or nullptr to stop; not owned
+         *
+         * Submits, cancels and amends are appended as journal records as
+         * they arrive, trades as they execute, both under the matching
+         * lock. Warmup traffic is not archived.
+         */
+        void setArchive(EventArchiveWriter* archive) { archive_ = archive; }
+
+        /**
+         * @brief Enable/disable printing every trade to stdout
+         * @param enable true to print trades (default)
+         */
+        void setConsoleLogging(bool enable) { console_logging_enabled_ = enable; }
+
         /**
          * @brief Get trading symbol
          * @return Symbol string
@@ -135,6 +253,18 @@ namespace OrderBook {
          */
         void clear();
 
+        /**
+         * @brief Prime caches, branch predictors and storage before go-live
+         * @param config Warmup parameters
+         *
+         * Pre-faults trade storage and the order index, then runs synthetic
+         * adds, cancels, crosses and multi-level sweeps through the real
+         * code paths, including CSV formatting. Callbacks, console output
+         * and CSV writes are suppressed while warming. The engine is then
+         * reset without releasing the reserved capacity.
+         */
+        void warmup(const WarmupConfig& config = WarmupConfig());
+
         /**
          * @brief Process a batch of orders
          * @param orders Vector of orders to process
@@ -144,8 +274,12 @@ namespace OrderBook {
 
     private:
         std::string symbol_;                          ///< Trading symbol
+        BookMemory book_memory_kind_;                 ///< Book memory strategy
+        std::unique_ptr<std::pmr::memory_resource> book_memory_; ///< Book's resource (null for HEAP); outlives order_book_
         OrderBook order_book_;                        ///< Order book instance
         std::vector<Trade> trades_;                   ///< Executed trades
+        size_t trade_retention_;                      ///< Max trades kept (0 = unlimited)
+        MemoryTracker trade_memory_;                  ///< Capacity of trades_ in bytes
         std::atomic<uint64_t> trade_count_;           ///< Total trade count
         std::atomic<uint64_t> total_volume_;          ///< Total volume traded
         std::atomic<uint64_t> total_value_;           ///< Total value traded
@@ -154,11 +288,33 @@ namespace OrderBook {
         TradeCallback trade_callback_;                ///< Trade execution callback
         OrderCallback order_callback_;                ///< Order event callback
         
-        // CSV logging
+        bool warming_up_;                             ///< Suppress side effects during warmup
+        
+        // Logging
+        bool console_logging_enabled_;                ///< Print trades to stdout
         bool csv_logging_enabled_;                    ///< CSV logging flag
         std::string csv_filename_;                    ///< CSV filename
         std::ofstream csv_file_;                      ///< CSV file stream
         mutable std::mutex csv_mutex_;                ///< CSV file mutex
+        EventArchiveWriter* archive_;                 ///< Audit archive (not owned)
+        uint64_t archive_sequence_;                   ///< Last archived event's sequence
+        std::mutex matching_mutex_;                   ///< Serializes order entry
+        
+        /**
+         * @brief submitOrder body (matching_mutex_ held)
+         */
+        bool submitOrderLocked(std::shared_ptr<Order> order);
+        
+        /**
+         * @brief cancelOrder body (matching_mutex_ held)
+         */
+        bool cancelOrderLocked(Order::OrderID order_id);
+        
+        /**
+         * @brief Append an order entry call to the archive (matching_mutex_ held)
+         */
+        void archiveEvent(JournalOp op, Order::OrderID order_id, OrderSide side, uint64_t price,
+                          uint64_t quantity, Order::TimePoint timestamp, uint32_t owner);
         
         /**
          * @brief Match incoming order against existing orders
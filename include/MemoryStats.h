@@ -0,0 +1,143 @@
+/**
+ * @file MemoryStats.h
+ * @brief Live and peak memory accounting for engine structures
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace OrderBook {
+
+    /**
+     * @enum MemoryCategory
+     * @brief What a block of engine memory holds
+     */
+    enum class MemoryCategory : size_t {
+        ORDERS,             ///< Order records kept alive by books
+        LEVELS,             ///< Price index nodes and per-level order queues
+        ID_INDEX,           ///< Order ID hash table
+        TRADES,             ///< Retained trade history
+        LATENCY_SAMPLES,    ///< Raw samples, histograms and detailed logs
+        TASK_QUEUES,        ///< Thread pool lane heaps
+        COUNT
+    };
+
+    /**
+     * @struct MemoryUsage
+     * @brief Bytes held now and at most since creation
+     */
+    struct MemoryUsage {
+        size_t live_bytes = 0;
+        size_t peak_bytes = 0;
+    };
+
+    /**
+     * @struct MemoryStats
+     * @brief Memory usage by category
+     *
+     * Each component fills the categories it owns. Adding stats from
+     * several components sums their peaks, which bounds the combined
+     * peak from above, since the components need not peak together.
+     */
+    struct MemoryStats {
+        static constexpr size_t kCategories = static_cast<size_t>(MemoryCategory::COUNT);
+
+        std::array<MemoryUsage, kCategories> categories{};
+
+        MemoryUsage& operator[](MemoryCategory category) {
+            return categories[static_cast<size_t>(category)];
+        }
+        const MemoryUsage& operator[](MemoryCategory category) const {
+            return categories[static_cast<size_t>(category)];
+        }
+
+        MemoryStats& operator+=(const MemoryStats& other);
+
+        size_t totalLive() const;
+        size_t totalPeak() const;
+
+        /**
+         * @brief One line per non-empty category, in KB
+         */
+        std::string toString() const;
+
+        static const char* categoryName(MemoryCategory category);
+    };
+
+    /**
+     * @class MemoryTracker
+     * @brief Live byte count with a high-water mark
+     *
+     * Counters are atomic so stats can be read from any thread while the
+     * owner updates them.
+     */
+    class MemoryTracker {
+    public:
+        void add(size_t bytes) { raisePeak(live_.fetch_add(bytes, std::memory_order_relaxed) + bytes); }
+        void subtract(size_t bytes) { live_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+        /**
+         * @brief Replace the live count, e.g. with a container's new capacity
+         */
+        void set(size_t bytes) {
+            live_.store(bytes, std::memory_order_relaxed);
+            raisePeak(bytes);
+        }
+
+        MemoryUsage usage() const {
+            return MemoryUsage{live_.load(std::memory_order_relaxed), peak_.load(std::memory_order_relaxed)};
+        }
+
+    private:
+        std::atomic<size_t> live_{0};
+        std::atomic<size_t> peak_{0};
+
+        void raisePeak(size_t live) {
+            size_t peak = peak_.load(std::memory_order_relaxed);
+            while (live > peak && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+            }
+        }
+    };
+
+    /**
+     * @class TrackingResource
+     * @brief Memory resource that counts the bytes its users hold
+     *
+     * Sits between a container and the resource that really allocates,
+     * so the counts are what the container asked for (nodes, buckets,
+     * vectors) regardless of any pooling underneath.
+     */
+    class TrackingResource : public std::pmr::memory_resource {
+    public:
+        explicit TrackingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : upstream_(upstream) {}
+
+        MemoryUsage usage() const { return tracker_.usage(); }
+        std::pmr::memory_resource* upstream() const { return upstream_; }
+
+    private:
+        std::pmr::memory_resource* upstream_;
+        MemoryTracker tracker_;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* p = upstream_->allocate(bytes, alignment);
+            tracker_.add(bytes);
+            return p;
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            upstream_->deallocate(p, bytes, alignment);
+            tracker_.subtract(bytes);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+} // namespace OrderBook
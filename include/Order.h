@@ -77,10 +77,12 @@ namespace OrderBook {
         uint64_t getRemainingQuantity() const noexcept { return remaining_quantity_; }
         TimePoint getTimestamp() const noexcept { return timestamp_; }
         OrderType getType() const noexcept { return type_; }
+        uint32_t getOwner() const noexcept { return owner_; }
 
         // Setters
         void setRemainingQuantity(uint64_t qty) noexcept { remaining_quantity_ = qty; }
         void setType(OrderType type) noexcept { type_ = type; }
+        void setOwner(uint32_t owner) noexcept { owner_ = owner; }
 
         /**
          * @brief Check if order is completely filled
@@ -107,6 +109,34 @@ namespace OrderBook {
             return actual_reduction;
         }
 
+        /**
+         * @brief Shrink the order in place (amend down keeps priority)
+         * @param new_remaining New remaining quantity, must not exceed current
+         */
+        void amendQuantity(uint64_t new_remaining) noexcept {
+            uint64_t reduction = remaining_quantity_ - new_remaining;
+            quantity_ -= reduction;
+            remaining_quantity_ = new_remaining;
+        }
+
+        /**
+         * @brief Mark the order cancelled while it may still sit in a level queue
+         *
+         * Used by the book's lazy cancel mode: the queue entry stays as a
+         * tombstone that matching skips until the level is compacted.
+         */
+        void markDead() noexcept { dead_ = true; }
+
+        /**
+         * @brief Clear the cancelled mark (order is resting again)
+         */
+        void revive() noexcept { dead_ = false; }
+
+        /**
+         * @brief Check if the order was lazily cancelled
+         */
+        bool isDead() const noexcept { return dead_; }
+
         /**
          * @brief Get filled quantity
          * @return Original quantity minus remaining quantity
@@ -124,11 +154,13 @@ namespace OrderBook {
     private:
         OrderID id_;                    ///< Unique order identifier
         OrderSide side_;               ///< Buy or sell side
+        bool dead_ = false;            ///< Lazily cancelled (fits in side_'s padding)
         uint64_t price_;               ///< Order price (basis points)
         uint64_t quantity_;            ///< Original order quantity
         uint64_t remaining_quantity_;  ///< Remaining quantity to fill
         TimePoint timestamp_;          ///< Order creation timestamp
         OrderType type_;               ///< Order type (LIMIT/MARKET)
+        uint32_t owner_ = 0;           ///< Owning account (position keeping)
     };
 
     /**
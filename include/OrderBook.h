@@ -8,34 +8,111 @@
 #pragma once
 
 #include "Order.h"
+#include "RWSpinLock.h"
+#include "EpochManager.h"
+#include "BTreePriceIndex.h"
+#include "TieredPriceIndex.h"
+#include "MemoryStats.h"
 #include <map>
 #include <vector>
 #include <unordered_map>
+#include <memory_resource>
 #include <mutex>
+#include <shared_mutex>
 #include <atomic>
 #include <memory>
+#include <array>
+#include <algorithm>
 
 namespace OrderBook {
 
     /**
      * @struct PriceLevel
      * @brief Represents a price level with total quantity and order list
+     *
+     * Orders are kept in timestamp order from head, so the entry at head
+     * is the level's priority order. Entries before head have been
+     * filled or cancelled and are trimmed in batches; trimFront() keeps
+     * head on a live entry.
      */
     struct PriceLevel {
+        using allocator_type = std::pmr::polymorphic_allocator<std::shared_ptr<Order>>;
+        
         uint64_t price;                    ///< Price level
         uint64_t total_quantity;           ///< Total quantity at this price
-        std::vector<std::shared_ptr<Order>> orders; ///< Orders at this price level
+        std::pmr::vector<std::shared_ptr<Order>> orders; ///< Orders at this price level
+        uint32_t dead_count = 0;           ///< Lazily cancelled entries at or after head
+        uint32_t head = 0;                 ///< First entry still queued
+        
+        static constexpr uint32_t kTrimBatch = 32;   ///< Popped entries held before erasing them
         
         PriceLevel() : price(0), total_quantity(0) {}
-        PriceLevel(uint64_t p) : price(p), total_quantity(0) {}
+        PriceLevel(uint64_t p, const allocator_type& alloc = {}) 
+            : price(p), total_quantity(0), orders(alloc) {}
+        
+        // Allocator-extended constructors, so pmr maps place the order vector in their resource
+        explicit PriceLevel(const allocator_type& alloc) : price(0), total_quantity(0), orders(alloc) {}
+        PriceLevel(const PriceLevel& other, const allocator_type& alloc)
+            : price(other.price), total_quantity(other.total_quantity), orders(other.orders, alloc)
+            , dead_count(other.dead_count), head(other.head) {}
+        PriceLevel(PriceLevel&& other, const allocator_type& alloc)
+            : price(other.price), total_quantity(other.total_quantity), orders(std::move(other.orders), alloc)
+            , dead_count(other.dead_count), head(other.head) {}
+        PriceLevel(const PriceLevel&) = default;
+        PriceLevel(PriceLevel&&) = default;
+        PriceLevel& operator=(const PriceLevel&) = default;
+        PriceLevel& operator=(PriceLevel&&) = default;
         
         /**
          * @brief Add order to this price level
          * @param order Shared pointer to order
          */
         void addOrder(std::shared_ptr<Order> order) {
-            orders.push_back(order);
             total_quantity += order->getRemainingQuantity();
+            // Usually an append; orders submitted out of timestamp order slide back into place
+            size_t pos = orders.size();
+            while (pos > head && orders[pos - 1]->getTimestamp() > order->getTimestamp()) {
+                --pos;
+            }
+            orders.insert(orders.begin() + pos, std::move(order));
+        }
+        
+        /**
+         * @brief Priority order: earliest timestamp, first come among equals
+         * @return nullptr if no live orders remain
+         */
+        const std::shared_ptr<Order>* front() const {
+            return head < orders.size() ? &orders[head] : nullptr;
+        }
+        
+        /**
+         * @brief Remove the priority order, e.g. once it is filled
+         * @return Tombstones skipped to reach the next live entry
+         */
+        size_t popFront() {
+            head++;
+            return trimFront();
+        }
+        
+        /**
+         * @brief Advance head past tombstones and drop popped entries in batches
+         * @return Tombstones skipped
+         */
+        size_t trimFront() {
+            size_t skipped = 0;
+            while (head < orders.size() && orders[head]->isDead()) {
+                head++;
+                skipped++;
+            }
+            dead_count -= static_cast<uint32_t>(skipped);
+            if (head == orders.size()) {
+                orders.clear();
+                head = 0;
+            } else if (head >= kTrimBatch && head * 2 >= orders.size()) {
+                orders.erase(orders.begin(), orders.begin() + head);
+                head = 0;
+            }
+            return skipped;
         }
         
         /**
@@ -44,7 +121,7 @@ namespace OrderBook {
          * @return true if order was found and removed
          */
         bool removeOrder(Order::OrderID order_id) {
-            for (auto it = orders.begin(); it != orders.end(); ++it) {
+            for (auto it = orders.begin() + head; it != orders.end(); ++it) {
                 if ((*it)->getId() == order_id) {
                     total_quantity -= (*it)->getRemainingQuantity();
                     orders.erase(it);
@@ -64,12 +141,44 @@ namespace OrderBook {
             total_quantity = total_quantity - old_qty + new_qty;
         }
         
+        /**
+         * @brief Cancel an order by leaving a tombstone in the queue
+         * @param order Order resting at this level
+         *
+         * Only the quantity and the order's mark are written; the entry is
+         * dropped by compact(), or passed over by trimFront() once it
+         * reaches the front.
+         * @return Tombstones trimmed from the front (including this one)
+         */
+        size_t markDead(const std::shared_ptr<Order>& order) {
+            total_quantity -= order->getRemainingQuantity();
+            order->markDead();
+            dead_count++;
+            return trimFront();
+        }
+        
+        /**
+         * @brief Drop tombstones left by markDead()
+         * @return Number of entries removed
+         */
+        size_t compact() {
+            if (dead_count == 0) return 0;
+            size_t removed = dead_count;
+            auto live_end = std::remove_if(orders.begin() + head, orders.end(),
+                                           [](const std::shared_ptr<Order>& order) { return order->isDead(); });
+            orders.erase(live_end, orders.end());
+            orders.erase(orders.begin(), orders.begin() + head);
+            dead_count = 0;
+            head = 0;
+            return removed;
+        }
+        
         /**
          * @brief Check if price level is empty
-         * @return true if no orders remain
+         * @return true if no live orders remain
          */
         bool isEmpty() const {
-            return orders.empty();
+            return orders.size() - head == dead_count;
         }
         
         /**
@@ -78,32 +187,138 @@ namespace OrderBook {
         void clear() {
             orders.clear();
             total_quantity = 0;
+            dead_count = 0;
+            head = 0;
+        }
+    };
+
+    /**
+     * @struct BookChecksum
+     * @brief Rolling digest of every resting order, with the mutation count it reflects
+     *
+     * The hash is the sum (mod 2^64) of a per-order digest over ID, side,
+     * price, remaining quantity and time priority, so it does not depend
+     * on the order mutations arrived in and is updated in O(1) by adding
+     * and subtracting digests. Two books holding the same orders have the
+     * same hash; replicas fed the same messages also agree on sequence.
+     */
+    struct BookChecksum {
+        uint64_t sequence = 0;    ///< Book mutations applied (adds, quantity updates, cancels, clears)
+        uint64_t hash = 0;        ///< Sum of digest() over resting orders
+
+        bool operator==(const BookChecksum& other) const {
+            return sequence == other.sequence && hash == other.hash;
+        }
+        bool operator!=(const BookChecksum& other) const { return !(*this == other); }
+
+        /**
+         * @brief Digest of one resting order
+         * @param priority Arrival timestamp in clock ticks
+         */
+        static uint64_t digest(Order::OrderID id, OrderSide side, uint64_t price,
+                               uint64_t remaining, uint64_t priority) {
+            uint64_t h = mix(id);
+            h = mix(h ^ price ^ (static_cast<uint64_t>(side) << 63));
+            h = mix(h ^ remaining);
+            return mix(h ^ priority);
+        }
+
+        static uint64_t digest(const Order& order, uint64_t remaining) {
+            return digest(order.getId(), order.getSide(), order.getPrice(), remaining,
+                          static_cast<uint64_t>(order.getTimestamp().time_since_epoch().count()));
+        }
+
+    private:
+        // splitmix64 finalizer
+        static uint64_t mix(uint64_t x) {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
         }
     };
 
+    /**
+     * @struct TopOfBook
+     * @brief Best prices and quantities read as one consistent snapshot
+     */
+    struct TopOfBook {
+        uint64_t bid_price = 0;       ///< 0 if no bids
+        uint64_t bid_quantity = 0;
+        uint64_t ask_price = 0;       ///< 0 if no asks
+        uint64_t ask_quantity = 0;
+    };
+
+    /**
+     * @struct DepthSnapshot
+     * @brief Immutable top-of-book depth published for lock-free readers
+     */
+    struct DepthSnapshot {
+        static constexpr size_t kLevels = 10;     ///< Levels kept per side
+        
+        uint64_t sequence = 0;                    ///< Increases with every publish
+        size_t bid_count = 0;                     ///< Valid entries in bids
+        size_t ask_count = 0;                     ///< Valid entries in asks
+        std::array<std::pair<uint64_t, uint64_t>, kLevels> bids{};  ///< (price, quantity), best first
+        std::array<std::pair<uint64_t, uint64_t>, kLevels> asks{};
+    };
+
     /**
      * @class OrderBook
      * @brief High-performance order book implementation
      * 
      * Uses std::map for O(log n) insertion/lookup and maintains
      * separate bid and ask books with price-time priority.
-     * Thread-safe with minimal locking for high-frequency trading.
+     * Mutations take a writer-preferring reader-writer lock exclusively;
+     * depth and order queries share it, so readers run in parallel with
+     * each other and delay the writer only by the reads already in flight.
+     * Top of book is additionally published through a seqlock and read
+     * without taking the lock at all. With an EpochManager attached, the
+     * top levels are also published as an immutable DepthSnapshot, and
+     * removed orders and replaced snapshots are retired through it rather
+     * than freed on the matching path.
+     *
+     * Price levels are kept in a std::pmr::map by default; building with
+     * -DORDERBOOK_BTREE_INDEX swaps in BTreePriceIndex, which stays
+     * shallower and touches fewer cache lines when the book is wide, and
+     * -DORDERBOOK_TIERED_INDEX swaps in TieredPriceIndex, which keeps the
+     * levels near the touch in a dense array.
      */
     class OrderBook {
     public:
-        using PriceLevelMap = std::map<uint64_t, PriceLevel>;
-        using OrderMap = std::unordered_map<Order::OrderID, std::shared_ptr<Order>>;
+#if defined(ORDERBOOK_BTREE_INDEX) && defined(ORDERBOOK_TIERED_INDEX)
+#error "Define at most one of ORDERBOOK_BTREE_INDEX and ORDERBOOK_TIERED_INDEX"
+#elif defined(ORDERBOOK_TIERED_INDEX)
+#ifndef ORDERBOOK_TIERED_WINDOW
+#define ORDERBOOK_TIERED_WINDOW TieredPriceIndex<PriceLevel>::kDefaultWindow
+#endif
+        using PriceLevelMap = TieredPriceIndex<PriceLevel>;
+        static constexpr const char* kPriceIndexName = "tiered";
+#elif defined(ORDERBOOK_BTREE_INDEX)
+        using PriceLevelMap = BTreePriceIndex<PriceLevel>;
+        static constexpr const char* kPriceIndexName = "btree";
+#else
+        using PriceLevelMap = std::pmr::map<uint64_t, PriceLevel>;
+        static constexpr const char* kPriceIndexName = "map";
+#endif
+        using OrderMap = std::pmr::unordered_map<Order::OrderID, std::shared_ptr<Order>>;
 
         /**
          * @brief Constructor
          * @param symbol Trading symbol (e.g., "AAPL")
+         * @param memory Resource for map nodes, hash buckets and level vectors
+         *
+         * The resource is only used while book_lock_ is held exclusively, so
+         * an unsynchronized pool is safe; it must outlive the book.
          */
-        explicit OrderBook(const std::string& symbol = "DEFAULT");
+        explicit OrderBook(const std::string& symbol = "DEFAULT",
+                           std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
         /**
          * @brief Destructor
          */
-        ~OrderBook() = default;
+        ~OrderBook();
 
         // Non-copyable and non-movable (due to mutex)
         OrderBook(const OrderBook&) = delete;
@@ -125,6 +340,28 @@ namespace OrderBook {
          */
         bool cancelOrder(Order::OrderID order_id);
 
+        /**
+         * @brief Take a filled order off the book
+         * @param order_id Order ID to remove
+         * @return true if the order was resting
+         *
+         * Matching fills the priority order, so this normally pops the
+         * front of its level. Unlike cancelOrder() it never leaves a
+         * tombstone, even with lazy cancellation on.
+         */
+        bool removeFilledOrder(Order::OrderID order_id);
+
+        /**
+         * @brief Get best bid and ask with their quantities without locking
+         * @return Snapshot taken between two mutations
+         */
+        TopOfBook getTopOfBook() const;
+
+        /**
+         * @brief Get the rolling state checksum and the sequence it was taken at
+         */
+        BookChecksum getChecksum() const;
+
         /**
          * @brief Get best bid price
          * @return Best bid price, 0 if no bids
@@ -179,6 +416,49 @@ namespace OrderBook {
                   std::vector<std::pair<uint64_t, uint64_t>>> 
         getMarketDepth(size_t levels = 10) const;
 
+        /**
+         * @brief Attach epoch-based reclamation and start publishing depth snapshots
+         * @param epochs Manager that outlives the book, nullptr to detach
+         *
+         * Call before the book is shared between threads.
+         */
+        void setEpochManager(EpochManager* epochs);
+
+        /**
+         * @brief Hold depth snapshot publication until the matching endBatch()
+         *
+         * The engine brackets each order with these, so readers see one
+         * snapshot per order rather than one per fill. Batches nest.
+         * Reclamation of retired orders and snapshots also waits for the
+         * batch to end. Takes no lock.
+         */
+        void beginBatch();
+
+        /**
+         * @brief End a batch, publishing the snapshot if anything visible changed
+         *
+         * Takes the write lock only when there is a snapshot to publish,
+         * then frees due retirements after releasing it.
+         */
+        void endBatch();
+
+        /**
+         * @brief Inspect the latest depth snapshot without locking the book
+         * @param visit Called with a const DepthSnapshot& inside an epoch
+         * @return false if no EpochManager is attached
+         *
+         * The snapshot stays valid only for the duration of the call.
+         */
+        template<typename Visitor>
+        bool visitDepthSnapshot(Visitor&& visit) const {
+            if (!epochs_) return false;
+            EpochGuard guard(*epochs_);
+            const DepthSnapshot* snapshot = depth_snapshot_.load(std::memory_order_acquire);
+            if (!snapshot) return false;
+            visit(*snapshot);
+            return true;
+        }
+
         /**
          * @brief Get total number of orders
          * @return Total order count
@@ -202,6 +482,46 @@ namespace OrderBook {
          */
         void clear();
 
+        /**
+         * @brief Pre-size the order index for an expected resting order count
+         * @param expected_orders Number of orders to size the index for
+         */
+        void reserve(size_t expected_orders);
+
+        /**
+         * @brief Switch lazy cancellation on or off
+         * @param enable Cancel by tombstoning the queue entry instead of unlinking it
+         * @param compact_ratio Compact a level on cancel once this fraction of its entries is dead
+         *
+         * A lazy cancel erases the order from the ID index, takes its
+         * quantity off the level and marks it dead; matching skips dead
+         * entries. Turning lazy cancellation off compacts every level.
+         */
+        void setLazyCancel(bool enable, double compact_ratio = 0.5);
+
+        /**
+         * @brief Drop tombstones, for idle time or a maintenance thread
+         * @param max_levels Stop after compacting this many levels
+         * @return Number of tombstones removed
+         */
+        size_t compactTombstones(size_t max_levels = SIZE_MAX);
+
+        /**
+         * @brief Get lazily cancelled entries not yet compacted
+         */
+        size_t getTombstoneCount() const;
+
+        /**
+         * @brief Get live and peak bytes of the book's structures
+         *
+         * Levels and the ID index are counted at the allocator, as the
+         * bytes their containers hold. Orders are the records the book
+         * keeps alive (resting orders and tombstones) at sizeof(Order)
+         * each; allocation overhead on top of that belongs to whoever
+         * created them.
+         */
+        MemoryStats getMemoryStats() const;
+
         /**
          * @brief Get string representation of order book
          * @param levels Number of levels to display
@@ -215,6 +535,17 @@ namespace OrderBook {
          */
         std::pair<uint64_t, uint64_t> getBestPrices() const;
 
+        /**
+         * @brief Get the order with time priority at the best price
+         * @param side Side to look at
+         * @return Earliest unfilled order at the best level, nullptr if none
+         *
+         * Unlike getOrdersForMatching() this copies nothing, so matching
+         * does not allocate. It is the level's front entry: O(1), however
+         * many tombstones or popped entries the level holds.
+         */
+        std::shared_ptr<Order> getPriorityOrder(OrderSide side) const;
+
         /**
          * @brief Get orders for matching at best prices
          * @param side Side to get orders for
@@ -232,10 +563,86 @@ namespace OrderBook {
 
     private:
         std::string symbol_;                    ///< Trading symbol
+        TrackingResource level_memory_;         ///< Counts price index and level queue bytes
+        TrackingResource index_memory_;         ///< Counts ID index bytes
         PriceLevelMap bids_;                    ///< Bid price levels (price -> PriceLevel)
         PriceLevelMap asks_;                    ///< Ask price levels (price -> PriceLevel)
         OrderMap orders_;                       ///< All orders by ID for O(1) lookup
-        mutable std::mutex book_mutex_;  ///< Mutex for thread safety
+        mutable RWSpinLock book_lock_;          ///< Exclusive for mutations, shared for queries
+        
+        // Top of book seqlock: odd sequence while a writer is updating
+        std::atomic<uint64_t> tob_sequence_;
+        std::atomic<uint64_t> tob_bid_price_;
+        std::atomic<uint64_t> tob_bid_quantity_;
+        std::atomic<uint64_t> tob_ask_price_;
+        std::atomic<uint64_t> tob_ask_quantity_;
+        
+        // Depth snapshot for epoch-protected readers
+        EpochManager* epochs_;                              ///< nullptr: snapshots disabled
+        std::atomic<DepthSnapshot*> depth_snapshot_;        ///< Latest published snapshot
+        uint64_t snapshot_bid_floor_;                       ///< Lowest bid price the snapshot covers
+        uint64_t snapshot_ask_ceiling_;                     ///< Highest ask price the snapshot covers
+        std::atomic<uint32_t> batch_depth_;                 ///< Open beginBatch() calls
+        std::atomic<bool> depth_dirty_;                     ///< Visible change held back by a batch
+        
+        // Lazy cancellation
+        static constexpr uint32_t kMinCompaction = 8;       ///< Tombstones a level holds before compacting
+        bool lazy_cancel_;                                  ///< Tombstone on cancel instead of unlinking
+        double compact_ratio_;                              ///< Dead fraction that triggers compaction
+        size_t tombstones_;                                 ///< Dead entries across all levels
+        size_t peak_order_records_;                         ///< Most orders plus tombstones held at once
+        
+        BookChecksum checksum_;                             ///< Rolling state hash and mutation count
+        
+        /**
+         * @brief Republish top of book (book_lock_ held exclusively)
+         */
+        void publishTopOfBook();
+        
+        /**
+         * @brief Republish the depth snapshot if a change at price is visible in it
+         */
+        void publishDepth(OrderSide side, uint64_t price);
+        
+        /**
+         * @brief Build and swap in a new depth snapshot, retiring the old one
+         */
+        void publishDepth();
+        
+        /**
+         * @brief Market depth without locking (book_lock_ held)
+         */
+        std::pair<std::vector<std::pair<uint64_t, uint64_t>>, 
+                  std::vector<std::pair<uint64_t, uint64_t>>> 
+        marketDepthUnlocked(size_t levels) const;
+        
+        /**
+         * @brief Compact up to max_levels levels (book_lock_ held exclusively)
+         */
+        size_t compactTombstonesUnlocked(size_t max_levels);
+        
+        /**
+         * @brief addOrder body (book_lock_ held exclusively)
+         */
+        void addOrderUnlocked(const std::shared_ptr<Order>& order);
+        
+        /**
+         * @brief cancelOrder/removeFilledOrder body (book_lock_ held exclusively)
+         */
+        bool removeOrderUnlocked(Order::OrderID order_id, bool filled);
+        
+        /**
+         * @brief Free due retirements; call with book_lock_ released
+         *
+         * Waits while a batch is open, so an order's frees happen after it
+         * has finished matching rather than between its fills.
+         */
+        void reclaimRetired();
+        
+        /**
+         * @brief Copy a level's orders, skipping tombstones
+         */
+        static std::vector<std::shared_ptr<Order>> liveOrders(const PriceLevel& level);
         
         /**
          * @brief Get price level map for given side
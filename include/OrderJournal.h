@@ -0,0 +1,67 @@
+/**
+ * @file OrderJournal.h
+ * @brief Sequenced engine input records for journaling and replication
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "Order.h"
+#include "OrderBook.h"
+#include "SpscRing.h"
+#include <cstdint>
+#include <type_traits>
+
+namespace OrderBook {
+
+    class MatchingEngine;
+
+    /**
+     * @enum JournalOp
+     * @brief Engine entry point a record replays
+     */
+    enum class JournalOp : uint8_t {
+        SUBMIT,
+        CANCEL,
+        AMEND
+    };
+
+    /**
+     * @struct JournalRecord
+     * @brief One sequenced engine input
+     *
+     * Carries everything needed to repeat the call deterministically,
+     * including the order timestamp that sets its priority, plus the
+     * primary's book checksum after applying it so a replica can verify
+     * itself after every record. Trivially copyable, so it can go through
+     * shared-memory rings and files as is.
+     */
+    struct JournalRecord {
+        uint64_t sequence = 0;        ///< Position in the input stream, from 1
+        uint64_t order_id = 0;
+        uint64_t price = 0;           ///< SUBMIT/AMEND
+        uint64_t quantity = 0;        ///< SUBMIT/AMEND
+        int64_t timestamp = 0;        ///< Order timestamp in clock ticks (SUBMIT/AMEND; archived CANCELs carry the call time)
+        int64_t published_ns = 0;     ///< Steady clock when the primary published it
+        BookChecksum checksum;        ///< Primary's book state after this record
+        JournalOp op = JournalOp::SUBMIT;
+        OrderSide side = OrderSide::BUY;
+        uint32_t owner = 0;
+    };
+
+    static_assert(std::is_trivially_copyable<JournalRecord>::value,
+                  "JournalRecord must be trivially copyable");
+
+    /**
+     * @brief Ring that carries journal records between processes
+     */
+    using JournalRing = SpscRing<JournalRecord, 16384>;
+
+    /**
+     * @brief Repeat a journaled call on an engine
+     * @return The engine call's result
+     */
+    bool applyJournalRecord(MatchingEngine& engine, const JournalRecord& record);
+
+} // namespace OrderBook
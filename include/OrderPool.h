@@ -0,0 +1,136 @@
+/**
+ * @file OrderPool.h
+ * @brief Recycling allocator for orders and their shared_ptr control blocks
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "Order.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace OrderBook {
+
+    /**
+     * @class OrderPool
+     * @brief Fixed-size slot pool that recycles order memory
+     *
+     * Orders created through the pool are allocated together with their
+     * shared_ptr control block (allocate_shared) from fixed-size slots.
+     * Released slots go onto a free list and are reused by the next order,
+     * so memory is bounded by the peak number of live orders rather than
+     * the total ever created. Chunks are only returned to the system when
+     * the pool is destroyed, so the pool must outlive every order it made.
+     */
+    class OrderPool {
+    public:
+        /**
+         * @brief Constructor
+         * @param slots_per_chunk Slots allocated each time the pool grows
+         */
+        explicit OrderPool(size_t slots_per_chunk = 4096);
+
+        /**
+         * @brief Destructor, releases all chunks
+         */
+        ~OrderPool();
+
+        // Non-copyable and non-movable (allocators hold a pointer to the pool)
+        OrderPool(const OrderPool&) = delete;
+        OrderPool& operator=(const OrderPool&) = delete;
+        OrderPool(OrderPool&&) = delete;
+        OrderPool& operator=(OrderPool&&) = delete;
+
+        /**
+         * @brief Create an order in pooled memory
+         * @return Shared pointer whose last release recycles the slot
+         */
+        template<typename... Args>
+        std::shared_ptr<Order> create(Args&&... args);
+
+        /**
+         * @brief Allocate raw storage for one slot
+         * @param bytes Requested size; larger than the slot size falls back to operator new
+         */
+        void* allocate(size_t bytes);
+
+        /**
+         * @brief Return storage obtained from allocate()
+         */
+        void deallocate(void* ptr, size_t bytes);
+
+        /**
+         * @brief Number of slots currently handed out
+         */
+        size_t getLiveCount() const;
+
+        /**
+         * @brief Total slots allocated from the system
+         */
+        size_t getCapacity() const;
+
+        /**
+         * @brief Bytes reserved from the system
+         */
+        size_t getReservedBytes() const;
+
+    private:
+        struct FreeSlot {
+            FreeSlot* next;
+        };
+
+        size_t slots_per_chunk_;
+        size_t slot_size_;                  ///< Fixed on first allocation
+        std::vector<void*> chunks_;
+        FreeSlot* free_list_;
+        size_t live_count_;
+        size_t capacity_;
+        mutable std::mutex mutex_;          ///< Orders may be released from any thread
+
+        void grow();
+    };
+
+    /**
+     * @class OrderPoolAllocator
+     * @brief Standard allocator adaptor over OrderPool
+     */
+    template<typename T>
+    class OrderPoolAllocator {
+    public:
+        using value_type = T;
+
+        explicit OrderPoolAllocator(OrderPool& pool) noexcept : pool_(&pool) {}
+
+        template<typename U>
+        OrderPoolAllocator(const OrderPoolAllocator<U>& other) noexcept : pool_(other.pool_) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_t n) noexcept {
+            pool_->deallocate(ptr, n * sizeof(T));
+        }
+
+        template<typename U>
+        bool operator==(const OrderPoolAllocator<U>& other) const noexcept { return pool_ == other.pool_; }
+
+        template<typename U>
+        bool operator!=(const OrderPoolAllocator<U>& other) const noexcept { return pool_ != other.pool_; }
+
+    private:
+        template<typename U> friend class OrderPoolAllocator;
+        OrderPool* pool_;
+    };
+
+    // Template implementation
+    template<typename... Args>
+    std::shared_ptr<Order> OrderPool::create(Args&&... args) {
+        return std::allocate_shared<Order>(OrderPoolAllocator<Order>(*this), std::forward<Args>(args)...);
+    }
+
+} // namespace OrderBook
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "MemoryStats.h"
 #include <chrono>
 #include <vector>
 #include <atomic>
@@ -14,9 +15,12 @@
 #include <string>
 #include <fstream>
 #include <memory>
+#include <unordered_map>
 
 namespace OrderBook {
 
+    class ThreadPool;
+
     /**
      * @class LatencyMeasurement
      * @brief Single latency measurement record
@@ -57,6 +61,7 @@ namespace OrderBook {
         double median_latency_ns;
         double p95_latency_ns;
         double p99_latency_ns;
+        double p999_latency_ns;
         double std_deviation_ns;
         uint64_t total_duration_ns;
         double throughput_ops_per_sec;
@@ -69,12 +74,61 @@ namespace OrderBook {
             , median_latency_ns(0.0)
             , p95_latency_ns(0.0)
             , p99_latency_ns(0.0)
+            , p999_latency_ns(0.0)
             , std_deviation_ns(0.0)
             , total_duration_ns(0)
             , throughput_ops_per_sec(0.0)
         {}
     };
 
+    /**
+     * @class LatencyHistogram
+     * @brief Fixed-memory log-linear latency histogram
+     *
+     * Values below 128 ns are counted exactly; above that each power of two
+     * is split into 64 sub-buckets, bounding relative error to about 1.6%
+     * across the whole uint64_t range in ~30KB regardless of sample count.
+     */
+    struct LatencyHistogram {
+        static constexpr unsigned kSubBucketBits = 7;
+        static constexpr size_t kHalf = size_t(1) << (kSubBucketBits - 1);
+        static constexpr size_t kBucketCount = (size_t(1) << kSubBucketBits) + (64 - kSubBucketBits) * kHalf;
+
+        std::vector<uint64_t> counts;
+        uint64_t total = 0;
+        uint64_t min = UINT64_MAX;
+        uint64_t max = 0;
+        double sum = 0.0;
+        double sum_squares = 0.0;
+
+        LatencyHistogram() : counts(kBucketCount, 0) {}
+
+        /**
+         * @brief Record one latency sample
+         */
+        void record(uint64_t value_ns);
+
+        /**
+         * @brief Add another histogram's samples to this one
+         */
+        void merge(const LatencyHistogram& other);
+
+        /**
+         * @brief Approximate percentile (bucket midpoint)
+         * @param percentile Percentile (0.0 to 1.0)
+         */
+        double percentile(double percentile) const;
+
+        /**
+         * @brief Reset all counts
+         */
+        void clear();
+
+        static size_t bucketIndex(uint64_t value_ns);
+        static uint64_t bucketLowerBound(size_t index);
+        static uint64_t bucketWidth(size_t index);
+    };
+
     /**
      * @class PerformanceMonitor
      * @brief High-performance monitoring system for latency measurement
@@ -140,6 +194,21 @@ namespace OrderBook {
          */
         PerformanceStats getStats(const std::string& operation_type) const;
 
+        /**
+         * @brief Get statistics for an operation type, sorting and summing on a pool
+         * @param operation_type Operation type to get stats for
+         * @param pool Pool used for the chunked sort, merge and sums
+         * @return Same statistics as getStats(operation_type)
+         */
+        PerformanceStats getStats(const std::string& operation_type, ThreadPool& pool) const;
+
+        /**
+         * @brief Pre-allocate and pre-fault sample storage for an operation type
+         * @param operation_type Operation type to reserve for
+         * @param samples Number of samples expected
+         */
+        void reserve(const std::string& operation_type, size_t samples);
+
         /**
          * @brief Get overall statistics (all operations)
          * @return Overall performance statistics
@@ -189,11 +258,40 @@ namespace OrderBook {
          */
         uint64_t getMeasurementCount() const;
 
+        /**
+         * @brief Bound sample memory for long runs
+         * @param max_samples Raw samples buffered per operation type (0 = unbounded)
+         * @param spill_filename CSV the buffer is streamed to when full (empty = discard)
+         *
+         * With a budget, every sample still lands in a fixed-size
+         * LatencyHistogram per operation type and statistics are computed
+         * from it, so memory stays flat however long the run. Detailed
+         * per-operation logging is unbounded by nature and is ignored
+         * while a budget is set.
+         */
+        void setSampleBudget(size_t max_samples, const std::string& spill_filename = "");
+
+        /**
+         * @brief Get resident set size of this process
+         * @return Resident bytes, 0 if unavailable
+         */
+        static size_t getResidentSetBytes();
+
+        /**
+         * @brief Get live and peak bytes of sample storage
+         *
+         * Counts the capacity of every raw sample buffer, histogram and
+         * the detailed log, so buffers kept after clear() or a spill still
+         * show as live.
+         */
+        MemoryStats getMemoryStats() const;
+
     private:
         struct OperationData {
             std::vector<uint64_t> latencies;
             std::atomic<uint64_t> total_count;
             std::atomic<uint64_t> total_latency;
+            LatencyHistogram histogram;         ///< Populated in sample budget mode
             mutable std::mutex mutex;
             
             OperationData() : total_count(0), total_latency(0) {}
@@ -203,6 +301,24 @@ namespace OrderBook {
         std::unordered_map<std::string, OperationData> operation_data_;
         std::vector<LatencyMeasurement> detailed_measurements_;
         mutable std::mutex global_mutex_;
+        size_t sample_budget_;                  ///< Raw samples kept per operation (0 = unbounded)
+        std::ofstream spill_file_;              ///< Destination for samples over budget
+        MemoryTracker sample_memory_;           ///< Refreshed whenever sample storage grows or is freed
+        
+        /**
+         * @brief Bytes of sample storage (global_mutex_ held)
+         */
+        size_t sampleBytesLocked() const;
+        
+        /**
+         * @brief Stream an operation's buffered samples to the spill file
+         */
+        void spillSamples(const std::string& operation_type, OperationData& data);
+        
+        /**
+         * @brief Calculate statistics from a histogram
+         */
+        PerformanceStats calculateStats(const LatencyHistogram& histogram) const;
         
         /**
          * @brief Calculate statistics from latency vector
@@ -211,6 +327,11 @@ namespace OrderBook {
          */
         PerformanceStats calculateStats(const std::vector<uint64_t>& latencies) const;
         
+        /**
+         * @brief Calculate statistics from latency vector using a thread pool
+         */
+        PerformanceStats calculateStats(const std::vector<uint64_t>& latencies, ThreadPool& pool) const;
+        
         /**
          * @brief Get percentile value from sorted vector
          * @param sorted_data Sorted latency data
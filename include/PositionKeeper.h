@@ -0,0 +1,184 @@
+/**
+ * @file PositionKeeper.h
+ * @brief Real-time position and P&L keeping on the fill stream
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "SpscRing.h"
+#include "Trade.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OrderBook {
+
+    class MatchingEngine;
+
+    /**
+     * @struct FillEvent
+     * @brief One fill as published by a matcher to the position keeper
+     */
+    struct FillEvent {
+        uint32_t instrument;        ///< Instrument index
+        uint32_t buy_owner;         ///< Owner of the buy order
+        uint32_t sell_owner;        ///< Owner of the sell order
+        uint64_t price;             ///< Execution price
+        uint64_t quantity;          ///< Fill quantity
+        uint64_t best_bid;          ///< Top of book at fill time (0 = empty side)
+        uint64_t best_ask;
+    };
+
+    /**
+     * @struct Position
+     * @brief Position of one owner in one instrument
+     */
+    struct Position {
+        int64_t quantity = 0;           ///< Net position, positive = long
+        double average_cost = 0.0;      ///< Average entry price of the open position
+        double realized_pnl = 0.0;      ///< P&L locked in by reducing fills
+        uint64_t fills = 0;             ///< Fills applied to this position
+
+        /**
+         * @brief Unrealized P&L against a mark price
+         */
+        double unrealizedPnl(uint64_t mark) const {
+            return quantity == 0 ? 0.0 : static_cast<double>(quantity) * (static_cast<double>(mark) - average_cost);
+        }
+    };
+
+    /**
+     * @struct PositionSnapshot
+     * @brief Consistent copy of every position after a whole number of fills
+     */
+    struct PositionSnapshot {
+        uint64_t sequence = 0;              ///< Fills applied when the snapshot was taken
+        uint32_t owners = 0;
+        uint32_t instruments = 0;
+        std::vector<Position> positions;    ///< owners x instruments, owner-major
+        std::vector<uint64_t> marks;        ///< Mark price per instrument
+
+        const Position& at(uint32_t owner, uint32_t instrument) const {
+            return positions[static_cast<size_t>(owner) * instruments + instrument];
+        }
+
+        /**
+         * @brief Realized plus unrealized P&L of one owner across instruments
+         */
+        double totalPnl(uint32_t owner) const;
+
+        /**
+         * @brief Sum of net positions in one instrument (zero when all owners are tracked)
+         */
+        int64_t netQuantity(uint32_t instrument) const;
+    };
+
+    /**
+     * @struct PositionKeeperConfig
+     * @brief Sizing for the flat position arrays
+     */
+    struct PositionKeeperConfig {
+        uint32_t max_owners = 1024;
+        uint32_t max_instruments = 16;
+        std::chrono::microseconds publish_interval{1000};  ///< Minimum time between snapshots
+    };
+
+    /**
+     * @class PositionKeeper
+     * @brief Applies fills to owner x instrument positions on a consumer thread
+     *
+     * Each producer (one per matcher thread) gets its own SPSC ring, so the
+     * matcher only pays for a copy into the ring. A single consumer thread
+     * drains the rings into flat position arrays indexed by owner and
+     * instrument and marks each instrument to the mid of the top of book
+     * carried on the fill. Snapshots are double buffered: the consumer
+     * copies its arrays into a back buffer between fills and swaps it in
+     * under a short lock, so readers never stall the matcher or see a
+     * half-applied fill.
+     *
+     * Prices are in basis points, so P&L is in basis points times quantity.
+     */
+    class PositionKeeper {
+    public:
+        static constexpr size_t kRingCapacity = 1 << 16;
+        using FillRing = SpscRing<FillEvent, kRingCapacity>;
+
+        explicit PositionKeeper(const PositionKeeperConfig& config = PositionKeeperConfig());
+        ~PositionKeeper();
+
+        PositionKeeper(const PositionKeeper&) = delete;
+        PositionKeeper& operator=(const PositionKeeper&) = delete;
+
+        /**
+         * @brief Create a producer ring (call before start())
+         * @return Ring the producing thread pushes fills into
+         */
+        FillRing& addProducer();
+
+        /**
+         * @brief Feed an engine's trades into the keeper as one instrument
+         *
+         * Installs the engine's trade callback. The engine must be driven
+         * by a single thread. Call before start().
+         */
+        void attach(MatchingEngine& engine, uint32_t instrument);
+
+        /**
+         * @brief Start the consumer thread
+         */
+        void start();
+
+        /**
+         * @brief Drain outstanding fills, publish a final snapshot and stop
+         */
+        void stop();
+
+        /**
+         * @brief Wait until every fill pushed so far is visible in a snapshot
+         */
+        void flush();
+
+        /**
+         * @brief Latest published snapshot
+         *
+         * The returned snapshot is immutable; holding it does not block
+         * the consumer, which switches to a fresh buffer instead.
+         */
+        std::shared_ptr<const PositionSnapshot> snapshot() const;
+
+        uint64_t getFillsApplied() const { return fills_applied_.load(std::memory_order_acquire); }
+        uint64_t getFillsRejected() const { return fills_rejected_.load(std::memory_order_relaxed); }
+        uint64_t getSnapshotsPublished() const { return snapshots_published_.load(std::memory_order_relaxed); }
+
+    private:
+        PositionKeeperConfig config_;
+
+        std::vector<std::unique_ptr<FillRing>> rings_;
+        std::vector<Position> positions_;       ///< Consumer-owned live state
+        std::vector<uint64_t> marks_;
+
+        std::shared_ptr<PositionSnapshot> published_;   ///< Read by snapshot()
+        std::shared_ptr<PositionSnapshot> back_;        ///< Filled by the consumer
+        mutable std::mutex publish_mutex_;
+
+        std::thread consumer_;
+        std::atomic<bool> running_;
+        std::atomic<uint64_t> fills_applied_;
+        std::atomic<uint64_t> fills_published_;
+        std::atomic<uint64_t> fills_rejected_;
+        std::atomic<uint64_t> snapshots_published_;
+        std::atomic<bool> publish_requested_;
+
+        void consumerLoop();
+        void apply(const FillEvent& fill);
+        void applyToPosition(Position& position, int64_t signed_quantity, uint64_t price);
+        void publish();
+    };
+
+} // namespace OrderBook
@@ -0,0 +1,46 @@
+/**
+ * @file Probes.h
+ * @brief USDT static tracepoints for the order book simulator
+ * @author Trading Systems Engineer
+ * @date 2024
+ *
+ * All probes live under the "orderbook" provider and can be attached to
+ * with bpftrace, e.g. "usdt:./order_book_simulator:orderbook:order_fill".
+ * Uses <sys/sdt.h> when available and the in-tree SdtFallback.h otherwise.
+ * A probe site costs a single NOP while no tracer is attached. Define
+ * ORDERBOOK_DISABLE_PROBES to compile every probe out entirely.
+ *
+ * Probe                 Arguments
+ * -------------------   ---------------------------------------------
+ * order_accept          order_id, side (0=buy, 1=sell), price, quantity
+ * order_complete        order_id, remaining_quantity
+ * order_fill            buy_order_id, sell_order_id, price, quantity
+ * order_cancel          order_id
+ * level_create          side, price
+ * level_destroy         side, price
+ * task_start            pending_tasks
+ * task_end              -
+ * queue_full            pending_tasks, capacity
+ */
+
+#pragma once
+
+#if defined(ORDERBOOK_DISABLE_PROBES)
+    #define OB_PROBE0(name) do {} while (0)
+    #define OB_PROBE1(name, a1) do { (void)(a1); } while (0)
+    #define OB_PROBE2(name, a1, a2) do { (void)(a1); (void)(a2); } while (0)
+    #define OB_PROBE4(name, a1, a2, a3, a4) \
+        do { (void)(a1); (void)(a2); (void)(a3); (void)(a4); } while (0)
+#elif defined(__has_include) && __has_include(<sys/sdt.h>) && !defined(ORDERBOOK_SDT_FALLBACK)
+    #include <sys/sdt.h>
+    #define OB_PROBE0(name) DTRACE_PROBE(orderbook, name)
+    #define OB_PROBE1(name, a1) DTRACE_PROBE1(orderbook, name, a1)
+    #define OB_PROBE2(name, a1, a2) DTRACE_PROBE2(orderbook, name, a1, a2)
+    #define OB_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(orderbook, name, a1, a2, a3, a4)
+#else
+    #include "SdtFallback.h"
+    #define OB_PROBE0(name) OB_SDT_PROBE0(orderbook, name)
+    #define OB_PROBE1(name, a1) OB_SDT_PROBE1(orderbook, name, a1)
+    #define OB_PROBE2(name, a1, a2) OB_SDT_PROBE2(orderbook, name, a1, a2)
+    #define OB_PROBE4(name, a1, a2, a3, a4) OB_SDT_PROBE4(orderbook, name, a1, a2, a3, a4)
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file RWSpinLock.h
+ * @brief Spinlocks for short critical sections (plain and reader-writer)
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace OrderBook {
+
+    /**
+     * @brief Back off inside a spin loop: pause for a while, then yield
+     * @param spins Per-loop spin counter
+     */
+    inline void spinBackoff(uint32_t& spins) {
+        if (++spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            spins = 0;
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @class SpinLock
+     * @brief Test-and-test-and-set spinlock, Lockable for std::lock_guard
+     */
+    class SpinLock {
+    public:
+        SpinLock() : locked_(false) {}
+
+        SpinLock(const SpinLock&) = delete;
+        SpinLock& operator=(const SpinLock&) = delete;
+
+        void lock() {
+            uint32_t spins = 0;
+            while (locked_.exchange(true, std::memory_order_acquire)) {
+                while (locked_.load(std::memory_order_relaxed)) {
+                    spinBackoff(spins);
+                }
+            }
+        }
+
+        bool try_lock() {
+            return !locked_.load(std::memory_order_relaxed) &&
+                   !locked_.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() {
+            locked_.store(false, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<bool> locked_;
+    };
+
+    /**
+     * @class RWSpinLock
+     * @brief Reader-writer spinlock that favours the writer
+     *
+     * Readers share the lock; a writer waiting for it raises a flag that
+     * stops new readers from entering, so the matcher waits at most for the
+     * readers already inside rather than for a stream of new ones. Satisfies
+     * Lockable and SharedLockable, so it works with std::unique_lock and
+     * std::shared_lock. Spins briefly, then yields, so it stays fair on
+     * oversubscribed cores.
+     */
+    class RWSpinLock {
+    public:
+        RWSpinLock() : state_(0) {}
+
+        RWSpinLock(const RWSpinLock&) = delete;
+        RWSpinLock& operator=(const RWSpinLock&) = delete;
+
+        void lock() {
+            uint32_t spins = 0;
+            while (true) {
+                uint32_t state = state_.load(std::memory_order_relaxed);
+                if ((state & ~kWriterWaiting) == 0) {
+                    // Taking the lock also clears the waiting flag
+                    if (state_.compare_exchange_weak(state, kWriter, std::memory_order_acquire)) {
+                        return;
+                    }
+                    continue;
+                }
+                if (!(state & kWriterWaiting)) {
+                    state_.fetch_or(kWriterWaiting, std::memory_order_relaxed);
+                }
+                spinBackoff(spins);
+            }
+        }
+
+        bool try_lock() {
+            uint32_t state = state_.load(std::memory_order_relaxed);
+            return (state & ~kWriterWaiting) == 0 &&
+                   state_.compare_exchange_strong(state, kWriter, std::memory_order_acquire);
+        }
+
+        void unlock() {
+            state_.fetch_and(~kWriter, std::memory_order_release);
+        }
+
+        void lock_shared() {
+            uint32_t spins = 0;
+            while (true) {
+                uint32_t state = state_.load(std::memory_order_relaxed);
+                if (!(state & (kWriter | kWriterWaiting))) {
+                    if (state_.compare_exchange_weak(state, state + kReader, std::memory_order_acquire)) {
+                        return;
+                    }
+                    continue;
+                }
+                spinBackoff(spins);
+            }
+        }
+
+        bool try_lock_shared() {
+            uint32_t state = state_.load(std::memory_order_relaxed);
+            return !(state & (kWriter | kWriterWaiting)) &&
+                   state_.compare_exchange_strong(state, state + kReader, std::memory_order_acquire);
+        }
+
+        void unlock_shared() {
+            state_.fetch_sub(kReader, std::memory_order_release);
+        }
+
+    private:
+        static constexpr uint32_t kWriter = 1;         ///< Held exclusively
+        static constexpr uint32_t kWriterWaiting = 2;  ///< A writer is queued; readers hold off
+        static constexpr uint32_t kReader = 4;         ///< One reader (count in the upper bits)
+
+        std::atomic<uint32_t> state_;
+    };
+
+} // namespace OrderBook
@@ -0,0 +1,91 @@
+/**
+ * @file SdtFallback.h
+ * @brief In-tree fallback for <sys/sdt.h> static tracepoints
+ * @author Trading Systems Engineer
+ * @date 2024
+ *
+ * Emits SystemTap-compatible ".note.stapsdt" ELF notes so that bpftrace,
+ * perf and SystemTap can attach to USDT probes on hosts where the systemtap
+ * development headers are not installed. Each probe site compiles to a
+ * single NOP; argument locations are recorded in the note and only read
+ * when a tracer attaches. Only x86-64 and AArch64 ELF targets are
+ * supported, everything else compiles the probes away.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+    #define OB_SDT_SUPPORTED 1
+#else
+    #define OB_SDT_SUPPORTED 0
+#endif
+
+#if OB_SDT_SUPPORTED
+
+    #if defined(__x86_64__)
+        #define OB_SDT_ASM_ADDR ".8byte"
+    #else
+        #define OB_SDT_ASM_ADDR ".dword"
+    #endif
+
+    #define OB_SDT_STR_(x) #x
+    #define OB_SDT_STR(x) OB_SDT_STR_(x)
+
+    // Note layout follows the stapsdt v3 format: probe PC, link-time base,
+    // semaphore address (unused), provider, probe name and argument string.
+    #define OB_SDT_NOTE(provider, name, args)                                      \
+        "990: nop\n"                                                               \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                              \
+        ".balign 4\n"                                                              \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                         \
+        "991: .asciz \"stapsdt\"\n"                                                \
+        "992: .balign 4\n"                                                         \
+        "993: " OB_SDT_ASM_ADDR " 990b\n"                                          \
+        OB_SDT_ASM_ADDR " _.stapsdt.base\n"                                        \
+        OB_SDT_ASM_ADDR " 0\n"                                                     \
+        ".asciz \"" OB_SDT_STR(provider) "\"\n"                                    \
+        ".asciz \"" OB_SDT_STR(name) "\"\n"                                        \
+        ".asciz \"" args "\"\n"                                                    \
+        "994: .balign 4\n"                                                         \
+        ".popsection\n"                                                            \
+        ".ifndef _.stapsdt.base\n"                                                 \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"    \
+        ".weak _.stapsdt.base\n"                                                   \
+        ".hidden _.stapsdt.base\n"                                                 \
+        "_.stapsdt.base: .space 1\n"                                               \
+        ".size _.stapsdt.base, 1\n"                                                \
+        ".popsection\n"                                                            \
+        ".endif\n"
+
+    #define OB_SDT_ARG(x) "nor"(static_cast<uint64_t>(x))
+
+    #define OB_SDT_PROBE0(provider, name)                                          \
+        __asm__ __volatile__(OB_SDT_NOTE(provider, name, ""))
+    #define OB_SDT_PROBE1(provider, name, a1)                                      \
+        __asm__ __volatile__(OB_SDT_NOTE(provider, name, "8@%0")                   \
+                             :: OB_SDT_ARG(a1))
+    #define OB_SDT_PROBE2(provider, name, a1, a2)                                  \
+        __asm__ __volatile__(OB_SDT_NOTE(provider, name, "8@%0 8@%1")              \
+                             :: OB_SDT_ARG(a1), OB_SDT_ARG(a2))
+    #define OB_SDT_PROBE3(provider, name, a1, a2, a3)                              \
+        __asm__ __volatile__(OB_SDT_NOTE(provider, name, "8@%0 8@%1 8@%2")         \
+                             :: OB_SDT_ARG(a1), OB_SDT_ARG(a2), OB_SDT_ARG(a3))
+    #define OB_SDT_PROBE4(provider, name, a1, a2, a3, a4)                          \
+        __asm__ __volatile__(OB_SDT_NOTE(provider, name, "8@%0 8@%1 8@%2 8@%3")    \
+                             :: OB_SDT_ARG(a1), OB_SDT_ARG(a2), OB_SDT_ARG(a3),    \
+                                OB_SDT_ARG(a4))
+
+#else
+
+    #define OB_SDT_PROBE0(provider, name) do {} while (0)
+    #define OB_SDT_PROBE1(provider, name, a1) do { (void)(a1); } while (0)
+    #define OB_SDT_PROBE2(provider, name, a1, a2) \
+        do { (void)(a1); (void)(a2); } while (0)
+    #define OB_SDT_PROBE3(provider, name, a1, a2, a3) \
+        do { (void)(a1); (void)(a2); (void)(a3); } while (0)
+    #define OB_SDT_PROBE4(provider, name, a1, a2, a3, a4) \
+        do { (void)(a1); (void)(a2); (void)(a3); (void)(a4); } while (0)
+
+#endif
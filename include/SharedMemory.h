@@ -0,0 +1,44 @@
+/**
+ * @file SharedMemory.h
+ * @brief Objects in anonymous shared memory for processes related by fork()
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+
+namespace OrderBook {
+
+    /**
+     * @brief Construct a T in a fresh MAP_SHARED mapping
+     *
+     * Create before fork(); parent and children then see the same object.
+     * T must be safe to share between processes: trivially copyable data
+     * and lock-free atomics only (e.g. SpscRing of POD records).
+     *
+     * @throws std::runtime_error if the mapping fails
+     */
+    template<typename T>
+    T* createShared() {
+        void* memory = mmap(nullptr, sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error("createShared: mmap failed");
+        }
+        return new (memory) T();
+    }
+
+    /**
+     * @brief Destroy and unmap an object from createShared()
+     */
+    template<typename T>
+    void destroyShared(T* object) {
+        if (!object) return;
+        object->~T();
+        munmap(object, sizeof(T));
+    }
+
+} // namespace OrderBook
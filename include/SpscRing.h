@@ -0,0 +1,110 @@
+/**
+ * @file SpscRing.h
+ * @brief Bounded single-producer single-consumer ring buffer
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+
+namespace OrderBook {
+
+    /**
+     * @class SpscRing
+     * @brief Lock-free bounded queue between exactly one producer and one consumer
+     *
+     * Storage is inline and head/tail live on separate cache lines, so a
+     * ring of trivially copyable elements can be placed in shared memory.
+     * Each side caches the other's index to avoid touching the shared
+     * cache line on every operation.
+     *
+     * @tparam T Element type
+     * @tparam Capacity Number of slots, must be a power of two
+     */
+    template<typename T, size_t Capacity>
+    class SpscRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                      "SpscRing capacity must be a power of two");
+
+    public:
+        SpscRing() : head_(0), cached_tail_(0), tail_(0), cached_head_(0) {}
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /**
+         * @brief Enqueue an element (producer only)
+         * @return false if the ring is full
+         */
+        bool tryPush(const T& value) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cached_head_ == Capacity) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail - cached_head_ == Capacity) {
+                    return false;
+                }
+            }
+            slots_[tail & (Capacity - 1)] = value;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Enqueue, spinning while the consumer catches up (producer only)
+         */
+        void push(const T& value) {
+            while (!tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Dequeue an element (consumer only)
+         * @return false if the ring is empty
+         */
+        bool tryPop(T& value) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cached_tail_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head == cached_tail_) {
+                    return false;
+                }
+            }
+            value = slots_[head & (Capacity - 1)];
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Approximate number of queued elements
+         */
+        size_t size() const {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const { return size() == 0; }
+
+        /**
+         * @brief Total elements ever pushed
+         */
+        size_t pushedCount() const { return tail_.load(std::memory_order_acquire); }
+
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        static constexpr size_t kCacheLine = 64;
+
+        alignas(kCacheLine) std::atomic<size_t> head_;   ///< Next slot to read (consumer)
+        size_t cached_tail_;                             ///< Consumer's view of tail_
+        alignas(kCacheLine) std::atomic<size_t> tail_;   ///< Next slot to write (producer)
+        size_t cached_head_;                             ///< Producer's view of head_
+        alignas(kCacheLine) std::array<T, Capacity> slots_;
+    };
+
+} // namespace OrderBook
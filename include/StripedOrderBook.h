@@ -0,0 +1,183 @@
+/**
+ * @file StripedOrderBook.h
+ * @brief Order book with per-price-level locks for concurrent passive flow
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "Order.h"
+#include "RWSpinLock.h"
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <array>
+
+namespace OrderBook {
+
+    /**
+     * @class StripedOrderBook
+     * @brief Concurrent order book for a fixed price band
+     *
+     * Price levels live in a flat ladder over [min_price, max_price], each
+     * with its own spinlock, and the order index is striped by order ID.
+     * Adds that do not cross and cancels hold the book's structure lock
+     * shared plus the one level and stripe they touch, so passive flow on
+     * different levels runs in parallel. Crossing orders escalate to the
+     * structure lock held exclusively and match with price-time priority.
+     *
+     * Best bid/ask are tracked as atomic hints that never understate how
+     * aggressive the book is (bid hint >= best bid, ask hint <= best ask).
+     * Passive adds raise them with a CAS; only the exclusive path tightens
+     * them. A passive add publishes its level and hint before checking the
+     * opposite side, so of two adds that would cross each other at least
+     * one sees the other and escalates.
+     */
+    class StripedOrderBook {
+    public:
+        /**
+         * @brief Constructor
+         * @param symbol Trading symbol
+         * @param min_price Lowest accepted price
+         * @param max_price Highest accepted price
+         */
+        StripedOrderBook(const std::string& symbol, uint64_t min_price, uint64_t max_price);
+
+        // Non-copyable and non-movable (locks and atomics)
+        StripedOrderBook(const StripedOrderBook&) = delete;
+        StripedOrderBook& operator=(const StripedOrderBook&) = delete;
+
+        /**
+         * @brief Match an order and rest any remainder
+         * @param order Order to submit
+         * @return false if the price is outside the band or the ID is in use
+         */
+        bool submitOrder(std::shared_ptr<Order> order);
+
+        /**
+         * @brief Cancel a resting order
+         * @param order_id Order ID to cancel
+         * @return true if order was found and cancelled
+         */
+        bool cancelOrder(Order::OrderID order_id);
+
+        /**
+         * @brief Get best bid price
+         * @return Best bid price, 0 if no bids
+         */
+        uint64_t getBestBid() const;
+
+        /**
+         * @brief Get best ask price
+         * @return Best ask price, 0 if no asks
+         */
+        uint64_t getBestAsk() const;
+
+        /**
+         * @brief Get market depth
+         * @param levels Number of levels per side
+         * @return Pair of (bid_levels, ask_levels) as (price, quantity)
+         */
+        std::pair<std::vector<std::pair<uint64_t, uint64_t>>,
+                  std::vector<std::pair<uint64_t, uint64_t>>>
+        getMarketDepth(size_t levels = 10) const;
+
+        /**
+         * @brief Get number of resting orders
+         */
+        size_t getOrderCount() const { return order_count_.load(); }
+
+        /**
+         * @brief Get total number of trades executed
+         */
+        uint64_t getTradeCount() const { return trade_count_.load(); }
+
+        /**
+         * @brief Get total volume traded
+         */
+        uint64_t getTotalVolume() const { return total_volume_.load(); }
+
+        /**
+         * @brief Get number of orders that took the exclusive path
+         */
+        uint64_t getEscalations() const { return escalations_.load(); }
+
+        /**
+         * @brief Get trading symbol
+         */
+        const std::string& getSymbol() const { return symbol_; }
+
+    private:
+        static constexpr size_t kOrderStripes = 64;
+
+        /**
+         * @brief One price in the ladder
+         */
+        struct alignas(64) Level {
+            SpinLock lock;                               ///< Guards orders
+            std::atomic<uint64_t> total_quantity{0};     ///< Remaining quantity at this price
+            std::atomic<uint32_t> order_count{0};        ///< Resting orders at this price
+            std::vector<std::shared_ptr<Order>> orders;  ///< Orders in time priority
+        };
+
+        /**
+         * @brief One shard of the order ID index
+         */
+        struct alignas(64) OrderStripe {
+            SpinLock lock;
+            std::unordered_map<Order::OrderID, std::shared_ptr<Order>> orders;
+        };
+
+        std::string symbol_;
+        uint64_t min_price_;
+        std::vector<Level> bids_;                        ///< Indexed by price - min_price
+        std::vector<Level> asks_;
+        std::array<OrderStripe, kOrderStripes> stripes_;
+        mutable RWSpinLock structure_lock_;              ///< Shared for passive flow, exclusive to match
+
+        // Hints as ladder indices: -1 means no bids, ladder size means no asks
+        alignas(64) std::atomic<int64_t> bid_hint_;
+        alignas(64) std::atomic<int64_t> ask_hint_;
+
+        alignas(64) std::atomic<size_t> order_count_;
+        std::atomic<uint64_t> trade_count_;
+        std::atomic<uint64_t> total_volume_;
+        std::atomic<uint64_t> escalations_;
+
+        int64_t ladderSize() const { return static_cast<int64_t>(bids_.size()); }
+
+        /**
+         * @brief Whether a limit at this ladder index would cross resting orders
+         */
+        bool crosses(OrderSide side, int64_t index) const;
+
+        /**
+         * @brief Best non-empty index at or behind the hint, or the no-price sentinel
+         */
+        int64_t bestBidIndex() const;
+        int64_t bestAskIndex() const;
+
+        /**
+         * @brief Insert into index and level and raise the side's hint
+         * @return false if the order ID is already resting
+         */
+        bool rest(const std::shared_ptr<Order>& order, int64_t index);
+
+        /**
+         * @brief Remove from index and level
+         * @return The removed order, nullptr if not resting
+         */
+        std::shared_ptr<Order> unrest(Order::OrderID order_id);
+
+        /**
+         * @brief Match and rest with the structure lock held exclusively
+         */
+        bool submitExclusive(const std::shared_ptr<Order>& order, int64_t index);
+
+        OrderStripe& stripeFor(Order::OrderID order_id) { return stripes_[order_id % kOrderStripes]; }
+    };
+
+} // namespace OrderBook
@@ -9,22 +9,106 @@
 
 #include <vector>
 #include <thread>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <atomic>
 #include <memory>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <exception>
+#include <string>
+#include "PerformanceMonitor.h"
+#include "Probes.h"
 
 namespace OrderBook {
 
+    /**
+     * @enum TaskPriority
+     * @brief Queue lane a task is scheduled on
+     */
+    enum class TaskPriority {
+        CRITICAL = 0,   ///< Risk checks, snapshot publishing
+        NORMAL = 1,     ///< Default lane (order processing)
+        BULK = 2        ///< Analytics and other background work
+    };
+
+    /**
+     * @enum LanePolicy
+     * @brief How workers choose between non-empty lanes
+     */
+    enum class LanePolicy {
+        STRICT,         ///< Always serve the highest-priority non-empty lane
+        WEIGHTED        ///< Smooth weighted round robin by lane weight
+    };
+
+    /**
+     * @struct TaskOptions
+     * @brief Scheduling options for ThreadPool::schedule()
+     */
+    struct TaskOptions {
+        using Clock = std::chrono::steady_clock;
+
+        TaskPriority priority = TaskPriority::NORMAL;
+        Clock::time_point deadline = Clock::time_point::max();  ///< max() = no deadline
+
+        /**
+         * @brief Options for a task that should start within a time budget
+         */
+        static TaskOptions within(TaskPriority priority, std::chrono::nanoseconds budget) {
+            TaskOptions options;
+            options.priority = priority;
+            options.deadline = Clock::now() + budget;
+            return options;
+        }
+    };
+
+    /**
+     * @struct LaneStats
+     * @brief Queueing-delay statistics for one lane
+     */
+    struct LaneStats {
+        LatencyHistogram queue_delay;      ///< Enqueue to dequeue, in ns
+        uint64_t executed = 0;             ///< Tasks dequeued from the lane
+        uint64_t deadline_misses = 0;      ///< Tasks dequeued after their deadline
+        size_t pending = 0;                ///< Tasks currently queued
+    };
+
+    /**
+     * @struct ElasticConfig
+     * @brief Sizing policy for an elastic ThreadPool
+     */
+    struct ElasticConfig {
+        size_t min_workers = 1;                                   ///< Never shrink below this
+        size_t max_workers = 4;                                   ///< Never grow beyond this
+        std::chrono::microseconds target_queue_delay{500};        ///< Grow when tasks wait longer
+        std::chrono::milliseconds idle_timeout{100};              ///< Retire a worker idle this long
+        std::chrono::microseconds sample_interval{250};           ///< Supervisor check period
+    };
+
+    /**
+     * @struct ResizeEvent
+     * @brief One elastic resize decision
+     */
+    struct ResizeEvent {
+        std::chrono::steady_clock::time_point when;
+        size_t from;                    ///< Workers before
+        size_t to;                      ///< Workers after
+        uint64_t trigger_ns;            ///< Queue delay (grow) or idle time (shrink) that triggered it
+    };
+
     /**
      * @class ThreadPool
      * @brief Lock-free thread pool for high-frequency order processing
      * 
      * Implements a work-stealing thread pool optimized for low-latency
      * trading applications with minimal contention and maximum throughput.
+     * Tasks are queued on priority lanes (critical, normal, bulk) so that
+     * latency-sensitive work never waits behind background analytics.
      */
     class ThreadPool {
     public:
@@ -34,6 +118,17 @@ namespace OrderBook {
          */
         explicit ThreadPool(size_t num_threads = 0);
 
+        /**
+         * @brief Constructor for an elastic pool
+         * @param config Worker bounds and resize triggers
+         *
+         * Starts min_workers threads. A supervisor adds a worker when the
+         * queue has been waiting longer than the target delay with no idle
+         * worker, and a worker retires after idle_timeout without work.
+         * Running tasks are never interrupted by a resize.
+         */
+        explicit ThreadPool(const ElasticConfig& config);
+
         /**
          * @brief Destructor
          */
@@ -63,11 +158,85 @@ namespace OrderBook {
         template<typename F, typename... Args>
         void submitDetached(F&& func, Args&&... args);
 
+        /**
+         * @brief Submit a task to a specific lane, optionally with a deadline
+         * @param options Lane and deadline
+         * @param func Function to execute
+         * @param args Function arguments
+         * @return Future containing the result
+         *
+         * Within a lane, tasks with deadlines run earliest-deadline-first
+         * ahead of tasks without one, which keep FIFO order.
+         */
+        template<typename F, typename... Args>
+        auto schedule(const TaskOptions& options, F&& func, Args&&... args)
+            -> std::future<typename std::invoke_result<F, Args...>::type>;
+
+        /**
+         * @brief Submit one task per element of a range under a single lock
+         * @param first Start of the range
+         * @param last End of the range
+         * @param func Function invoked as func(element); elements are copied into the tasks
+         * @return One future per element, in range order
+         *
+         * Tasks are built outside the lock, enqueued in one critical section
+         * and woken with one notify per task up to the worker count, so a
+         * burst of N tasks costs one lock round trip instead of N.
+         */
+        template<typename Iterator, typename F>
+        auto submitBulk(Iterator first, Iterator last, F func)
+            -> std::vector<std::future<std::invoke_result_t<F&, typename std::iterator_traits<Iterator>::value_type&>>>;
+
+        /**
+         * @brief Submit one task per element of a container under a single lock
+         */
+        template<typename Range, typename F>
+        auto submitBulk(const Range& range, F func) {
+            return submitBulk(std::begin(range), std::end(range), std::move(func));
+        }
+
+        /**
+         * @brief Run fn over [begin, end) in chunks across the pool
+         * @param begin First index
+         * @param end One past the last index
+         * @param grain Indices per chunk (0 = about four chunks per worker)
+         * @param fn Called as fn(chunk_begin, chunk_end)
+         *
+         * Workers and the calling thread claim chunks from a shared atomic
+         * cursor, so faster threads take more chunks. The caller always
+         * participates and never waits on a queued task, so calling this
+         * from inside a pool task cannot deadlock. The first exception
+         * thrown by fn is rethrown once all chunks have finished.
+         */
+        template<typename F>
+        void parallelFor(size_t begin, size_t end, size_t grain, F&& fn);
+
+        /**
+         * @brief Map chunks of [begin, end) across the pool and combine the results
+         * @param identity Initial value for the combination
+         * @param map Called as map(chunk_begin, chunk_end), returns T
+         * @param combine Called as combine(T accumulated, T chunk_result), returns T
+         * @return Combined result; chunks are combined in index order, so the
+         *         result does not depend on scheduling
+         */
+        template<typename T, typename Map, typename Combine>
+        T parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Combine&& combine);
+
         /**
          * @brief Get number of worker threads
          * @return Thread count
          */
-        size_t getThreadCount() const { return workers_.size(); }
+        size_t getThreadCount() const { return live_workers_.load(); }
+
+        /**
+         * @brief Check if the pool resizes itself
+         */
+        bool isElastic() const { return elastic_; }
+
+        /**
+         * @brief Get the resize decisions made so far (most recent last)
+         */
+        std::vector<ResizeEvent> getResizeEvents() const;
 
         /**
          * @brief Get number of pending tasks
@@ -75,6 +244,38 @@ namespace OrderBook {
          */
         size_t getPendingTaskCount() const;
 
+        /**
+         * @brief Set the queue depth at which the pool reports itself full
+         * @param capacity Pending task count that fires the queue_full probe
+         *
+         * The queue itself stays unbounded; the capacity only marks the
+         * backlog level worth surfacing to tracers.
+         */
+        void setQueueCapacity(size_t capacity) { queue_capacity_.store(capacity); }
+
+        /**
+         * @brief Get the queue depth considered full
+         * @return Queue capacity
+         */
+        size_t getQueueCapacity() const { return queue_capacity_.load(); }
+
+        /**
+         * @brief Choose how workers pick between lanes
+         * @param policy Strict priority or weighted round robin
+         * @param weights Relative share per lane (CRITICAL, NORMAL, BULK) for WEIGHTED
+         */
+        void setLanePolicy(LanePolicy policy, std::array<uint32_t, 3> weights = {8, 4, 1});
+
+        /**
+         * @brief Get queueing-delay statistics for a lane
+         */
+        LaneStats getLaneStats(TaskPriority priority) const;
+
+        /**
+         * @brief Reset per-lane statistics
+         */
+        void resetLaneStats();
+
         /**
          * @brief Stop the thread pool and wait for all tasks to complete
          */
@@ -97,28 +298,156 @@ namespace OrderBook {
          */
         std::string getStats() const;
 
+        /**
+         * @brief Get live and peak bytes of the lane heaps
+         *
+         * Counts queued task slots. Callables too large for
+         * std::function's inline buffer allocate separately and are not
+         * included.
+         */
+        MemoryStats getMemoryStats() const;
+
+        static constexpr size_t kLaneCount = 3;
+
     private:
-        std::vector<std::thread> workers_;           ///< Worker threads
-        std::queue<std::function<void()>> tasks_;    ///< Task queue
+        using Clock = TaskOptions::Clock;
+
+        /**
+         * @brief Queued task with its scheduling keys
+         */
+        struct QueuedTask {
+            Clock::time_point deadline;      ///< EDF key (max() = none)
+            uint64_t sequence;               ///< FIFO tie-break
+            Clock::time_point enqueued;
+            std::function<void()> func;
+        };
+
+        /**
+         * @brief One priority lane: a min-heap on (deadline, sequence)
+         */
+        struct Lane {
+            std::vector<QueuedTask> heap;
+            int64_t credit = 0;              ///< Weighted round robin state
+            uint32_t weight = 1;
+            LaneStats stats;
+        };
+
+        std::vector<std::thread> workers_;           ///< Worker threads (guarded by queue_mutex_)
+        std::vector<std::thread::id> retired_;       ///< Exited workers awaiting join
+        std::atomic<size_t> live_workers_;           ///< Workers not retired
+        size_t idle_workers_;                        ///< Workers waiting for tasks
+        std::array<Lane, kLaneCount> lanes_;         ///< Task queues by priority
+        size_t pending_;                             ///< Tasks queued across lanes
+        uint64_t next_sequence_;                     ///< Enqueue order
+        MemoryTracker queue_memory_;                 ///< Capacity of the lane heaps in bytes
+        LanePolicy lane_policy_;
         mutable std::mutex queue_mutex_;             ///< Queue mutex
         std::condition_variable condition_;          ///< Condition variable
         std::atomic<bool> stop_;                     ///< Stop flag
+        std::atomic<size_t> queue_capacity_;         ///< Backlog reported as full
         
         // Statistics
         mutable std::atomic<uint64_t> tasks_completed_;  ///< Completed task count
         mutable std::atomic<uint64_t> tasks_submitted_;  ///< Submitted task count
         mutable std::mutex stats_mutex_;             ///< Stats mutex
         
+        // Elastic sizing
+        static constexpr size_t kMaxResizeEvents = 1024;
+        bool elastic_;
+        ElasticConfig elastic_config_;
+        std::thread supervisor_;
+        std::condition_variable supervisor_condition_;
+        Clock::time_point last_dequeue_;
+        uint64_t last_queue_delay_ns_;
+        Clock::time_point last_grow_;
+        std::vector<ResizeEvent> resize_events_;     ///< Guarded by queue_mutex_
+        uint64_t grow_count_;
+        uint64_t shrink_count_;
+        
+        /**
+         * @brief Common constructor
+         * @param elastic Elastic sizing, nullptr for a fixed pool
+         */
+        ThreadPool(size_t num_threads, const ElasticConfig* elastic);
+
+        /**
+         * @brief Launch worker threads (queue_mutex_ held or no workers running yet)
+         */
+        void addWorkersLocked(size_t count);
+
+        /**
+         * @brief Elastic supervisor: grows on queue delay, reaps retired workers
+         */
+        void supervisor();
+
+        /**
+         * @brief Append to the resize log (queue_mutex_ held)
+         */
+        void recordResizeLocked(size_t from, size_t to, uint64_t trigger_ns);
+        
         /**
          * @brief Worker thread function
          */
         void worker();
+
+        /**
+         * @brief Wake enough workers for a number of newly queued tasks
+         */
+        void notifyWorkers(size_t task_count);
+
+        /**
+         * @brief Shared cursor for one parallelFor/parallelReduce call
+         */
+        struct ParallelRange {
+            size_t begin;
+            size_t end;
+            size_t grain;
+            size_t chunks;
+            std::atomic<size_t> next_chunk{0};
+            std::atomic<size_t> done_chunks{0};
+            std::mutex error_mutex;
+            std::exception_ptr error;
+        };
+
+        /**
+         * @brief Claim and run chunks until none are left
+         */
+        template<typename F>
+        static void drainChunks(ParallelRange& range, F& fn);
+
+        /**
+         * @brief Split a range into chunks and run fn(chunk, chunk_begin, chunk_end) on them
+         * @return Number of chunks
+         */
+        template<typename F>
+        size_t parallelChunks(size_t begin, size_t end, size_t grain, F& fn);
+
+        /**
+         * @brief Heap order for a lane: earliest deadline, then FIFO
+         */
+        static bool runsLater(const QueuedTask& lhs, const QueuedTask& rhs);
+
+        /**
+         * @brief Push a task onto a lane (queue_mutex_ must be held)
+         */
+        void enqueueLocked(const TaskOptions& options, std::function<void()> func);
+
+        /**
+         * @brief Pop the next task according to the lane policy (queue_mutex_ held, pending_ > 0)
+         */
+        std::function<void()> dequeueLocked();
     };
 
     // Template implementation
     template<typename F, typename... Args>
     auto ThreadPool::submit(F&& func, Args&&... args) 
         -> std::future<typename std::invoke_result<F, Args...>::type> {
+        return schedule(TaskOptions(), std::forward<F>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename F, typename... Args>
+    auto ThreadPool::schedule(const TaskOptions& options, F&& func, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
         
         using ReturnType = typename std::invoke_result<F, Args...>::type;
         
@@ -135,8 +464,12 @@ namespace OrderBook {
                 throw std::runtime_error("ThreadPool is stopped");
             }
             
-            tasks_.emplace([task]() { (*task)(); });
+            enqueueLocked(options, [task]() { (*task)(); });
             tasks_submitted_.fetch_add(1);
+            
+            if (pending_ >= queue_capacity_.load(std::memory_order_relaxed)) {
+                OB_PROBE2(queue_full, pending_, queue_capacity_.load(std::memory_order_relaxed));
+            }
         }
         
         condition_.notify_one();
@@ -152,11 +485,159 @@ namespace OrderBook {
                 return;
             }
             
-            tasks_.emplace(std::bind(std::forward<F>(func), std::forward<Args>(args)...));
+            enqueueLocked(TaskOptions(), std::bind(std::forward<F>(func), std::forward<Args>(args)...));
             tasks_submitted_.fetch_add(1);
+            
+            if (pending_ >= queue_capacity_.load(std::memory_order_relaxed)) {
+                OB_PROBE2(queue_full, pending_, queue_capacity_.load(std::memory_order_relaxed));
+            }
         }
         
         condition_.notify_one();
     }
 
+    template<typename Iterator, typename F>
+    auto ThreadPool::submitBulk(Iterator first, Iterator last, F func)
+        -> std::vector<std::future<std::invoke_result_t<F&, typename std::iterator_traits<Iterator>::value_type&>>> {
+        
+        using Element = typename std::iterator_traits<Iterator>::value_type;
+        using ReturnType = std::invoke_result_t<F&, Element&>;
+        
+        // Shared by every task so the callable is not copied per element
+        auto shared_func = std::make_shared<F>(std::move(func));
+        
+        std::vector<std::function<void()>> bulk;
+        std::vector<std::future<ReturnType>> results;
+        for (; first != last; ++first) {
+            auto task = std::make_shared<std::packaged_task<ReturnType()>>(
+                [shared_func, element = Element(*first)]() mutable { return (*shared_func)(element); }
+            );
+            results.push_back(task->get_future());
+            bulk.emplace_back([task]() { (*task)(); });
+        }
+        
+        if (bulk.empty()) {
+            return results;
+        }
+        
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            
+            if (stop_.load()) {
+                throw std::runtime_error("ThreadPool is stopped");
+            }
+            
+            const TaskOptions options;
+            for (auto& task : bulk) {
+                enqueueLocked(options, std::move(task));
+            }
+            tasks_submitted_.fetch_add(bulk.size());
+            
+            if (pending_ >= queue_capacity_.load(std::memory_order_relaxed)) {
+                OB_PROBE2(queue_full, pending_, queue_capacity_.load(std::memory_order_relaxed));
+            }
+        }
+        
+        notifyWorkers(bulk.size());
+        return results;
+    }
+
+    template<typename F>
+    void ThreadPool::drainChunks(ParallelRange& range, F& fn) {
+        while (true) {
+            size_t chunk = range.next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= range.chunks) {
+                return;
+            }
+            
+            size_t chunk_begin = range.begin + chunk * range.grain;
+            size_t chunk_end = std::min(range.end, chunk_begin + range.grain);
+            try {
+                fn(chunk, chunk_begin, chunk_end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(range.error_mutex);
+                if (!range.error) range.error = std::current_exception();
+            }
+            range.done_chunks.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    template<typename F>
+    size_t ThreadPool::parallelChunks(size_t begin, size_t end, size_t grain, F& fn) {
+        if (end <= begin) {
+            return 0;
+        }
+        
+        const size_t count = end - begin;
+        const size_t workers = std::max<size_t>(live_workers_.load(), 1);
+        if (grain == 0) {
+            grain = std::max<size_t>(count / (workers * 4), 1);
+        }
+        const size_t chunks = (count + grain - 1) / grain;
+        
+        if (chunks == 1) {
+            fn(0, begin, end);
+            return 1;
+        }
+        
+        auto range = std::make_shared<ParallelRange>();
+        range->begin = begin;
+        range->end = end;
+        range->grain = grain;
+        range->chunks = chunks;
+        
+        // Helpers that start after every chunk is claimed return without touching fn
+        size_t helpers = std::min(workers, chunks - 1);
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (stop_.load()) {
+                helpers = 0;
+            }
+            for (size_t i = 0; i < helpers; ++i) {
+                enqueueLocked(TaskOptions(), [range, &fn]() { drainChunks(*range, fn); });
+            }
+            tasks_submitted_.fetch_add(helpers);
+        }
+        notifyWorkers(helpers);
+        
+        drainChunks(*range, fn);
+        while (range->done_chunks.load(std::memory_order_acquire) < chunks) {
+            std::this_thread::yield();
+        }
+        
+        if (range->error) {
+            std::rethrow_exception(range->error);
+        }
+        return chunks;
+    }
+
+    template<typename F>
+    void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, F&& fn) {
+        auto body = [&fn](size_t, size_t chunk_begin, size_t chunk_end) { fn(chunk_begin, chunk_end); };
+        parallelChunks(begin, end, grain, body);
+    }
+
+    template<typename T, typename Map, typename Combine>
+    T ThreadPool::parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Combine&& combine) {
+        if (end <= begin) {
+            return identity;
+        }
+        
+        // Size for the worst case so chunks can write their slot without locking
+        const size_t workers = std::max<size_t>(live_workers_.load(), 1);
+        size_t effective_grain = grain ? grain : std::max<size_t>((end - begin) / (workers * 4), 1);
+        std::vector<T> partials((end - begin + effective_grain - 1) / effective_grain, identity);
+        
+        auto body = [&map, &partials](size_t chunk, size_t chunk_begin, size_t chunk_end) {
+            partials[chunk] = map(chunk_begin, chunk_end);
+        };
+        size_t chunks = parallelChunks(begin, end, effective_grain, body);
+        
+        T result = std::move(identity);
+        for (size_t i = 0; i < chunks; ++i) {
+            result = combine(std::move(result), std::move(partials[i]));
+        }
+        return result;
+    }
+
 } // namespace OrderBook
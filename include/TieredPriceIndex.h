@@ -0,0 +1,455 @@
+/**
+ * @file TieredPriceIndex.h
+ * @brief Two-tier price index: dense array near the touch, B+-tree behind it
+ * @author Trading Systems Engineer
+ * @date 2024
+ */
+
+#pragma once
+
+#include "BTreePriceIndex.h"
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace OrderBook {
+
+    /**
+     * @class TieredPriceIndex
+     * @brief Ordered price -> value index tuned for flow at the touch
+     *
+     * Levels within a window of W ticks (a power of two) around the best
+     * price live in a dense array indexed by price mod W, with an occupancy
+     * bitmap; everything further out lives in a BTreePriceIndex. Finding,
+     * adding and removing a level in the window is an array access.
+     *
+     * The window places the best price a quarter of the way in from the
+     * touch side, leaving room for the touch to improve. When the best
+     * price moves past the window, or drifts half a window back into the
+     * book, the window is moved to put it in place again. Levels that
+     * leave the window move to the tree and levels it now covers move in.
+     * Slots are indexed by price, so levels that stay put do not move, and
+     * each recenter shifts the window at least W/2 ticks, which amortizes
+     * the migration.
+     *
+     * Every level in the tree lies behind the window (below it for bids),
+     * so iteration is one tier followed by the other. Unlike std::map,
+     * inserting or erasing may move other levels between tiers, so
+     * references and iterators are only valid until the next insert or
+     * erase. Provides the subset of the std::map interface the order book
+     * uses.
+     */
+    template<typename V>
+    class TieredPriceIndex {
+    public:
+        using key_type = uint64_t;
+        using mapped_type = V;
+        using value_type = std::pair<const uint64_t, V>;
+        using size_type = size_t;
+        using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+
+        /**
+         * @brief Which end of the index is the best price
+         */
+        enum class Touch {
+            HIGH,   ///< Bids: best is the highest price
+            LOW     ///< Asks: best is the lowest price
+        };
+
+        static constexpr uint32_t kDefaultWindow = 256;   ///< Ticks in the dense tier
+
+    private:
+        using Cold = BTreePriceIndex<V>;
+        enum class Tier : uint8_t { HOT, COLD, END };
+
+        struct Position {
+            Tier tier = Tier::END;
+            uint32_t offset = 0;                  ///< Ticks above the window base (HOT)
+            typename Cold::iterator cold;         ///< COLD
+        };
+
+    public:
+        template<bool Const>
+        class Iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = TieredPriceIndex::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+            Iterator() = default;
+            Iterator(const TieredPriceIndex* index, Position position) : index_(index), position_(position) {}
+
+            // Mutable to const conversion
+            template<bool C = Const, typename = std::enable_if_t<C>>
+            Iterator(const Iterator<false>& other) : index_(other.index_), position_(other.position_) {}
+
+            reference operator*() const { return *operator->(); }
+            pointer operator->() const {
+                return position_.tier == Tier::HOT ? index_->hotSlot(position_.offset) : &*position_.cold;
+            }
+
+            Iterator& operator++() { index_->advance(position_); return *this; }
+            Iterator& operator--() { index_->retreat(position_); return *this; }
+            Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+            Iterator operator--(int) { Iterator old = *this; --*this; return old; }
+
+            bool operator==(const Iterator& other) const {
+                if (position_.tier != other.position_.tier) return false;
+                if (position_.tier == Tier::HOT) return position_.offset == other.position_.offset;
+                return position_.tier == Tier::END || position_.cold == other.position_.cold;
+            }
+            bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+        private:
+            friend class TieredPriceIndex;
+            friend class Iterator<!Const>;
+            const TieredPriceIndex* index_ = nullptr;
+            Position position_;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        /**
+         * @brief Constructor
+         * @param touch Which end is the best price
+         * @param alloc Allocator for both tiers and their values
+         * @param window Ticks in the dense tier, rounded up to a power of two (at least 64)
+         */
+        explicit TieredPriceIndex(Touch touch, const allocator_type& alloc = {}, uint32_t window = kDefaultWindow)
+            : alloc_(alloc)
+            , touch_(touch)
+            , window_(roundWindow(window))
+            , mask_(window_ - 1)
+            , slots_(alloc_.allocate(window_))
+            , occupied_(window_ / 64, 0, alloc_.resource())
+            , cold_(alloc_)
+        {
+        }
+
+        ~TieredPriceIndex() {
+            clear();
+            alloc_.deallocate(slots_, window_);
+        }
+
+        TieredPriceIndex(const TieredPriceIndex&) = delete;
+        TieredPriceIndex& operator=(const TieredPriceIndex&) = delete;
+
+        iterator begin() { return iterator(this, first()); }
+        iterator end() { return iterator(this, Position{}); }
+        const_iterator begin() const { return const_iterator(this, first()); }
+        const_iterator end() const { return const_iterator(this, Position{}); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        bool empty() const { return size() == 0; }
+        size_type size() const { return hot_count_ + cold_.size(); }
+
+        iterator find(uint64_t key) {
+            if (inWindow(key)) {
+                hot_operations_++;
+                return isOccupied(key) ? iterator(this, hotPosition(key)) : end();
+            }
+            cold_operations_++;
+            auto it = cold_.find(key);
+            return it != cold_.end() ? iterator(this, coldPosition(it)) : end();
+        }
+
+        const_iterator find(uint64_t key) const {
+            return const_cast<TieredPriceIndex*>(this)->find(key);
+        }
+
+        /**
+         * @brief Insert (key, V(args...)) unless key is present
+         * @return Iterator to the entry for key, and whether it was inserted
+         */
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(uint64_t key, Args&&... args) {
+            if (empty()) {
+                hot_lo_ = windowFor(key);
+            } else if (touch_ == Touch::HIGH ? key >= hot_lo_ + window_ : key < hot_lo_) {
+                // A new best outside the window
+                recenter(windowFor(key));
+            }
+
+            if (!inWindow(key)) {
+                cold_operations_++;
+                auto [it, created] = cold_.try_emplace(key, std::forward<Args>(args)...);
+                return {iterator(this, coldPosition(it)), created};
+            }
+
+            hot_operations_++;
+            if (isOccupied(key)) {
+                return {iterator(this, hotPosition(key)), false};
+            }
+            alloc_.construct(&slots_[key & mask_], std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+            occupied_[(key & mask_) >> 6] |= uint64_t(1) << (key & 63);
+            hot_count_++;
+            return {iterator(this, hotPosition(key)), true};
+        }
+
+        /**
+         * @brief Remove the entry at pos
+         * @return Iterator to the following entry
+         */
+        iterator erase(const_iterator pos) {
+            const_iterator next = std::next(pos);
+            bool has_next = next != end();
+            uint64_t next_key = has_next ? next->first : 0;
+
+            if (pos.position_.tier == Tier::COLD) {
+                cold_operations_++;
+                cold_.erase(pos.position_.cold);
+            } else {
+                hot_operations_++;
+                uint64_t key = pos->first;
+                removeHot(key);
+
+                // Only losing the best level can move the window
+                bool was_best = touch_ == Touch::HIGH ? !has_next : key < bestHotKey();
+                if (was_best) followBest();
+            }
+
+            if (!has_next) return end();
+            if (inWindow(next_key)) return iterator(this, hotPosition(next_key));
+            return iterator(this, coldPosition(cold_.find(next_key)));
+        }
+
+        void clear() {
+            for (size_t word = 0; word < occupied_.size(); ++word) {
+                for (uint64_t bits = occupied_[word]; bits; bits &= bits - 1) {
+                    slots_[word * 64 + __builtin_ctzll(bits)].~value_type();
+                }
+                occupied_[word] = 0;
+            }
+            hot_count_ = 0;
+            cold_.clear();
+        }
+
+        /**
+         * @brief Get ticks covered by the dense tier
+         */
+        uint32_t getWindow() const { return window_; }
+
+        /**
+         * @brief Get levels currently in the dense tier
+         */
+        size_t getHotLevels() const { return hot_count_; }
+
+        /**
+         * @brief Get finds, inserts and erases served by the dense tier
+         */
+        uint64_t getHotOperations() const { return hot_operations_; }
+
+        /**
+         * @brief Get finds, inserts and erases that went to the tree
+         */
+        uint64_t getColdOperations() const { return cold_operations_; }
+
+        /**
+         * @brief Get levels moved between tiers
+         */
+        uint64_t getMigrations() const { return migrations_; }
+
+    private:
+        allocator_type alloc_;
+        Touch touch_;
+        uint32_t window_;
+        uint64_t mask_;
+        value_type* slots_;                       ///< Indexed by price & mask_
+        std::pmr::vector<uint64_t> occupied_;     ///< One bit per slot
+        uint64_t hot_lo_ = 0;                     ///< Lowest price in the window
+        size_t hot_count_ = 0;
+        Cold cold_;
+
+        mutable uint64_t hot_operations_ = 0;
+        mutable uint64_t cold_operations_ = 0;
+        uint64_t migrations_ = 0;
+
+        static uint32_t roundWindow(uint32_t window) {
+            uint32_t rounded = 64;
+            while (rounded < window) rounded <<= 1;
+            return rounded;
+        }
+
+        bool inWindow(uint64_t key) const { return key - hot_lo_ < window_ && key >= hot_lo_; }
+        bool isOccupied(uint64_t key) const { return (occupied_[(key & mask_) >> 6] >> (key & 63)) & 1; }
+        value_type* hotSlot(uint32_t offset) const { return &slots_[(hot_lo_ + offset) & mask_]; }
+
+        Position hotPosition(uint64_t key) const { return Position{Tier::HOT, static_cast<uint32_t>(key - hot_lo_), {}}; }
+        Position coldPosition(typename Cold::iterator it) const { return Position{Tier::COLD, 0, it}; }
+
+        /**
+         * @brief Window base that puts best a quarter window in from the touch side
+         */
+        uint64_t windowFor(uint64_t best) const {
+            uint64_t below = touch_ == Touch::HIGH ? window_ - window_ / 4 - 1 : window_ / 4;
+            return best > below ? best - below : 0;
+        }
+
+        /**
+         * @brief First occupied offset at or after offset, or window_
+         */
+        uint32_t nextHot(uint32_t offset) const {
+            while (offset < window_) {
+                uint64_t slot = (hot_lo_ + offset) & mask_;
+                uint64_t bits = occupied_[slot >> 6] >> (slot & 63);
+                if (bits) {
+                    // Bits past the wrap point map to offsets >= window_
+                    uint32_t found = offset + __builtin_ctzll(bits);
+                    return found < window_ ? found : window_;
+                }
+                offset += 64 - (slot & 63);
+            }
+            return window_;
+        }
+
+        /**
+         * @brief Last occupied offset at or before offset, or -1
+         */
+        int64_t prevHot(int64_t offset) const {
+            while (offset >= 0) {
+                uint64_t slot = (hot_lo_ + offset) & mask_;
+                uint64_t bits = occupied_[slot >> 6] << (63 - (slot & 63));
+                if (bits) {
+                    int64_t found = offset - __builtin_clzll(bits);
+                    return found >= 0 ? found : -1;
+                }
+                offset -= (slot & 63) + 1;
+            }
+            return -1;
+        }
+
+        uint64_t bestHotKey() const {
+            return touch_ == Touch::HIGH ? hot_lo_ + prevHot(window_ - 1) : hot_lo_ + nextHot(0);
+        }
+
+        void removeHot(uint64_t key) {
+            slots_[key & mask_].~value_type();
+            occupied_[(key & mask_) >> 6] &= ~(uint64_t(1) << (key & 63));
+            hot_count_--;
+        }
+
+        /**
+         * @brief Move the window after the best level went away, if it has left or drifted
+         */
+        void followBest() {
+            if (hot_count_ == 0) {
+                if (!cold_.empty()) {
+                    recenter(windowFor(touch_ == Touch::HIGH ? cold_.rbegin()->first : cold_.begin()->first));
+                }
+                return;
+            }
+            uint64_t offset = bestHotKey() - hot_lo_;
+            bool drifted = touch_ == Touch::HIGH ? offset < window_ / 4 : offset >= window_ - window_ / 4;
+            if (drifted) recenter(windowFor(hot_lo_ + offset));
+        }
+
+        /**
+         * @brief Move the window base, migrating levels that change tier
+         */
+        void recenter(uint64_t new_lo) {
+            if (new_lo == hot_lo_) return;
+            uint64_t new_hi = new_lo + window_;
+
+            // Out first: an incoming level may need a departing level's slot
+            for (size_t word = 0; word < occupied_.size() && hot_count_ > 0; ++word) {
+                for (uint64_t bits = occupied_[word]; bits; bits &= bits - 1) {
+                    value_type& entry = slots_[word * 64 + __builtin_ctzll(bits)];
+                    uint64_t key = entry.first;
+                    if (key < new_lo || key >= new_hi) {
+                        cold_.try_emplace(key, std::move(entry.second));
+                        removeHot(key);
+                        migrations_++;
+                    }
+                }
+            }
+
+            hot_lo_ = new_lo;
+            for (auto it = cold_.lower_bound(new_lo); it != cold_.end() && it->first < new_hi;) {
+                uint64_t key = it->first;
+                alloc_.construct(&slots_[key & mask_], std::piecewise_construct, std::forward_as_tuple(key),
+                                 std::forward_as_tuple(std::move(it->second)));
+                occupied_[(key & mask_) >> 6] |= uint64_t(1) << (key & 63);
+                hot_count_++;
+                migrations_++;
+                it = cold_.erase(it);
+            }
+        }
+
+        // Bids keep the tree below the window, asks above it
+        bool coldFirst() const { return touch_ == Touch::HIGH; }
+
+        Position firstHot() const {
+            uint32_t offset = nextHot(0);
+            return offset < window_ ? Position{Tier::HOT, offset, {}} : Position{};
+        }
+
+        Position lastHot() const {
+            int64_t offset = prevHot(window_ - 1);
+            return offset >= 0 ? Position{Tier::HOT, static_cast<uint32_t>(offset), {}} : Position{};
+        }
+
+        Position firstCold() const {
+            auto& cold = const_cast<Cold&>(cold_);
+            return cold.empty() ? Position{} : coldPosition(cold.begin());
+        }
+
+        Position lastCold() const {
+            auto& cold = const_cast<Cold&>(cold_);
+            return cold.empty() ? Position{} : coldPosition(std::prev(cold.end()));
+        }
+
+        Position first() const {
+            Position position = coldFirst() ? firstCold() : firstHot();
+            if (position.tier != Tier::END) return position;
+            return coldFirst() ? firstHot() : firstCold();
+        }
+
+        void advance(Position& position) const {
+            if (position.tier == Tier::HOT) {
+                uint32_t offset = nextHot(position.offset + 1);
+                if (offset < window_) {
+                    position.offset = offset;
+                    return;
+                }
+                position = coldFirst() ? Position{} : firstCold();
+            } else {
+                ++position.cold;
+                if (position.cold == const_cast<Cold&>(cold_).end()) {
+                    position = coldFirst() ? firstHot() : Position{};
+                }
+            }
+        }
+
+        void retreat(Position& position) const {
+            if (position.tier == Tier::END) {
+                position = coldFirst() ? lastHot() : lastCold();
+                if (position.tier == Tier::END) position = coldFirst() ? lastCold() : lastHot();
+            } else if (position.tier == Tier::HOT) {
+                int64_t offset = prevHot(static_cast<int64_t>(position.offset) - 1);
+                if (offset >= 0) {
+                    position.offset = static_cast<uint32_t>(offset);
+                } else {
+                    position = lastCold();
+                }
+            } else if (position.cold == const_cast<Cold&>(cold_).begin()) {
+                position = lastHot();
+            } else {
+                --position.cold;
+            }
+        }
+    };
+
+} // namespace OrderBook
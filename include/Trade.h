@@ -22,6 +22,8 @@ namespace OrderBook {
         uint64_t price;                  ///< Execution price
         uint64_t quantity;               ///< Trade quantity
         std::chrono::high_resolution_clock::time_point timestamp; ///< Execution timestamp
+        uint32_t buy_owner_id = 0;       ///< Owner of the buy order
+        uint32_t sell_owner_id = 0;      ///< Owner of the sell order
         
         /**
          * @brief Constructor
@@ -45,6 +45,197 @@ else
     exit 1
 fi
 
+# Test 5: Differential fuzzing against the reference book
+echo ""
+echo "Test 5: Differential fuzz (200K commands)"
+if timeout 30s ./order_book_simulator --orders 200000 --seed 12345 --fuzz > /dev/null 2>&1; then
+    echo "✅ Engine matches reference book"
+else
+    echo "❌ Engine diverged from reference book (rerun with --seed 12345 --fuzz for the reproducer)"
+    exit 1
+fi
+
+# Test 6: Jitter measurement mode
+echo ""
+echo "Test 6: Jitter measurement mode"
+if timeout 15s ./order_book_simulator --orders 1000 --cores 0 --duration-ms 50 --jitter > /dev/null 2>&1; then
+    echo "✅ Jitter mode works"
+else
+    echo "❌ Jitter mode failed"
+    exit 1
+fi
+
+# Test 7: Bounded-memory soak keeps RSS flat
+echo ""
+echo "Test 7: Bounded-memory soak (500K orders)"
+if timeout 30s ./order_book_simulator --orders 500000 --no-csv --soak 2>&1 | grep -q "(flat)"; then
+    echo "✅ Soak memory stays flat"
+else
+    echo "❌ Soak memory grew or soak failed"
+    exit 1
+fi
+
+# Test 8: Position keeping stays consistent under live matching
+echo ""
+echo "Test 8: Position keeping (200K orders, 4 instruments)"
+if timeout 30s ./order_book_simulator --orders 200000 --threads 4 --seed 7 --no-csv --positions 2>&1 | grep -q "(balanced)"; then
+    echo "✅ Positions net to zero across owners"
+else
+    echo "❌ Position keeping mismatch"
+    exit 1
+fi
+
+# Test 9: ThreadPool priority lanes
+echo ""
+echo "Test 9: ThreadPool lane scheduling"
+if timeout 30s ./order_book_simulator --orders 50000 --lanes 2>&1 | grep -q "Lane scheduling comparison complete"; then
+    echo "✅ Lane scheduling comparison works"
+else
+    echo "❌ Lane scheduling comparison failed"
+    exit 1
+fi
+
+# Test 10: Elastic ThreadPool sizing
+echo ""
+echo "Test 10: Fixed vs elastic ThreadPool"
+if timeout 30s ./order_book_simulator --orders 20000 --pool-bench 2>&1 | grep -q "Elastic: 1-"; then
+    echo "✅ Elastic pool benchmark works"
+else
+    echo "❌ Elastic pool benchmark failed"
+    exit 1
+fi
+
+# Test 11: Parallel primitives agree with serial results
+echo ""
+echo "Test 11: parallelFor / parallelReduce"
+if timeout 30s ./order_book_simulator --orders 20000 --parallel-bench 2>&1 | grep -q "All parallel results match serial"; then
+    echo "✅ Parallel results match serial"
+else
+    echo "❌ Parallel results differ or benchmark failed"
+    exit 1
+fi
+
+# Test 12: Matching alongside concurrent depth readers
+echo ""
+echo "Test 12: Concurrent depth readers"
+if timeout 30s ./order_book_simulator --orders 20000 --reader-bench 2>&1 | grep -q "Reader benchmark complete"; then
+    echo "✅ Reader benchmark completed"
+else
+    echo "❌ Reader benchmark failed"
+    exit 1
+fi
+
+# Test 13: Striped book stays consistent under concurrent passive flow
+echo ""
+echo "Test 13: Striped order book"
+if timeout 30s ./order_book_simulator --orders 50000 --striped-bench 2>&1 | grep -q "Striped book consistent after every run"; then
+    echo "✅ Striped book consistent"
+else
+    echo "❌ Striped book inconsistent or benchmark failed"
+    exit 1
+fi
+
+# Test 14: Warm per-book pool keeps book containers off the global heap
+echo ""
+echo "Test 14: Book memory resources"
+if timeout 30s ./order_book_simulator --orders 50000 --alloc-bench 2>&1 | grep -q "Warm pool made no heap allocations"; then
+    echo "✅ Warm pool made no heap allocations"
+else
+    echo "❌ Pool allocated from the heap or benchmark failed"
+    exit 1
+fi
+
+# Test 15: B+-tree price index agrees with std::map
+echo ""
+echo "Test 15: Price index"
+if timeout 60s ./order_book_simulator --orders 20000 --index-bench 2>&1 | grep -q "B+-tree index matches std::map"; then
+    echo "✅ B+-tree index matches std::map"
+else
+    echo "❌ B+-tree index diverged or benchmark failed"
+    exit 1
+fi
+
+# Test 16: Tiered price index agrees with std::map
+echo ""
+echo "Test 16: Tiered price index"
+if timeout 60s ./order_book_simulator --orders 50000 --tier-window 64 --tier-bench 2>&1 | grep -q "Tiered index matches std::map"; then
+    echo "✅ Tiered index matches std::map"
+else
+    echo "❌ Tiered index diverged or benchmark failed"
+    exit 1
+fi
+
+# Test 17: Lazy cancellation trades exactly like eager cancellation
+echo ""
+echo "Test 17: Lazy cancellation"
+if timeout 60s ./order_book_simulator --orders 20000 --cancel-bench 2>&1 | grep -q "Lazy cancel matches eager cancel" &&
+   timeout 60s ./order_book_simulator --lazy-cancel --orders 50000 --fuzz 2>&1 | grep -q "No divergence found"; then
+    echo "✅ Lazy cancel matches eager cancel"
+else
+    echo "❌ Lazy cancellation diverged"
+    exit 1
+fi
+
+# Test 18: Hot standby stays identical to the primary and takes over
+echo ""
+echo "Test 18: Hot standby failover"
+if timeout 60s ./order_book_simulator --orders 50000 --standby 2>&1 | grep -q "Standby book verified identical"; then
+    echo "✅ Standby verified identical after failover"
+else
+    echo "❌ Standby diverged or failover failed"
+    exit 1
+fi
+
+# Test 19: Sharded engines trade exactly like one process
+echo ""
+echo "Test 19: Sharded engines"
+if timeout 60s ./order_book_simulator --orders 50000 --instruments 8 --shards 3 2>&1 | grep -q "Sharded run matches single-process run"; then
+    echo "✅ Sharded run matches single-process run"
+else
+    echo "❌ Sharded run diverged or failed"
+    exit 1
+fi
+
+# Test 20: Book size scaling benchmark
+echo ""
+echo "Test 20: Book size scaling"
+if timeout 60s ./order_book_simulator --scale-max 100000 --scaling-bench 2>&1 | grep -qE "^ +100000 "; then
+    echo "✅ Scaling benchmark completed"
+else
+    echo "❌ Scaling benchmark failed"
+    exit 1
+fi
+
+# Test 21: Journal and trade log encoding round-trips
+echo ""
+echo "Test 21: Journal encoding"
+if timeout 60s ./order_book_simulator --orders 50000 --codec-bench 2>&1 | grep -q "Codec round trip verified"; then
+    echo "✅ Journal encoding round trip verified"
+else
+    echo "❌ Journal encoding round trip failed"
+    exit 1
+fi
+
+# Test 22: Archive lookups touch only indexed blocks and find every record
+echo ""
+echo "Test 22: Event archive"
+if timeout 60s ./order_book_simulator --orders 200000 --archive-bench 2>&1 | grep -q "Archive lookups verified"; then
+    echo "✅ Archive lookups verified"
+else
+    echo "❌ Archive lookups failed"
+    exit 1
+fi
+
+# Test 23: Memory accounting follows adds, cancels, trades and queued tasks
+echo ""
+echo "Test 23: Memory accounting"
+if timeout 60s ./order_book_simulator --orders 20000 --memory-check 2>&1 | grep -q "Memory accounting verified"; then
+    echo "✅ Memory accounting verified"
+else
+    echo "❌ Memory accounting wrong or check failed"
+    exit 1
+fi
+
 echo ""
 echo "🎉 All tests passed!"
 echo "The order book simulator is working correctly."
@@ -0,0 +1,173 @@
+/**
+ * @file EpochManager.cpp
+ * @brief Epoch-based reclamation implementation
+ */
+
+#include "EpochManager.h"
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+namespace OrderBook {
+
+    namespace {
+        std::atomic<uint64_t> next_manager_id{1};
+
+        /**
+         * @brief Ids of managers not yet destroyed, so exiting threads skip dead ones
+         *
+         * Thread exit releases its slots under the mutex and the destructor
+         * unregisters under it, so a manager cannot go away mid-release.
+         */
+        std::mutex& liveManagersMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_set<uint64_t>& liveManagers() {
+            static std::unordered_set<uint64_t> ids;
+            return ids;
+        }
+
+        struct ClaimedSlot {
+            uint64_t manager_id;
+            void* slot;
+            void (*release)(void*);
+        };
+
+        /**
+         * @brief Slots this thread has claimed; released when the thread exits
+         *
+         * Ids are never reused, so entries for destroyed managers are never matched.
+         */
+        struct ThreadSlots {
+            std::vector<ClaimedSlot> claimed;
+
+            ~ThreadSlots() {
+                std::lock_guard<std::mutex> lock(liveManagersMutex());
+                for (const auto& entry : claimed) {
+                    if (liveManagers().count(entry.manager_id)) entry.release(entry.slot);
+                }
+            }
+        };
+
+        thread_local ThreadSlots thread_slots;
+    }
+
+    EpochManager::EpochManager()
+        : id_(next_manager_id.fetch_add(1))
+        , global_epoch_(1)
+        , retired_count_(0)
+        , reclaimed_count_(0)
+    {
+        std::lock_guard<std::mutex> lock(liveManagersMutex());
+        liveManagers().insert(id_);
+    }
+
+    EpochManager::~EpochManager() {
+        {
+            std::lock_guard<std::mutex> lock(liveManagersMutex());
+            liveManagers().erase(id_);
+        }
+        for (auto& slot : slots_) {
+            for (auto& retired : slot.limbo) {
+                if (retired.object) retired.deleter(retired.object);
+            }
+        }
+    }
+
+    EpochManager::Slot& EpochManager::localSlot() {
+        auto& claimed = thread_slots.claimed;
+        for (const auto& entry : claimed) {
+            if (entry.manager_id == id_) return *static_cast<Slot*>(entry.slot);
+        }
+
+        for (auto& slot : slots_) {
+            bool expected = false;
+            if (!slot.claimed.load(std::memory_order_relaxed) &&
+                slot.claimed.compare_exchange_strong(expected, true)) {
+                // Pending retirements stay with the slot for its next owner
+                claimed.push_back({id_, &slot, [](void* p) {
+                    Slot& released = *static_cast<Slot*>(p);
+                    released.nesting = 0;
+                    released.state.store(0);
+                    released.claimed.store(false, std::memory_order_release);
+                }});
+                return slot;
+            }
+        }
+        throw std::runtime_error("EpochManager: no free thread slots");
+    }
+
+    void EpochManager::enter() {
+        Slot& slot = localSlot();
+        if (slot.nesting++ > 0) return;
+
+        // Sequentially consistent: the announcement must be visible before any protected load
+        uint64_t epoch = global_epoch_.load();
+        slot.state.store((epoch << 1) | 1);
+    }
+
+    void EpochManager::exit() {
+        Slot& slot = localSlot();
+        if (--slot.nesting > 0) return;
+        slot.state.store(slot.state.load(std::memory_order_relaxed) & ~uint64_t(1), std::memory_order_release);
+    }
+
+    void EpochManager::retire(void* object, void (*deleter)(void*)) {
+        if (!object) return;
+        push(Retired{0, object, deleter, nullptr});
+    }
+
+    void EpochManager::retire(std::shared_ptr<void> object) {
+        if (!object) return;
+        push(Retired{0, nullptr, nullptr, std::move(object)});
+    }
+
+    void EpochManager::push(Retired retired) {
+        Slot& slot = localSlot();
+        retired.epoch = global_epoch_.load();
+        slot.limbo.push_back(std::move(retired));
+        retired_count_.fetch_add(1, std::memory_order_relaxed);
+        slot.since_drain++;
+    }
+
+    size_t EpochManager::reclaim() {
+        Slot& slot = localSlot();
+        slot.since_drain = 0;
+        tryAdvance();
+        return drain(slot);
+    }
+
+    size_t EpochManager::reclaimIfDue() {
+        if (localSlot().since_drain < kRetireBatch) return 0;
+        return reclaim();
+    }
+
+    bool EpochManager::tryAdvance() {
+        uint64_t epoch = global_epoch_.load();
+        for (const auto& slot : slots_) {
+            uint64_t state = slot.state.load();
+            if ((state & 1) && (state >> 1) != epoch) {
+                return false;   // A reader is still in an older epoch
+            }
+        }
+        return global_epoch_.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    size_t EpochManager::drain(Slot& slot) {
+        // Two advances past retirement: every reader active at the time has exited
+        uint64_t safe_before = global_epoch_.load() - 1;
+        auto end = std::find_if(slot.limbo.begin(), slot.limbo.end(),
+                                [safe_before](const Retired& r) { return r.epoch >= safe_before; });
+        size_t freed = static_cast<size_t>(end - slot.limbo.begin());
+        for (auto it = slot.limbo.begin(); it != end; ++it) {
+            if (it->object) it->deleter(it->object);
+        }
+        slot.limbo.erase(slot.limbo.begin(), end);
+        reclaimed_count_.fetch_add(freed, std::memory_order_relaxed);
+        return freed;
+    }
+
+} // namespace OrderBook
@@ -0,0 +1,391 @@
+/**
+ * @file EventArchive.cpp
+ * @brief Archive segment writing, indexing and lookup
+ */
+
+#include "EventArchive.h"
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace OrderBook {
+
+    namespace {
+
+        /**
+         * @brief Segment number of "<prefix>-NNNNNN.<ext>", or -1
+         */
+        long segmentNumber(const std::string& name, const std::string& prefix, const std::string& ext) {
+            if (name.size() != prefix.size() + 1 + 6 + ext.size() ||
+                name.compare(0, prefix.size(), prefix) != 0 || name[prefix.size()] != '-' ||
+                name.compare(name.size() - ext.size(), ext.size(), ext) != 0) {
+                return -1;
+            }
+            long number = 0;
+            for (size_t i = prefix.size() + 1; i < prefix.size() + 7; ++i) {
+                if (name[i] < '0' || name[i] > '9') return -1;
+                number = number * 10 + (name[i] - '0');
+            }
+            return number;
+        }
+
+        /**
+         * @brief Read-only file for positioned reads, without stream buffering
+         */
+        class ReadFile {
+        public:
+            explicit ReadFile(std::string path) : path_(std::move(path)), fd_(::open(path_.c_str(), O_RDONLY)) {
+                if (fd_ < 0) throw std::runtime_error("EventArchive: cannot open " + path_);
+            }
+            ~ReadFile() { ::close(fd_); }
+
+            ReadFile(const ReadFile&) = delete;
+            ReadFile& operator=(const ReadFile&) = delete;
+
+            void read(uint64_t offset, void* out, size_t bytes) const {
+                char* cursor = static_cast<char*>(out);
+                while (bytes > 0) {
+                    ssize_t n = ::pread(fd_, cursor, bytes, static_cast<off_t>(offset));
+                    if (n <= 0) throw std::runtime_error("EventArchive: truncated " + path_);
+                    cursor += n;
+                    offset += static_cast<uint64_t>(n);
+                    bytes -= static_cast<size_t>(n);
+                }
+            }
+
+        private:
+            std::string path_;
+            int fd_;
+        };
+
+        std::vector<EventArchiveReader::Segment> loadSegments(const std::string& directory,
+                                                              const std::string& prefix, uint8_t kind) {
+            std::vector<std::pair<long, std::string>> found;
+            for (const auto& entry : fs::directory_iterator(directory)) {
+                std::string name = entry.path().filename().string();
+                long number = segmentNumber(name, prefix, ".idx");
+                if (number >= 0) found.emplace_back(number, entry.path().string());
+            }
+            std::sort(found.begin(), found.end());
+
+            std::vector<EventArchiveReader::Segment> segments;
+            segments.reserve(found.size());
+            for (const auto& [number, idx_path] : found) {
+                EventArchiveReader::Segment segment;
+                segment.path = idx_path.substr(0, idx_path.size() - 4);
+                ReadFile(idx_path).read(0, &segment.summary, sizeof(SegmentSummary));
+                if (segment.summary.magic != SegmentSummary::kMagic || segment.summary.kind != kind) {
+                    throw std::runtime_error("EventArchive: bad index " + idx_path);
+                }
+                segments.push_back(std::move(segment));
+            }
+            return segments;
+        }
+
+        /**
+         * @brief Decode the records of matching blocks in matching segments
+         *
+         * With a bloom key, segments and blocks that pass the range checks
+         * are still skipped unless their bloom filters may contain the key.
+         */
+        template<typename Codec, typename SegmentMatch, typename BlockMatch, typename RecordMatch>
+        std::vector<typename Codec::Record> scan(const std::vector<EventArchiveReader::Segment>& segments,
+                                                 const uint64_t* bloom_key, SegmentMatch segment_match,
+                                                 BlockMatch block_match, RecordMatch record_match,
+                                                 ArchiveQueryStats* stats) {
+            ArchiveQueryStats local;
+            local.segments_total = segments.size();
+            std::vector<typename Codec::Record> results;
+            std::vector<ArchiveBlockEntry> entries;
+            std::vector<uint8_t> buffer;
+
+            for (const auto& segment : segments) {
+                const SegmentSummary& summary = segment.summary;
+                if (summary.records == 0 || !segment_match(summary)) continue;
+
+                ReadFile idx(segment.path + ".idx");
+                local.segments_probed++;
+
+                size_t blooms_offset = sizeof(SegmentSummary) + summary.blocks * sizeof(ArchiveBlockEntry);
+                size_t block_bloom_bytes = summary.block_bloom_words * sizeof(uint64_t);
+                // Filters are probed in place: only the words the key hashes to are read
+                auto probe = [&](size_t offset, size_t word_count) {
+                    return BloomFilter::mayContain(*bloom_key, word_count, summary.bloom_hashes, [&](size_t i) {
+                        uint64_t word;
+                        idx.read(offset + i * sizeof(uint64_t), &word, sizeof(word));
+                        local.bytes_read += sizeof(word);
+                        return word;
+                    });
+                };
+                if (bloom_key && !probe(blooms_offset + summary.blocks * block_bloom_bytes, summary.bloom_words)) {
+                    continue;
+                }
+
+                entries.resize(summary.blocks);
+                idx.read(sizeof(SegmentSummary), entries.data(), entries.size() * sizeof(ArchiveBlockEntry));
+                local.bytes_read += sizeof(SegmentSummary) + entries.size() * sizeof(ArchiveBlockEntry);
+
+                std::unique_ptr<ReadFile> data;
+                for (size_t b = 0; b < entries.size(); ++b) {
+                    const ArchiveBlockEntry& entry = entries[b];
+                    if (!block_match(entry)) continue;
+                    if (bloom_key && !probe(blooms_offset + b * block_bloom_bytes, summary.block_bloom_words)) continue;
+                    if (!data) {
+                        data = std::make_unique<ReadFile>(segment.path + ".seg");
+                        local.segments_read++;
+                    }
+                    buffer.resize(entry.bytes);
+                    data->read(entry.offset, buffer.data(), buffer.size());
+                    local.bytes_read += buffer.size();
+                    local.blocks_decoded++;
+
+                    BlockDecoder<Codec> decoder(buffer.data(), buffer.size());
+                    auto record = ArchiveKeys<typename Codec::Record>::empty();
+                    while (decoder.next(record)) {
+                        if (record_match(record)) results.push_back(record);
+                    }
+                }
+            }
+
+            if (stats) *stats += local;
+            return results;
+        }
+
+        template<typename Record>
+        bool involvesOrder(const Record& record, uint64_t order_id) {
+            bool found = false;
+            ArchiveKeys<Record>::forEachOrderId(record, [&](uint64_t id) { found |= id == order_id; });
+            return found;
+        }
+
+        template<typename Codec>
+        std::vector<typename Codec::Record> lookupOrder(const std::vector<EventArchiveReader::Segment>& segments,
+                                                        uint64_t order_id, ArchiveQueryStats* stats) {
+            return scan<Codec>(
+                segments, &order_id,
+                [=](const SegmentSummary& s) { return s.min_order_id <= order_id && order_id <= s.max_order_id; },
+                [=](const ArchiveBlockEntry& e) { return e.min_order_id <= order_id && order_id <= e.max_order_id; },
+                [=](const typename Codec::Record& r) { return involvesOrder(r, order_id); },
+                stats);
+        }
+
+        template<typename Codec>
+        std::vector<typename Codec::Record> lookupTime(const std::vector<EventArchiveReader::Segment>& segments,
+                                                       int64_t from, int64_t to, ArchiveQueryStats* stats) {
+            using Keys = ArchiveKeys<typename Codec::Record>;
+            return scan<Codec>(
+                segments, nullptr,
+                [=](const SegmentSummary& s) { return s.min_time <= to && from <= s.max_time; },
+                [=](const ArchiveBlockEntry& e) { return e.min_time <= to && from <= e.max_time; },
+                [=](const typename Codec::Record& r) {
+                    int64_t time = Keys::time(r);
+                    return from <= time && time <= to;
+                },
+                stats);
+        }
+
+    } // namespace
+
+    ArchiveQueryStats& ArchiveQueryStats::operator+=(const ArchiveQueryStats& other) {
+        segments_total += other.segments_total;
+        segments_probed += other.segments_probed;
+        segments_read += other.segments_read;
+        blocks_decoded += other.blocks_decoded;
+        bytes_read += other.bytes_read;
+        return *this;
+    }
+
+    std::string ArchiveQueryStats::toString() const {
+        std::ostringstream oss;
+        oss << segments_read << "/" << segments_total << " segments read ("
+            << segments_probed << " probed), " << blocks_decoded << " blocks, "
+            << bytes_read / 1024 << " KB";
+        return oss.str();
+    }
+
+    BloomFilter::BloomFilter(size_t keys, uint32_t bits_per_key) {
+        words_.assign(std::max<size_t>(1, (keys * bits_per_key + 63) / 64), 0);
+        hashes_ = std::max<uint32_t>(1, std::min<uint32_t>(16, bits_per_key * 69 / 100));
+    }
+
+    void BloomFilter::add(uint64_t key) {
+        uint64_t h = hash(key);
+        uint64_t step = hash(h) | 1;
+        for (uint32_t i = 0; i < hashes_; ++i, h += step) {
+            uint64_t bit = bitFor(h, words_.size());
+            words_[bit >> 6] |= uint64_t(1) << (bit & 63);
+        }
+    }
+
+    bool BloomFilter::mayContain(uint64_t key) const {
+        return mayContain(key, words_.size(), hashes_, [this](size_t i) { return words_[i]; });
+    }
+
+    template<typename Codec>
+    SegmentWriter<Codec>::SegmentWriter(const ArchiveConfig& config, const std::string& prefix)
+        : directory_(config.directory)
+        , prefix_(prefix)
+        , segment_records_(config.segment_records ? config.segment_records : ArchiveConfig().segment_records)
+        , block_records_(config.block_records ? config.block_records : ArchiveConfig().block_records)
+        , bloom_bits_per_key_(config.bloom_bits_per_key ? config.bloom_bits_per_key : ArchiveConfig().bloom_bits_per_key)
+        , encoder_(block_records_)
+    {
+        std::error_code error;
+        fs::create_directories(directory_, error);
+        if (error || !fs::is_directory(directory_)) {
+            throw std::runtime_error("EventArchive: cannot create " + directory_);
+        }
+        // Continue after existing segments, sealed or not
+        for (const auto& entry : fs::directory_iterator(directory_)) {
+            long number = segmentNumber(entry.path().filename().string(), prefix_, ".seg");
+            if (number >= 0) next_segment_ = std::max<uint32_t>(next_segment_, static_cast<uint32_t>(number) + 1);
+        }
+    }
+
+    template<typename Codec>
+    SegmentWriter<Codec>::~SegmentWriter() {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; an unsealed segment is ignored by readers
+        }
+    }
+
+    template<typename Codec>
+    void SegmentWriter<Codec>::close() {
+        if (data_.is_open()) sealSegment();
+    }
+
+    template<typename Codec>
+    void SegmentWriter<Codec>::openSegment() {
+        char name[32];
+        std::snprintf(name, sizeof(name), "-%06u", next_segment_++);
+        segment_path_ = (fs::path(directory_) / (prefix_ + name)).string();
+        data_.open(segment_path_ + ".seg", std::ios::binary | std::ios::trunc);
+        if (!data_) throw std::runtime_error("EventArchive: cannot write " + segment_path_ + ".seg");
+        records_in_segment_ = 0;
+        block_.offset = 0;
+        block_.records = 0;
+        entries_.clear();
+        block_blooms_.clear();
+        segment_ids_.clear();
+    }
+
+    template<typename Codec>
+    void SegmentWriter<Codec>::writeBlock() {
+        encoder_.flush();
+        std::vector<uint8_t> bytes = encoder_.takeBlocks();
+        data_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        block_.bytes = static_cast<uint32_t>(bytes.size());
+        entries_.push_back(block_);
+        
+        // Fixed size per block so a reader can seek straight to any block's filter
+        BloomFilter bloom(block_records_ * Keys::kOrderIds, bloom_bits_per_key_);
+        for (uint64_t id : block_ids_) bloom.add(id);
+        block_blooms_.insert(block_blooms_.end(), bloom.words().begin(), bloom.words().end());
+        segment_ids_.insert(segment_ids_.end(), block_ids_.begin(), block_ids_.end());
+        block_ids_.clear();
+        
+        records_in_segment_ += block_.records;
+        block_.offset += bytes.size();
+        block_.records = 0;
+    }
+
+    template<typename Codec>
+    void SegmentWriter<Codec>::sealSegment() {
+        if (block_.records > 0) writeBlock();
+        data_.close();
+        if (!data_) throw std::runtime_error("EventArchive: write failed for " + segment_path_ + ".seg");
+
+        std::sort(segment_ids_.begin(), segment_ids_.end());
+        segment_ids_.erase(std::unique(segment_ids_.begin(), segment_ids_.end()), segment_ids_.end());
+        BloomFilter bloom(segment_ids_.size(), bloom_bits_per_key_);
+        for (uint64_t id : segment_ids_) bloom.add(id);
+
+        SegmentSummary summary;
+        summary.kind = Codec::kKind;
+        summary.bloom_hashes = static_cast<uint8_t>(bloom.hashes());
+        summary.blocks = static_cast<uint32_t>(entries_.size());
+        summary.bloom_words = static_cast<uint32_t>(bloom.words().size());
+        summary.block_bloom_words = entries_.empty() ? 0 : static_cast<uint32_t>(block_blooms_.size() / entries_.size());
+        summary.records = records_in_segment_;
+        summary.data_bytes = block_.offset;
+        if (!entries_.empty()) {
+            summary.min_time = entries_.front().min_time;
+            summary.max_time = entries_.front().max_time;
+            summary.min_order_id = UINT64_MAX;
+            for (const auto& entry : entries_) {
+                summary.min_time = std::min(summary.min_time, entry.min_time);
+                summary.max_time = std::max(summary.max_time, entry.max_time);
+                summary.min_order_id = std::min(summary.min_order_id, entry.min_order_id);
+                summary.max_order_id = std::max(summary.max_order_id, entry.max_order_id);
+            }
+        }
+
+        std::string tmp_path = segment_path_ + ".idx.tmp";
+        {
+            std::ofstream idx(tmp_path, std::ios::binary | std::ios::trunc);
+            idx.write(reinterpret_cast<const char*>(&summary), sizeof(summary));
+            idx.write(reinterpret_cast<const char*>(entries_.data()),
+                      static_cast<std::streamsize>(entries_.size() * sizeof(ArchiveBlockEntry)));
+            idx.write(reinterpret_cast<const char*>(block_blooms_.data()),
+                      static_cast<std::streamsize>(block_blooms_.size() * sizeof(uint64_t)));
+            idx.write(reinterpret_cast<const char*>(bloom.words().data()),
+                      static_cast<std::streamsize>(bloom.words().size() * sizeof(uint64_t)));
+            if (!idx) throw std::runtime_error("EventArchive: cannot write " + tmp_path);
+        }
+        std::error_code error;
+        fs::rename(tmp_path, segment_path_ + ".idx", error);
+        if (error) throw std::runtime_error("EventArchive: cannot seal " + segment_path_);
+
+        segments_written_++;
+        entries_.clear();
+        block_blooms_.clear();
+        segment_ids_.clear();
+    }
+
+    template class SegmentWriter<JournalCodec>;
+    template class SegmentWriter<TradeCodec>;
+
+    EventArchiveWriter::EventArchiveWriter(const ArchiveConfig& config)
+        : events_(config, "events")
+        , trades_(config, "trades")
+    {
+    }
+
+    void EventArchiveWriter::close() {
+        events_.close();
+        trades_.close();
+    }
+
+    EventArchiveReader::EventArchiveReader(const std::string& directory) {
+        if (!fs::is_directory(directory)) {
+            throw std::runtime_error("EventArchive: no archive at " + directory);
+        }
+        event_segments_ = loadSegments(directory, "events", JournalCodec::kKind);
+        trade_segments_ = loadSegments(directory, "trades", TradeCodec::kKind);
+    }
+
+    std::vector<JournalRecord> EventArchiveReader::eventsForOrder(uint64_t order_id, ArchiveQueryStats* stats) const {
+        return lookupOrder<JournalCodec>(event_segments_, order_id, stats);
+    }
+
+    std::vector<Trade> EventArchiveReader::tradesForOrder(uint64_t order_id, ArchiveQueryStats* stats) const {
+        return lookupOrder<TradeCodec>(trade_segments_, order_id, stats);
+    }
+
+    std::vector<JournalRecord> EventArchiveReader::eventsBetween(int64_t from, int64_t to, ArchiveQueryStats* stats) const {
+        return lookupTime<JournalCodec>(event_segments_, from, to, stats);
+    }
+
+    std::vector<Trade> EventArchiveReader::tradesBetween(int64_t from, int64_t to, ArchiveQueryStats* stats) const {
+        return lookupTime<TradeCodec>(trade_segments_, from, to, stats);
+    }
+
+} // namespace OrderBook
@@ -0,0 +1,413 @@
+/**
+ * @file FuzzHarness.cpp
+ * @brief Differential fuzzing harness implementation
+ */
+
+#include "FuzzHarness.h"
+#include "MatchingEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+
+namespace OrderBook {
+
+    std::string FuzzCommand::toString() const {
+        static const char* names[] = {"ADD", "CANCEL", "AMEND", "SWEEP"};
+        std::ostringstream oss;
+        oss << names[static_cast<int>(type)]
+            << " " << (side == OrderSide::BUY ? "BUY" : "SELL")
+            << " id=" << order_id
+            << " px=" << price
+            << " qty=" << quantity;
+        return oss.str();
+    }
+
+    // ---------------------------------------------------------------------
+    // ReferenceBook
+    // ---------------------------------------------------------------------
+
+    void ReferenceBook::submit(Order::OrderID id, OrderSide side, uint64_t price, uint64_t quantity,
+                               uint64_t timestamp, std::vector<Fill>& fills) {
+        uint64_t remaining = quantity;
+
+        while (remaining > 0) {
+            // Best opposing order: best price, then earliest arrival
+            auto best = resting_.end();
+            for (auto it = resting_.begin(); it != resting_.end(); ++it) {
+                if (it->side == side) continue;
+                if (best == resting_.end()) {
+                    best = it;
+                    continue;
+                }
+                bool better_price = (side == OrderSide::BUY) ? it->price < best->price
+                                                             : it->price > best->price;
+                if (better_price || (it->price == best->price && it->sequence < best->sequence)) {
+                    best = it;
+                }
+            }
+
+            if (best == resting_.end()) break;
+
+            bool crosses = (side == OrderSide::BUY) ? price >= best->price : price <= best->price;
+            if (!crosses) break;
+
+            uint64_t qty = std::min(remaining, best->remaining);
+            if (side == OrderSide::BUY) {
+                fills.push_back({id, best->id, best->price, qty});
+            } else {
+                fills.push_back({best->id, id, best->price, qty});
+            }
+
+            remaining -= qty;
+            best->remaining -= qty;
+            reduceLevel(best->side, best->price, qty);
+
+            if (best->remaining == 0) {
+                resting_.erase(best);
+            }
+        }
+
+        if (remaining > 0) {
+            resting_.push_back({id, side, price, remaining, next_sequence_++, timestamp});
+            levels(side)[price] += remaining;
+        }
+    }
+
+    bool ReferenceBook::cancel(Order::OrderID id) {
+        auto it = std::find_if(resting_.begin(), resting_.end(),
+                               [id](const Resting& r) { return r.id == id; });
+        if (it == resting_.end()) return false;
+
+        reduceLevel(it->side, it->price, it->remaining);
+        resting_.erase(it);
+        return true;
+    }
+
+    bool ReferenceBook::amend(Order::OrderID id, uint64_t new_price, uint64_t new_quantity,
+                              uint64_t timestamp, std::vector<Fill>& fills) {
+        auto it = std::find_if(resting_.begin(), resting_.end(),
+                               [id](const Resting& r) { return r.id == id; });
+        if (it == resting_.end()) return false;
+
+        if (new_quantity == 0) {
+            return cancel(id);
+        }
+
+        if (new_price == it->price && new_quantity <= it->remaining) {
+            reduceLevel(it->side, it->price, it->remaining - new_quantity);
+            it->remaining = new_quantity;
+            return true;
+        }
+
+        OrderSide side = it->side;
+        cancel(id);
+        submit(id, side, new_price, new_quantity, timestamp, fills);
+        return true;
+    }
+
+    uint64_t ReferenceBook::checksum() const {
+        uint64_t hash = 0;
+        for (const auto& r : resting_) {
+            hash += BookChecksum::digest(r.id, r.side, r.price, r.remaining, r.timestamp);
+        }
+        return hash;
+    }
+
+    ReferenceBook::DepthSide ReferenceBook::depth(OrderSide side, size_t levels) const {
+        DepthSide result;
+        if (side == OrderSide::BUY) {
+            for (auto it = bid_levels_.rbegin(); it != bid_levels_.rend() && result.size() < levels; ++it) {
+                result.emplace_back(it->first, it->second);
+            }
+        } else {
+            for (auto it = ask_levels_.begin(); it != ask_levels_.end() && result.size() < levels; ++it) {
+                result.emplace_back(it->first, it->second);
+            }
+        }
+        return result;
+    }
+
+    void ReferenceBook::reduceLevel(OrderSide side, uint64_t price, uint64_t qty) {
+        auto& side_levels = levels(side);
+        auto it = side_levels.find(price);
+        if (it == side_levels.end()) return;
+
+        it->second -= qty;
+        if (it->second == 0) {
+            side_levels.erase(it);
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // DifferentialFuzzer
+    // ---------------------------------------------------------------------
+
+    DifferentialFuzzer::DifferentialFuzzer(const FuzzConfig& config)
+        : config_(config)
+    {
+    }
+
+    std::vector<FuzzCommand> DifferentialFuzzer::generateEpisode(uint64_t episode) const {
+        std::mt19937_64 rng(config_.seed ^ (episode * 0x9E3779B97F4A7C15ULL));
+        std::uniform_int_distribution<uint64_t> price_dist(config_.base_price - config_.price_range,
+                                                           config_.base_price + config_.price_range);
+        std::uniform_int_distribution<uint64_t> qty_dist(1, config_.max_quantity);
+        std::uniform_int_distribution<int> side_dist(0, 1);
+        std::uniform_int_distribution<int> type_dist(0, 99);
+
+        std::vector<FuzzCommand> commands;
+        commands.reserve(config_.episode_length);
+        Order::OrderID next_id = 1;
+
+        auto pickTarget = [&]() -> Order::OrderID {
+            if (next_id == 1) return 1;
+            // Mostly recent orders, which are more likely to still be resting
+            uint64_t window = std::min<uint64_t>(next_id - 1, 32);
+            std::uniform_int_distribution<uint64_t> dist(next_id - window, next_id - 1);
+            return (type_dist(rng) < 90) ? dist(rng)
+                                         : std::uniform_int_distribution<uint64_t>(1, next_id)(rng);
+        };
+
+        for (size_t i = 0; i < config_.episode_length; ++i) {
+            FuzzCommand cmd{};
+            cmd.side = side_dist(rng) == 0 ? OrderSide::BUY : OrderSide::SELL;
+            int roll = type_dist(rng);
+
+            if (roll < 55) {
+                cmd.type = FuzzCommandType::ADD;
+                cmd.order_id = next_id++;
+                cmd.price = price_dist(rng);
+                cmd.quantity = qty_dist(rng);
+            } else if (roll < 75) {
+                cmd.type = FuzzCommandType::CANCEL;
+                cmd.order_id = pickTarget();
+            } else if (roll < 92) {
+                cmd.type = FuzzCommandType::AMEND;
+                cmd.order_id = pickTarget();
+                // Half the amends are same-price size changes; price 0 means "keep"
+                cmd.price = (type_dist(rng) < 50) ? 0 : price_dist(rng);
+                // An amend to zero is a cancel
+                cmd.quantity = (type_dist(rng) < 5) ? 0 : qty_dist(rng);
+            } else {
+                cmd.type = FuzzCommandType::SWEEP;
+                cmd.order_id = next_id++;
+                cmd.price = (cmd.side == OrderSide::BUY)
+                          ? config_.base_price + config_.price_range + 1
+                          : config_.base_price - config_.price_range - 1;
+                cmd.quantity = config_.max_quantity * (2 + type_dist(rng) % 8);
+            }
+
+            commands.push_back(cmd);
+        }
+
+        return commands;
+    }
+
+    std::string DifferentialFuzzer::replay(const std::vector<FuzzCommand>& commands,
+                                           size_t* failing_step,
+                                           uint64_t* trades_compared) const {
+        MatchingEngine engine("FUZZ");
+        engine.setConsoleLogging(false);
+        engine.setLazyCancel(config_.lazy_cancel);
+
+        std::vector<Trade> engine_trades;
+        engine.setTradeCallback([&engine_trades](const Trade& trade) {
+            engine_trades.push_back(trade);
+        });
+
+        ReferenceBook reference;
+        std::vector<ReferenceBook::Fill> reference_fills;
+
+        for (size_t step = 0; step < commands.size(); ++step) {
+            const FuzzCommand& cmd = commands[step];
+            engine_trades.clear();
+            reference_fills.clear();
+
+            // Synthetic, strictly increasing timestamps keep priority deterministic
+            Order::TimePoint ts(std::chrono::duration_cast<Order::TimePoint::duration>(
+                std::chrono::nanoseconds(step + 1)));
+            uint64_t ticks = static_cast<uint64_t>(ts.time_since_epoch().count());
+
+            bool engine_ok = false;
+            bool reference_ok = false;
+
+            switch (cmd.type) {
+                case FuzzCommandType::ADD:
+                case FuzzCommandType::SWEEP: {
+                    auto order = std::make_shared<Order>(cmd.order_id, cmd.side, cmd.price,
+                                                         cmd.quantity, ts);
+                    order->setOwner(ownerFor(cmd.order_id));
+                    engine_ok = engine.submitOrder(order);
+                    reference.submit(cmd.order_id, cmd.side, cmd.price, cmd.quantity, ticks, reference_fills);
+                    reference_ok = true;
+                    break;
+                }
+                case FuzzCommandType::CANCEL:
+                    engine_ok = engine.cancelOrder(cmd.order_id);
+                    reference_ok = reference.cancel(cmd.order_id);
+                    break;
+                case FuzzCommandType::AMEND: {
+                    uint64_t price = cmd.price;
+                    if (price == 0) {
+                        auto resting = engine.getOrderBook().getOrder(cmd.order_id);
+                        price = resting ? resting->getPrice() : config_.base_price;
+                    }
+                    engine_ok = engine.amendOrder(cmd.order_id, price, cmd.quantity, ts);
+                    reference_ok = reference.amend(cmd.order_id, price, cmd.quantity, ticks, reference_fills);
+                    break;
+                }
+            }
+
+            std::string mismatch;
+            if (engine_ok != reference_ok) {
+                mismatch = std::string("return value engine=") + (engine_ok ? "true" : "false") +
+                           " reference=" + (reference_ok ? "true" : "false");
+            } else {
+                mismatch = compareStep(engine, reference, engine_trades, reference_fills);
+            }
+
+            if (trades_compared) {
+                *trades_compared += reference_fills.size();
+            }
+
+            if (!mismatch.empty()) {
+                if (failing_step) *failing_step = step;
+                return "step " + std::to_string(step) + " (" + cmd.toString() + "): " + mismatch;
+            }
+        }
+
+        return {};
+    }
+
+    std::string DifferentialFuzzer::compareStep(const MatchingEngine& engine,
+                                                const ReferenceBook& reference,
+                                                const std::vector<Trade>& engine_trades,
+                                                const std::vector<ReferenceBook::Fill>& reference_fills) const {
+        std::ostringstream oss;
+
+        if (engine_trades.size() != reference_fills.size()) {
+            oss << "trade count engine=" << engine_trades.size()
+                << " reference=" << reference_fills.size();
+            return oss.str();
+        }
+
+        for (size_t i = 0; i < engine_trades.size(); ++i) {
+            const Trade& t = engine_trades[i];
+            const ReferenceBook::Fill& f = reference_fills[i];
+            if (t.buy_order_id != f.buy_order_id || t.sell_order_id != f.sell_order_id ||
+                t.price != f.price || t.quantity != f.quantity) {
+                oss << "trade " << i << " engine=" << t.toString()
+                    << " reference=Trade{Buy:" << f.buy_order_id << ", Sell:" << f.sell_order_id
+                    << ", Price:" << f.price << ", Qty:" << f.quantity << "}";
+                return oss.str();
+            }
+            if (t.buy_owner_id != ownerFor(f.buy_order_id) || t.sell_owner_id != ownerFor(f.sell_order_id)) {
+                oss << "trade " << i << " owners engine=" << t.buy_owner_id << "/" << t.sell_owner_id
+                    << " reference=" << ownerFor(f.buy_order_id) << "/" << ownerFor(f.sell_order_id);
+                return oss.str();
+            }
+        }
+
+        const auto& book = engine.getOrderBook();
+        auto [engine_bids, engine_asks] = book.getMarketDepth(config_.depth_levels);
+        auto reference_bids = reference.depth(OrderSide::BUY, config_.depth_levels);
+        auto reference_asks = reference.depth(OrderSide::SELL, config_.depth_levels);
+
+        auto describe = [](const ReferenceBook::DepthSide& side) {
+            std::ostringstream d;
+            for (const auto& [price, qty] : side) d << price << "x" << qty << " ";
+            return d.str();
+        };
+
+        if (engine_bids != reference_bids) {
+            oss << "bid depth engine=[" << describe(engine_bids)
+                << "] reference=[" << describe(reference_bids) << "]";
+            return oss.str();
+        }
+        if (engine_asks != reference_asks) {
+            oss << "ask depth engine=[" << describe(engine_asks)
+                << "] reference=[" << describe(reference_asks) << "]";
+            return oss.str();
+        }
+        if (book.getOrderCount() != reference.orderCount()) {
+            oss << "order count engine=" << book.getOrderCount()
+                << " reference=" << reference.orderCount();
+            return oss.str();
+        }
+        if (book.getChecksum().hash != reference.checksum()) {
+            // Same depth and count, so a resting order's quantity or priority differs
+            oss << "state checksum engine=" << book.getChecksum().hash
+                << " reference=" << reference.checksum();
+            return oss.str();
+        }
+
+        return {};
+    }
+
+    std::vector<FuzzCommand> DifferentialFuzzer::shrink(std::vector<FuzzCommand> commands) const {
+        // Delta debugging: drop ever smaller chunks while the failure persists
+        size_t chunk = std::max<size_t>(commands.size() / 2, 1);
+
+        while (chunk >= 1 && commands.size() > 1) {
+            bool removed_any = false;
+
+            for (size_t start = 0; start < commands.size(); ) {
+                std::vector<FuzzCommand> candidate;
+                candidate.reserve(commands.size());
+                candidate.insert(candidate.end(), commands.begin(), commands.begin() + start);
+                size_t end = std::min(start + chunk, commands.size());
+                candidate.insert(candidate.end(), commands.begin() + end, commands.end());
+
+                if (!candidate.empty() && !replay(candidate).empty()) {
+                    commands = std::move(candidate);
+                    removed_any = true;
+                } else {
+                    start += chunk;
+                }
+            }
+
+            if (!removed_any) {
+                if (chunk == 1) break;
+                chunk /= 2;
+            }
+        }
+
+        return commands;
+    }
+
+    FuzzResult DifferentialFuzzer::run() {
+        FuzzResult result;
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint64_t episode = 0; result.commands_run < config_.num_commands; ++episode) {
+            auto commands = generateEpisode(episode);
+            uint64_t left = config_.num_commands - result.commands_run;
+            if (commands.size() > left) {
+                commands.resize(left);
+            }
+
+            size_t failing_step = 0;
+            std::string failure = replay(commands, &failing_step, &result.trades_compared);
+            result.episodes++;
+
+            if (!failure.empty()) {
+                result.commands_run += failing_step + 1;
+                result.passed = false;
+                result.failure = "episode " + std::to_string(episode) + " " + failure;
+                commands.resize(failing_step + 1);
+                result.elapsed_seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+                result.minimized = config_.shrink ? shrink(std::move(commands)) : std::move(commands);
+                return result;
+            }
+
+            result.commands_run += commands.size();
+        }
+
+        result.elapsed_seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+} // namespace OrderBook
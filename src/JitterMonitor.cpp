@@ -0,0 +1,242 @@
+/**
+ * @file JitterMonitor.cpp
+ * @brief OS jitter and platform noise measurement implementation
+ */
+
+#include "JitterMonitor.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define OB_HAVE_RDTSC 1
+#else
+    #define OB_HAVE_RDTSC 0
+#endif
+
+namespace OrderBook {
+
+    uint64_t CoreJitterReport::gapPercentile(double percentile) const {
+        uint64_t total = 0;
+        for (uint64_t count : gap_histogram) total += count;
+        if (total == 0) return 0;
+
+        uint64_t target = static_cast<uint64_t>(percentile * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += gap_histogram[i];
+            if (seen > target) {
+                return i == 0 ? 0 : (1ULL << i) - 1;
+            }
+        }
+        return max_gap_ns;
+    }
+
+    JitterMonitor::JitterMonitor(const JitterConfig& config)
+        : config_(config)
+    {
+        if (config_.cores.empty()) {
+            unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned int i = 0; i < count; ++i) {
+                config_.cores.push_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    std::vector<CoreJitterReport> JitterMonitor::run() {
+        auto isolated = isolatedCores();
+        std::vector<CoreJitterReport> reports(config_.cores.size());
+        std::vector<std::thread> threads;
+        threads.reserve(config_.cores.size());
+
+        for (size_t i = 0; i < config_.cores.size(); ++i) {
+            threads.emplace_back([this, i, &reports, &isolated]() {
+                reports[i] = measureCore(config_.cores[i], isolated);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        return reports;
+    }
+
+    CoreJitterReport JitterMonitor::measureCore(int core, const std::vector<int>& isolated) const {
+        using Clock = std::chrono::steady_clock;
+
+        CoreJitterReport report;
+        report.core = core;
+        report.isolated = std::find(isolated.begin(), isolated.end(), core) != isolated.end();
+        report.pinned = pinCurrentThread(core);
+
+        // Timer overhead: how late does a 1us sleep come back?
+        const int sleeps = 200;
+        uint64_t slack_total = 0;
+        for (int i = 0; i < sleeps; ++i) {
+            auto before = Clock::now();
+            std::this_thread::sleep_for(std::chrono::microseconds(1));
+            auto slept = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - before).count();
+            slack_total += slept > 1000 ? slept - 1000 : 0;
+        }
+        report.timer_slack_ns = static_cast<double>(slack_total) / sleeps;
+
+#if OB_HAVE_RDTSC
+        {
+            const int reads = 1000000;
+            auto before = Clock::now();
+            uint64_t sink = 0;
+            for (int i = 0; i < reads; ++i) sink += __rdtsc();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - before).count();
+            volatile uint64_t keep = sink;
+            (void)keep;
+            report.tsc_read_ns = static_cast<double>(elapsed) / reads;
+        }
+#endif
+
+        // Tight timestamp loop: every gap longer than a clock read is stolen time
+        const uint64_t duration_ns = config_.duration_ms * 1000000ULL;
+        auto start = Clock::now();
+        auto previous = start;
+        uint64_t samples = 0;
+
+        while (true) {
+            auto now = Clock::now();
+            uint64_t gap = std::chrono::duration_cast<std::chrono::nanoseconds>(now - previous).count();
+            previous = now;
+            ++samples;
+
+            size_t bucket = gap == 0 ? 0 : 64 - __builtin_clzll(gap);
+            report.gap_histogram[std::min(bucket, CoreJitterReport::kBuckets - 1)]++;
+
+            if (gap > report.max_gap_ns) report.max_gap_ns = gap;
+            if (gap > config_.gap_threshold_ns) {
+                report.interruptions++;
+                report.interrupted_ns += gap;
+            }
+
+            if (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - start).count()) >= duration_ns) {
+                break;
+            }
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(previous - start).count();
+        report.samples = samples;
+        report.clock_read_ns = samples ? static_cast<double>(elapsed) / samples : 0.0;
+        return report;
+    }
+
+    void JitterMonitor::printReports(const std::vector<CoreJitterReport>& reports) const {
+        const uint64_t duration_ns = config_.duration_ms * 1000000ULL;
+
+        std::cout << "\n=== Platform Jitter (" << config_.duration_ms << " ms per core, gaps > "
+                  << config_.gap_threshold_ns << " ns counted) ===" << std::endl;
+        std::cout << std::left
+                  << std::setw(6) << "Core"
+                  << std::setw(10) << "Isolated"
+                  << std::setw(8) << "Pinned"
+                  << std::right
+                  << std::setw(10) << "clock ns"
+                  << std::setw(9) << "tsc ns"
+                  << std::setw(12) << "sleep slk"
+                  << std::setw(10) << "p50 gap"
+                  << std::setw(10) << "p99.9"
+                  << std::setw(12) << "max gap"
+                  << std::setw(10) << "intr/s"
+                  << std::setw(10) << "noise %" << std::endl;
+
+        for (const auto& r : reports) {
+            double seconds = config_.duration_ms / 1000.0;
+            std::cout << std::left
+                      << std::setw(6) << r.core
+                      << std::setw(10) << (r.isolated ? "yes" : "no")
+                      << std::setw(8) << (r.pinned ? "yes" : "no")
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << r.clock_read_ns
+                      << std::setw(9) << r.tsc_read_ns
+                      << std::setw(12) << std::setprecision(0) << r.timer_slack_ns
+                      << std::setw(10) << r.gapPercentile(0.50)
+                      << std::setw(10) << r.gapPercentile(0.999)
+                      << std::setw(12) << r.max_gap_ns
+                      << std::setw(10) << (r.interruptions / seconds)
+                      << std::setw(10) << std::setprecision(4) << (r.noiseRatio(duration_ns) * 100.0)
+                      << std::endl;
+        }
+
+        // Summarize isolated vs shared cores separately
+        for (bool isolated : {true, false}) {
+            uint64_t count = 0, max_gap = 0, interrupted = 0;
+            for (const auto& r : reports) {
+                if (r.isolated != isolated) continue;
+                count++;
+                max_gap = std::max(max_gap, r.max_gap_ns);
+                interrupted += r.interrupted_ns;
+            }
+            if (count == 0) continue;
+            std::cout << (isolated ? "Isolated" : "Non-isolated") << " cores: " << count
+                      << ", worst gap " << max_gap << " ns, mean noise "
+                      << std::setprecision(4) << (100.0 * interrupted / (count * duration_ns)) << "%"
+                      << std::endl;
+        }
+        std::cout << "=======================================" << std::endl;
+    }
+
+    std::vector<int> JitterMonitor::isolatedCores() {
+        std::ifstream file("/sys/devices/system/cpu/isolated");
+        std::string list;
+        if (!file.is_open() || !std::getline(file, list)) {
+            return {};
+        }
+        return parseCpuList(list);
+    }
+
+    std::vector<int> JitterMonitor::parseCpuList(const std::string& list) {
+        std::vector<int> cores;
+        std::stringstream ss(list);
+        std::string range;
+
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) continue;
+            try {
+                auto dash = range.find('-');
+                if (dash == std::string::npos) {
+                    cores.push_back(std::stoi(range));
+                } else {
+                    int first = std::stoi(range.substr(0, dash));
+                    int last = std::stoi(range.substr(dash + 1));
+                    for (int core = first; core <= last; ++core) {
+                        cores.push_back(core);
+                    }
+                }
+            } catch (const std::exception&) {
+                // Ignore malformed entries
+            }
+        }
+
+        return cores;
+    }
+
+    bool JitterMonitor::pinCurrentThread(int core) {
+#if defined(__linux__)
+        if (core < 0 || core >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)core;
+        return false;
+#endif
+    }
+
+} // namespace OrderBook
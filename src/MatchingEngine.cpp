@@ -4,20 +4,52 @@
  */
 
 #include "MatchingEngine.h"
+#include "EventArchive.h"
+#include "Probes.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <random>
 
 namespace OrderBook {
 
-    MatchingEngine::MatchingEngine(const std::string& symbol)
+    namespace {
+        std::unique_ptr<std::pmr::memory_resource> makeBookMemory(BookMemory memory,
+                                                                  std::pmr::memory_resource* upstream) {
+            switch (memory) {
+                case BookMemory::POOL: {
+                    // Large enough blocks that deep level vectors are recycled too; capped
+                    // chunks grow the pool in small steps instead of doubling past the book's size
+                    std::pmr::pool_options options;
+                    options.largest_required_pool_block = 64 * 1024;
+                    options.max_blocks_per_chunk = 256;
+                    return std::make_unique<std::pmr::unsynchronized_pool_resource>(options, upstream);
+                }
+                case BookMemory::MONOTONIC:
+                    return std::make_unique<std::pmr::monotonic_buffer_resource>(size_t(1) << 20, upstream);
+                case BookMemory::HEAP:
+                default:
+                    return nullptr;
+            }
+        }
+    }
+
+    MatchingEngine::MatchingEngine(const std::string& symbol, BookMemory memory,
+                                   std::pmr::memory_resource* upstream)
         : symbol_(symbol)
-        , order_book_(symbol)
+        , book_memory_kind_(memory)
+        , book_memory_(makeBookMemory(memory, upstream))
+        , order_book_(symbol, book_memory_ ? book_memory_.get() : upstream)
+        , trade_retention_(0)
         , trade_count_(0)
         , total_volume_(0)
         , total_value_(0)
+        , warming_up_(false)
+        , console_logging_enabled_(true)
         , csv_logging_enabled_(false)
+        , archive_(nullptr)
+        , archive_sequence_(0)
     {
     }
 
@@ -30,26 +62,113 @@ namespace OrderBook {
     bool MatchingEngine::submitOrder(std::shared_ptr<Order> order) {
         if (!order) return false;
         
+        std::lock_guard<std::mutex> lock(matching_mutex_);
+        if (archive_) {
+            archiveEvent(JournalOp::SUBMIT, order->getId(), order->getSide(), order->getPrice(),
+                         order->getQuantity(), order->getTimestamp(), order->getOwner());
+        }
+        return submitOrderLocked(std::move(order));
+    }
+
+    bool MatchingEngine::submitOrderLocked(std::shared_ptr<Order> order) {
+        
+        OB_PROBE4(order_accept, order->getId(), static_cast<int>(order->getSide()),
+                  order->getPrice(), order->getQuantity());
+        
+        // One depth snapshot for the whole order, not one per fill
+        order_book_.beginBatch();
+        
         // Try to match the order first
         matchOrder(order);
         
         // If order wasn't completely filled, add to book
         if (!order->isFilled()) {
             order_book_.addOrder(order);
+        }
+        order_book_.endBatch();
+        
+        if (!order->isFilled()) {
             notifyOrderCallback(order);
         }
         
+        OB_PROBE2(order_complete, order->getId(), order->getRemainingQuantity());
         return true;
     }
 
     bool MatchingEngine::cancelOrder(Order::OrderID order_id) {
+        std::lock_guard<std::mutex> lock(matching_mutex_);
+        if (archive_) {
+            archiveEvent(JournalOp::CANCEL, order_id, OrderSide::BUY, 0, 0,
+                         std::chrono::high_resolution_clock::now(), 0);
+        }
+        return cancelOrderLocked(order_id);
+    }
+
+    bool MatchingEngine::cancelOrderLocked(Order::OrderID order_id) {
+        auto order = order_book_.getOrder(order_id);
         bool cancelled = order_book_.cancelOrder(order_id);
         if (cancelled) {
-            notifyOrderCallback(order_book_.getOrder(order_id));
+            OB_PROBE1(order_cancel, order_id);
+            notifyOrderCallback(order);
         }
         return cancelled;
     }
 
+    bool MatchingEngine::amendOrder(Order::OrderID order_id, uint64_t new_price, 
+                                    uint64_t new_quantity, Order::TimePoint timestamp) {
+        std::lock_guard<std::mutex> lock(matching_mutex_);
+        
+        auto order = order_book_.getOrder(order_id);
+        if (archive_) {
+            archiveEvent(JournalOp::AMEND, order_id, order ? order->getSide() : OrderSide::BUY,
+                         new_price, new_quantity, timestamp, order ? order->getOwner() : 0);
+        }
+        if (!order) return false;
+        
+        if (new_quantity == 0) {
+            return cancelOrderLocked(order_id);
+        }
+        
+        // Amend down at the same price keeps the order's place in the queue
+        if (new_price == order->getPrice() && new_quantity <= order->getRemainingQuantity()) {
+            uint64_t old_qty = order->getRemainingQuantity();
+            order->amendQuantity(new_quantity);
+            order_book_.updateOrderQuantity(order_id, old_qty, new_quantity);
+            notifyOrderCallback(order);
+            return true;
+        }
+        
+        // Otherwise cancel/replace: the order loses priority and may cross
+        if (!order_book_.cancelOrder(order_id)) return false;
+        
+        auto replacement = std::make_shared<Order>(order_id, order->getSide(), 
+                                                   new_price, new_quantity, timestamp);
+        replacement->setType(order->getType());
+        replacement->setOwner(order->getOwner());
+        return submitOrderLocked(replacement);
+    }
+
+    bool MatchingEngine::amendOrder(Order::OrderID order_id, uint64_t new_price, uint64_t new_quantity) {
+        return amendOrder(order_id, new_price, new_quantity, 
+                          std::chrono::high_resolution_clock::now());
+    }
+
+    void MatchingEngine::archiveEvent(JournalOp op, Order::OrderID order_id, OrderSide side, uint64_t price,
+                                      uint64_t quantity, Order::TimePoint timestamp, uint32_t owner) {
+        if (warming_up_) return;
+        
+        JournalRecord record;
+        record.sequence = ++archive_sequence_;
+        record.order_id = order_id;
+        record.price = price;
+        record.quantity = quantity;
+        record.timestamp = timestamp.time_since_epoch().count();
+        record.op = op;
+        record.side = side;
+        record.owner = owner;
+        archive_->appendEvent(record);
+    }
+
     void MatchingEngine::setCSVLogging(bool enable, const std::string& filename) {
         csv_logging_enabled_ = enable;
         csv_filename_ = filename;
@@ -97,11 +216,19 @@ namespace OrderBook {
             oss << "Average Trade Price: " << (total_value_.load() / total_volume_.load()) << "\n";
         }
         
+        oss << "Memory:\n" << getMemoryStats().toString();
         oss << "========================\n";
         return oss.str();
     }
 
+    MemoryStats MatchingEngine::getMemoryStats() const {
+        MemoryStats stats = order_book_.getMemoryStats();
+        stats[MemoryCategory::TRADES] = trade_memory_.usage();
+        return stats;
+    }
+
     void MatchingEngine::clear() {
+        std::lock_guard<std::mutex> lock(matching_mutex_);
         order_book_.clear();
         trades_.clear();
         trade_count_.store(0);
@@ -109,6 +236,62 @@ namespace OrderBook {
         total_value_.store(0);
     }
 
+    void MatchingEngine::warmup(const WarmupConfig& config) {
+        warming_up_ = true;
+        
+        // Pre-fault trade storage: reserve alone leaves the pages untouched
+        trades_.reserve(config.reserve_trades);
+        trade_memory_.set(trades_.capacity() * sizeof(Trade));
+        auto now = std::chrono::high_resolution_clock::now();
+        while (trades_.size() < trades_.capacity()) {
+            trades_.emplace_back(0, 0, 0, 0, now);
+        }
+        trades_.clear();
+        order_book_.reserve(config.reserve_orders);
+        
+        // Synthetic flow in an ID range real order flow never reaches
+        std::mt19937_64 rng(0x5EED);
+        std::uniform_int_distribution<uint64_t> offset_dist(1, config.price_range);
+        std::uniform_int_distribution<uint64_t> qty_dist(1, 100);
+        std::uniform_int_distribution<int> action_dist(0, 99);
+        const Order::OrderID base_id = 1ULL << 62;
+        Order::OrderID next_id = base_id;
+        
+        for (size_t i = 0; i < config.orders; ++i) {
+            int action = action_dist(rng);
+            OrderSide side = (action & 1) ? OrderSide::BUY : OrderSide::SELL;
+            uint64_t offset = offset_dist(rng);
+            uint64_t price;
+            uint64_t quantity = qty_dist(rng);
+            
+            if (action < 60) {
+                // Passive add away from the touch
+                price = (side == OrderSide::BUY) ? config.mid_price - offset : config.mid_price + offset;
+            } else if (action < 80) {
+                // Cancel a recent order, which may already be gone
+                if (next_id > base_id) {
+                    cancelOrder(next_id - 1 - (offset % std::min<uint64_t>(next_id - base_id, 64)));
+                }
+                continue;
+            } else if (action < 95) {
+                // Small order crossing the spread
+                price = (side == OrderSide::BUY) ? config.mid_price + offset : config.mid_price - offset;
+            } else {
+                // Sweep through several levels
+                price = (side == OrderSide::BUY) ? config.mid_price + config.price_range 
+                                                 : config.mid_price - config.price_range;
+                quantity *= 20;
+            }
+            
+            submitOrder(std::make_shared<Order>(next_id++, side, price, quantity,
+                                                std::chrono::high_resolution_clock::now()));
+        }
+        
+        // Reset state; vector and hash table capacity is kept
+        clear();
+        warming_up_ = false;
+    }
+
     size_t MatchingEngine::processBatch(const std::vector<std::shared_ptr<Order>>& orders) {
         size_t processed = 0;
         for (const auto& order : orders) {
@@ -123,46 +306,22 @@ namespace OrderBook {
         size_t trades_executed = 0;
         
         while (!order->isFilled()) {
-            // Get opposing orders for matching
             OrderSide opposing_side = (order->getSide() == OrderSide::BUY) ? 
                                     OrderSide::SELL : OrderSide::BUY;
             
-            auto opposing_orders = order_book_.getOrdersForMatching(opposing_side);
-            
-            if (opposing_orders.empty()) {
+            // Earliest order at the opposing best price
+            auto best_match = order_book_.getPriorityOrder(opposing_side);
+            if (!best_match) {
                 break; // No more orders to match against
             }
             
-            // Find best matching order (price-time priority)
-            std::shared_ptr<Order> best_match = nullptr;
-            uint64_t best_price = 0;
-            
-            for (const auto& opposing_order : opposing_orders) {
-                if (!opposing_order || opposing_order->isFilled()) continue;
-                
-                // Check if prices are compatible
-                bool price_compatible = false;
-                if (order->getSide() == OrderSide::BUY && 
-                    opposing_order->getSide() == OrderSide::SELL &&
-                    order->getPrice() >= opposing_order->getPrice()) {
-                    price_compatible = true;
-                    best_price = opposing_order->getPrice();
-                } else if (order->getSide() == OrderSide::SELL && 
-                          opposing_order->getSide() == OrderSide::BUY &&
-                          order->getPrice() <= opposing_order->getPrice()) {
-                    price_compatible = true;
-                    best_price = opposing_order->getPrice();
-                }
-                
-                if (price_compatible && 
-                    (!best_match || opposing_order->getTimestamp() < best_match->getTimestamp())) {
-                    best_match = opposing_order;
-                }
-            }
-            
-            if (!best_match) {
-                break; // No compatible orders found
+            bool price_compatible = (order->getSide() == OrderSide::BUY) 
+                ? order->getPrice() >= best_match->getPrice()
+                : order->getPrice() <= best_match->getPrice();
+            if (!price_compatible) {
+                break; // Best opposing price does not cross
             }
+            uint64_t best_price = best_match->getPrice();
             
             // Execute trade
             uint64_t trade_quantity = std::min(order->getRemainingQuantity(), 
@@ -184,7 +343,7 @@ namespace OrderBook {
             
             // Remove filled orders from book
             if (best_match->isFilled()) {
-                order_book_.cancelOrder(best_match->getId());
+                order_book_.removeFilledOrder(best_match->getId());
                 notifyOrderCallback(best_match);
             }
             
@@ -206,9 +365,21 @@ namespace OrderBook {
         auto now = std::chrono::high_resolution_clock::now();
         Trade trade(buy_order->getId(), sell_order->getId(), 
                    trade_price, trade_quantity, now);
+        trade.buy_owner_id = buy_order->getOwner();
+        trade.sell_owner_id = sell_order->getOwner();
+        
+        OB_PROBE4(order_fill, trade.buy_order_id, trade.sell_order_id,
+                  trade_price, trade_quantity);
         
-        // Store trade
+        // Store trade, recycling storage once the retention limit is hit
+        if (trade_retention_ > 0 && trades_.size() >= trade_retention_) {
+            trades_.clear();
+        }
+        size_t capacity = trades_.capacity();
         trades_.push_back(trade);
+        if (trades_.capacity() != capacity) {
+            trade_memory_.set(trades_.capacity() * sizeof(Trade));
+        }
         
         // Update statistics
         trade_count_.fetch_add(1);
@@ -217,10 +388,15 @@ namespace OrderBook {
         
         // Log trade
         logTradeToCSV(trade);
+        if (archive_ && !warming_up_) {
+            archive_->appendTrade(trade);
+        }
         notifyTradeCallback(trade);
         
         // Print trade to console
-        std::cout << "TRADE: " << trade.toString() << std::endl;
+        if (console_logging_enabled_ && !warming_up_) {
+            std::cout << "TRADE: " << trade.toString() << std::endl;
+        }
         
         return trade;
     }
@@ -228,6 +404,13 @@ namespace OrderBook {
     void MatchingEngine::logTradeToCSV(const Trade& trade) {
         if (!csv_logging_enabled_) return;
         
+        if (warming_up_) {
+            // Exercise the formatting path without writing synthetic trades
+            volatile size_t length = trade.toCSV().size();
+            (void)length;
+            return;
+        }
+        
         std::lock_guard<std::mutex> lock(csv_mutex_);
         if (csv_file_.is_open()) {
             csv_file_ << trade.toCSV() << "\n";
@@ -236,13 +419,13 @@ namespace OrderBook {
     }
 
     void MatchingEngine::notifyTradeCallback(const Trade& trade) {
-        if (trade_callback_) {
+        if (trade_callback_ && !warming_up_) {
             trade_callback_(trade);
         }
     }
 
     void MatchingEngine::notifyOrderCallback(std::shared_ptr<Order> order) {
-        if (order_callback_) {
+        if (order_callback_ && !warming_up_) {
             order_callback_(order);
         }
     }
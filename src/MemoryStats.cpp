@@ -0,0 +1,60 @@
+/**
+ * @file MemoryStats.cpp
+ * @brief Memory accounting summaries
+ */
+
+#include "MemoryStats.h"
+#include <iomanip>
+#include <sstream>
+
+namespace OrderBook {
+
+    MemoryStats& MemoryStats::operator+=(const MemoryStats& other) {
+        for (size_t i = 0; i < kCategories; ++i) {
+            categories[i].live_bytes += other.categories[i].live_bytes;
+            categories[i].peak_bytes += other.categories[i].peak_bytes;
+        }
+        return *this;
+    }
+
+    size_t MemoryStats::totalLive() const {
+        size_t total = 0;
+        for (const auto& usage : categories) total += usage.live_bytes;
+        return total;
+    }
+
+    size_t MemoryStats::totalPeak() const {
+        size_t total = 0;
+        for (const auto& usage : categories) total += usage.peak_bytes;
+        return total;
+    }
+
+    std::string MemoryStats::toString() const {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1);
+        for (size_t i = 0; i < kCategories; ++i) {
+            if (categories[i].peak_bytes == 0) continue;
+            oss << "  " << std::left << std::setw(16) << categoryName(static_cast<MemoryCategory>(i)) << std::right
+                << std::setw(12) << (categories[i].live_bytes / 1024.0) << " KB live"
+                << std::setw(12) << (categories[i].peak_bytes / 1024.0) << " KB peak\n";
+        }
+        oss << "  " << std::left << std::setw(16) << "total" << std::right
+            << std::setw(12) << (totalLive() / 1024.0) << " KB live"
+            << std::setw(12) << (totalPeak() / 1024.0) << " KB peak\n";
+        return oss.str();
+    }
+
+    const char* MemoryStats::categoryName(MemoryCategory category) {
+        switch (category) {
+            case MemoryCategory::ORDERS:          return "orders";
+            case MemoryCategory::LEVELS:          return "levels";
+            case MemoryCategory::ID_INDEX:        return "id index";
+            case MemoryCategory::TRADES:          return "trades";
+            case MemoryCategory::LATENCY_SAMPLES: return "latency samples";
+            case MemoryCategory::TASK_QUEUES:     return "task queues";
+            case MemoryCategory::COUNT:           break;
+        }
+        return "unknown";
+    }
+
+} // namespace OrderBook
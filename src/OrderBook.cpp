@@ -4,43 +4,121 @@
  */
 
 #include "OrderBook.h"
+#include "Probes.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 
 namespace OrderBook {
 
-    OrderBook::OrderBook(const std::string& symbol) 
+    using ReadLock = std::shared_lock<RWSpinLock>;
+    using WriteLock = std::unique_lock<RWSpinLock>;
+
+    OrderBook::OrderBook(const std::string& symbol, std::pmr::memory_resource* memory) 
         : symbol_(symbol)
+        , level_memory_(memory)
+        , index_memory_(memory)
+#ifdef ORDERBOOK_TIERED_INDEX
+        , bids_(PriceLevelMap::Touch::HIGH, &level_memory_, ORDERBOOK_TIERED_WINDOW)
+        , asks_(PriceLevelMap::Touch::LOW, &level_memory_, ORDERBOOK_TIERED_WINDOW)
+#else
+        , bids_(&level_memory_)
+        , asks_(&level_memory_)
+#endif
+        , orders_(&index_memory_)
+        , tob_sequence_(0)
+        , tob_bid_price_(0)
+        , tob_bid_quantity_(0)
+        , tob_ask_price_(0)
+        , tob_ask_quantity_(0)
+        , epochs_(nullptr)
+        , depth_snapshot_(nullptr)
+        , snapshot_bid_floor_(0)
+        , snapshot_ask_ceiling_(UINT64_MAX)
+        , batch_depth_(0)
+        , depth_dirty_(false)
+        , lazy_cancel_(false)
+        , compact_ratio_(0.5)
+        , tombstones_(0)
+        , peak_order_records_(0)
     {
     }
 
+    OrderBook::~OrderBook() {
+        delete depth_snapshot_.load();
+    }
+
+    void OrderBook::setEpochManager(EpochManager* epochs) {
+        WriteLock lock(book_lock_);
+        DepthSnapshot* old = depth_snapshot_.exchange(nullptr);
+        if (old) {
+            epochs_->retire(old);
+        }
+        epochs_ = epochs;
+        if (epochs_) {
+            publishDepth();
+        }
+    }
+
     bool OrderBook::addOrder(std::shared_ptr<Order> order) {
         if (!order) return false;
         
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        
+        {
+            WriteLock lock(book_lock_);
+            addOrderUnlocked(order);
+        }
+        reclaimRetired();
+        return true;
+    }
+
+    void OrderBook::addOrderUnlocked(const std::shared_ptr<Order>& order) {
         // Add to order map for O(1) lookup
         orders_[order->getId()] = order;
         
         // Add to appropriate price level
         PriceLevelMap& price_map = getPriceLevelMap(order->getSide());
-        auto it = price_map.find(order->getPrice());
-        
-        if (it != price_map.end()) {
-            it->second.addOrder(order);
-        } else {
-            PriceLevel level(order->getPrice());
-            level.addOrder(order);
-            price_map[order->getPrice()] = level;
+        if (order->isDead()) {
+            // Resubmitted after a lazy cancel: its tombstone may still be queued
+            auto level_it = price_map.find(order->getPrice());
+            if (level_it != price_map.end()) {
+                tombstones_ -= level_it->second.compact();
+            }
+            order->revive();
+        }
+        auto [it, created] = price_map.try_emplace(order->getPrice(), order->getPrice());
+        it->second.addOrder(order);
+        peak_order_records_ = std::max(peak_order_records_, orders_.size() + tombstones_);
+        checksum_.hash += BookChecksum::digest(*order, order->getRemainingQuantity());
+        checksum_.sequence++;
+        if (created) {
+            OB_PROBE2(level_create, static_cast<int>(order->getSide()), order->getPrice());
         }
         
-        return true;
+        publishTopOfBook();
+        publishDepth(order->getSide(), order->getPrice());
     }
 
     bool OrderBook::cancelOrder(Order::OrderID order_id) {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        
+        bool removed;
+        {
+            WriteLock lock(book_lock_);
+            removed = removeOrderUnlocked(order_id, false);
+        }
+        reclaimRetired();
+        return removed;
+    }
+
+    bool OrderBook::removeFilledOrder(Order::OrderID order_id) {
+        bool removed;
+        {
+            WriteLock lock(book_lock_);
+            removed = removeOrderUnlocked(order_id, true);
+        }
+        reclaimRetired();
+        return removed;
+    }
+
+    bool OrderBook::removeOrderUnlocked(Order::OrderID order_id, bool filled) {
         auto order_it = orders_.find(order_id);
         if (order_it == orders_.end()) {
             return false;
@@ -51,60 +129,88 @@ namespace OrderBook {
         auto level_it = price_map.find(order->getPrice());
         
         if (level_it != price_map.end()) {
-            bool removed = level_it->second.removeOrder(order_id);
-            if (removed && level_it->second.isEmpty()) {
+            PriceLevel& level = level_it->second;
+            bool removed = true;
+            const std::shared_ptr<Order>* front = level.front();
+            if (filled && front && *front == order) {
+                level.total_quantity -= order->getRemainingQuantity();
+                tombstones_ -= level.popFront();
+            } else if (lazy_cancel_ && !filled) {
+                tombstones_++;
+                tombstones_ -= level.markDead(order);
+                if (!level.isEmpty() && level.dead_count >= kMinCompaction &&
+                    level.dead_count >= compact_ratio_ * (level.orders.size() - level.head)) {
+                    tombstones_ -= level.compact();
+                }
+            } else {
+                removed = level.removeOrder(order_id);
+            }
+            if (removed && level.isEmpty()) {
                 removeEmptyPriceLevel(order->getSide(), order->getPrice());
             }
         }
         
         orders_.erase(order_it);
+        checksum_.hash -= BookChecksum::digest(*order, order->getRemainingQuantity());
+        checksum_.sequence++;
+        publishTopOfBook();
+        publishDepth(order->getSide(), order->getPrice());
         return true;
     }
 
+    TopOfBook OrderBook::getTopOfBook() const {
+        TopOfBook top;
+        while (true) {
+            uint64_t before = tob_sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;   // Writer mid-update
+            }
+            top.bid_price = tob_bid_price_.load(std::memory_order_relaxed);
+            top.bid_quantity = tob_bid_quantity_.load(std::memory_order_relaxed);
+            top.ask_price = tob_ask_price_.load(std::memory_order_relaxed);
+            top.ask_quantity = tob_ask_quantity_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (tob_sequence_.load(std::memory_order_relaxed) == before) {
+                return top;
+            }
+        }
+    }
+
     uint64_t OrderBook::getBestBid() const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        if (bids_.empty()) return 0;
-        return bids_.rbegin()->first; // Highest bid
+        return getTopOfBook().bid_price;
     }
 
     uint64_t OrderBook::getBestAsk() const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        if (asks_.empty()) return 0;
-        return asks_.begin()->first; // Lowest ask
+        return getTopOfBook().ask_price;
     }
 
     uint64_t OrderBook::getSpread() const {
-        uint64_t best_bid = getBestBid();
-        uint64_t best_ask = getBestAsk();
-        if (best_bid == 0 || best_ask == 0) return 0;
-        return best_ask - best_bid;
+        TopOfBook top = getTopOfBook();
+        if (top.bid_price == 0 || top.ask_price == 0) return 0;
+        return top.ask_price - top.bid_price;
     }
 
     uint64_t OrderBook::getBestBidQuantity() const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        if (bids_.empty()) return 0;
-        return bids_.rbegin()->second.total_quantity;
+        return getTopOfBook().bid_quantity;
     }
 
     uint64_t OrderBook::getBestAskQuantity() const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        if (asks_.empty()) return 0;
-        return asks_.begin()->second.total_quantity;
+        return getTopOfBook().ask_quantity;
     }
 
     std::shared_ptr<Order> OrderBook::getOrder(Order::OrderID order_id) const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
+        ReadLock lock(book_lock_);
         auto it = orders_.find(order_id);
         return (it != orders_.end()) ? it->second : nullptr;
     }
 
     std::vector<std::shared_ptr<Order>> OrderBook::getOrdersAtPrice(uint64_t price, OrderSide side) const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
+        ReadLock lock(book_lock_);
         const PriceLevelMap& price_map = getPriceLevelMap(side);
         auto it = price_map.find(price);
         
         if (it != price_map.end()) {
-            return it->second.orders;
+            return liveOrders(it->second);
         }
         return {};
     }
@@ -112,8 +218,13 @@ namespace OrderBook {
     std::pair<std::vector<std::pair<uint64_t, uint64_t>>, 
               std::vector<std::pair<uint64_t, uint64_t>>> 
     OrderBook::getMarketDepth(size_t levels) const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        
+        ReadLock lock(book_lock_);
+        return marketDepthUnlocked(levels);
+    }
+
+    std::pair<std::vector<std::pair<uint64_t, uint64_t>>, 
+              std::vector<std::pair<uint64_t, uint64_t>>> 
+    OrderBook::marketDepthUnlocked(size_t levels) const {
         std::vector<std::pair<uint64_t, uint64_t>> bid_levels;
         std::vector<std::pair<uint64_t, uint64_t>> ask_levels;
         
@@ -133,29 +244,94 @@ namespace OrderBook {
     }
 
     size_t OrderBook::getOrderCount() const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
+        ReadLock lock(book_lock_);
         return orders_.size();
     }
 
     bool OrderBook::isEmpty() const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
+        ReadLock lock(book_lock_);
         return orders_.empty();
     }
 
     void OrderBook::clear() {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        bids_.clear();
-        asks_.clear();
-        orders_.clear();
+        {
+            WriteLock lock(book_lock_);
+            bids_.clear();
+            asks_.clear();
+            orders_.clear();
+            tombstones_ = 0;
+            checksum_.hash = 0;
+            checksum_.sequence++;
+            publishTopOfBook();
+            if (epochs_) {
+                publishDepth();
+            }
+        }
+        reclaimRetired();
+    }
+
+    void OrderBook::reserve(size_t expected_orders) {
+        WriteLock lock(book_lock_);
+        orders_.reserve(expected_orders);
+    }
+
+    void OrderBook::setLazyCancel(bool enable, double compact_ratio) {
+        WriteLock lock(book_lock_);
+        lazy_cancel_ = enable;
+        compact_ratio_ = compact_ratio;
+        if (!enable) {
+            compactTombstonesUnlocked(SIZE_MAX);
+        }
+    }
+
+    size_t OrderBook::compactTombstones(size_t max_levels) {
+        WriteLock lock(book_lock_);
+        return compactTombstonesUnlocked(max_levels);
+    }
+
+    size_t OrderBook::compactTombstonesUnlocked(size_t max_levels) {
+        size_t removed = 0;
+        for (PriceLevelMap* price_map : {&bids_, &asks_}) {
+            for (auto& [price, level] : *price_map) {
+                if (tombstones_ == 0 || max_levels == 0) return removed;
+                if (level.dead_count == 0) continue;
+                size_t dropped = level.compact();
+                tombstones_ -= dropped;
+                removed += dropped;
+                max_levels--;
+            }
+        }
+        return removed;
+    }
+
+    BookChecksum OrderBook::getChecksum() const {
+        ReadLock lock(book_lock_);
+        return checksum_;
+    }
+
+    size_t OrderBook::getTombstoneCount() const {
+        ReadLock lock(book_lock_);
+        return tombstones_;
+    }
+
+    MemoryStats OrderBook::getMemoryStats() const {
+        ReadLock lock(book_lock_);
+        MemoryStats stats;
+        stats[MemoryCategory::ORDERS] = MemoryUsage{(orders_.size() + tombstones_) * sizeof(Order),
+                                                    peak_order_records_ * sizeof(Order)};
+        stats[MemoryCategory::LEVELS] = level_memory_.usage();
+        stats[MemoryCategory::ID_INDEX] = index_memory_.usage();
+        return stats;
     }
 
     std::string OrderBook::toString(size_t levels) const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
+        ReadLock lock(book_lock_);
         
         std::ostringstream oss;
         oss << "\n=== Order Book: " << symbol_ << " ===\n";
         
-        auto [bid_levels, ask_levels] = getMarketDepth(levels);
+        // Unlocked helpers: re-acquiring book_lock_ here could deadlock behind a waiting writer
+        auto [bid_levels, ask_levels] = marketDepthUnlocked(levels);
         
         // Print asks (highest first)
         oss << "ASKS:\n";
@@ -164,7 +340,8 @@ namespace OrderBook {
         }
         
         // Print spread line
-        uint64_t spread = getSpread();
+        uint64_t spread = (bid_levels.empty() || ask_levels.empty()) ? 0
+                        : ask_levels.front().first - bid_levels.front().first;
         oss << "--------|------------\n";
         oss << "SPREAD: " << spread << "\n";
         oss << "--------|------------\n";
@@ -182,38 +359,53 @@ namespace OrderBook {
     }
 
     std::pair<uint64_t, uint64_t> OrderBook::getBestPrices() const {
-        return {getBestBid(), getBestAsk()};
+        TopOfBook top = getTopOfBook();
+        return {top.bid_price, top.ask_price};
     }
 
     std::vector<std::shared_ptr<Order>> OrderBook::getOrdersForMatching(OrderSide side) const {
-        std::unique_lock<std::mutex> lock(book_mutex_);
+        ReadLock lock(book_lock_);
         const PriceLevelMap& price_map = getPriceLevelMap(side);
         
         if (price_map.empty()) return {};
         
         // Get orders from best price level
-        if (side == OrderSide::BUY) {
-            auto best_level_it = price_map.rbegin();
-            return best_level_it->second.orders;
-        } else {
-            auto best_level_it = price_map.begin();
-            return best_level_it->second.orders;
-        }
+        const PriceLevel& best_level = (side == OrderSide::BUY) ? price_map.rbegin()->second 
+                                                                 : price_map.begin()->second;
+        return liveOrders(best_level);
     }
 
-    void OrderBook::updateOrderQuantity(Order::OrderID order_id, uint64_t old_qty, uint64_t new_qty) {
-        std::unique_lock<std::mutex> lock(book_mutex_);
-        
-        auto order_it = orders_.find(order_id);
-        if (order_it == orders_.end()) return;
-        
-        auto order = order_it->second;
-        PriceLevelMap& price_map = getPriceLevelMap(order->getSide());
-        auto level_it = price_map.find(order->getPrice());
+    std::shared_ptr<Order> OrderBook::getPriorityOrder(OrderSide side) const {
+        ReadLock lock(book_lock_);
+        const PriceLevelMap& price_map = getPriceLevelMap(side);
+        if (price_map.empty()) return nullptr;
         
-        if (level_it != price_map.end()) {
-            level_it->second.updateQuantity(order_id, old_qty, new_qty);
+        const PriceLevel& best_level = (side == OrderSide::BUY) ? price_map.rbegin()->second 
+                                                                 : price_map.begin()->second;
+        const std::shared_ptr<Order>* priority = best_level.front();
+        return priority ? *priority : nullptr;
+    }
+
+    void OrderBook::updateOrderQuantity(Order::OrderID order_id, uint64_t old_qty, uint64_t new_qty) {
+        {
+            WriteLock lock(book_lock_);
+            
+            auto order_it = orders_.find(order_id);
+            if (order_it == orders_.end()) return;
+            
+            auto order = order_it->second;
+            PriceLevelMap& price_map = getPriceLevelMap(order->getSide());
+            auto level_it = price_map.find(order->getPrice());
+            
+            if (level_it != price_map.end()) {
+                level_it->second.updateQuantity(order_id, old_qty, new_qty);
+                checksum_.hash += BookChecksum::digest(*order, new_qty) - BookChecksum::digest(*order, old_qty);
+                checksum_.sequence++;
+                publishTopOfBook();
+                publishDepth(order->getSide(), order->getPrice());
+            }
         }
+        reclaimRetired();
     }
 
     OrderBook::PriceLevelMap& OrderBook::getPriceLevelMap(OrderSide side) {
@@ -224,12 +416,96 @@ namespace OrderBook {
         return (side == OrderSide::BUY) ? bids_ : asks_;
     }
 
+    void OrderBook::publishTopOfBook() {
+        uint64_t sequence = tob_sequence_.load(std::memory_order_relaxed);
+        tob_sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        tob_bid_price_.store(bids_.empty() ? 0 : bids_.rbegin()->first, std::memory_order_relaxed);
+        tob_bid_quantity_.store(bids_.empty() ? 0 : bids_.rbegin()->second.total_quantity, std::memory_order_relaxed);
+        tob_ask_price_.store(asks_.empty() ? 0 : asks_.begin()->first, std::memory_order_relaxed);
+        tob_ask_quantity_.store(asks_.empty() ? 0 : asks_.begin()->second.total_quantity, std::memory_order_relaxed);
+        
+        tob_sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    void OrderBook::beginBatch() {
+        if (!epochs_) return;
+        batch_depth_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OrderBook::endBatch() {
+        if (!epochs_) return;
+        if (batch_depth_.fetch_sub(1, std::memory_order_relaxed) == 1 &&
+            depth_dirty_.load(std::memory_order_relaxed)) {
+            WriteLock lock(book_lock_);
+            // Another batch may have opened, or a writer published, since the check
+            if (batch_depth_.load(std::memory_order_relaxed) == 0 && depth_dirty_.load(std::memory_order_relaxed)) {
+                publishDepth();
+            }
+        }
+        reclaimRetired();
+    }
+
+    void OrderBook::reclaimRetired() {
+        if (epochs_ && batch_depth_.load(std::memory_order_relaxed) == 0) {
+            epochs_->reclaimIfDue();
+        }
+    }
+
+    void OrderBook::publishDepth(OrderSide side, uint64_t price) {
+        if (!epochs_) return;
+        bool visible = (side == OrderSide::BUY) ? price >= snapshot_bid_floor_ : price <= snapshot_ask_ceiling_;
+        if (!visible) return;
+        if (batch_depth_.load(std::memory_order_relaxed) > 0) {
+            depth_dirty_.store(true, std::memory_order_relaxed);
+        } else {
+            publishDepth();
+        }
+    }
+
+    void OrderBook::publishDepth() {
+        depth_dirty_.store(false, std::memory_order_relaxed);
+        DepthSnapshot* snapshot = new DepthSnapshot();
+        DepthSnapshot* old = depth_snapshot_.load(std::memory_order_relaxed);
+        snapshot->sequence = old ? old->sequence + 1 : 1;
+        
+        for (auto it = bids_.rbegin(); it != bids_.rend() && snapshot->bid_count < DepthSnapshot::kLevels; ++it) {
+            snapshot->bids[snapshot->bid_count++] = {it->first, it->second.total_quantity};
+        }
+        for (auto it = asks_.begin(); it != asks_.end() && snapshot->ask_count < DepthSnapshot::kLevels; ++it) {
+            snapshot->asks[snapshot->ask_count++] = {it->first, it->second.total_quantity};
+        }
+        
+        // With fewer than kLevels on a side, any price on that side shows up
+        snapshot_bid_floor_ = (snapshot->bid_count == DepthSnapshot::kLevels) 
+                            ? snapshot->bids[DepthSnapshot::kLevels - 1].first : 0;
+        snapshot_ask_ceiling_ = (snapshot->ask_count == DepthSnapshot::kLevels) 
+                              ? snapshot->asks[DepthSnapshot::kLevels - 1].first : UINT64_MAX;
+        
+        depth_snapshot_.store(snapshot, std::memory_order_release);
+        if (old) {
+            epochs_->retire(old);
+        }
+    }
+
     void OrderBook::removeEmptyPriceLevel(OrderSide side, uint64_t price) {
         PriceLevelMap& price_map = getPriceLevelMap(side);
         auto it = price_map.find(price);
         if (it != price_map.end() && it->second.isEmpty()) {
+            tombstones_ -= it->second.dead_count;
             price_map.erase(it);
+            OB_PROBE2(level_destroy, static_cast<int>(side), price);
+        }
+    }
+
+    std::vector<std::shared_ptr<Order>> OrderBook::liveOrders(const PriceLevel& level) {
+        std::vector<std::shared_ptr<Order>> orders;
+        orders.reserve(level.orders.size() - level.head - level.dead_count);
+        for (auto it = level.orders.begin() + level.head; it != level.orders.end(); ++it) {
+            if (!(*it)->isDead()) orders.push_back(*it);
         }
+        return orders;
     }
 
 } // namespace OrderBook
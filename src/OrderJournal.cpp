@@ -0,0 +1,29 @@
+/**
+ * @file OrderJournal.cpp
+ * @brief Journal record replay
+ */
+
+#include "OrderJournal.h"
+#include "MatchingEngine.h"
+
+namespace OrderBook {
+
+    bool applyJournalRecord(MatchingEngine& engine, const JournalRecord& record) {
+        Order::TimePoint timestamp{Order::TimePoint::duration(record.timestamp)};
+
+        switch (record.op) {
+            case JournalOp::SUBMIT: {
+                auto order = std::make_shared<Order>(record.order_id, record.side, record.price,
+                                                     record.quantity, timestamp);
+                order->setOwner(record.owner);
+                return engine.submitOrder(order);
+            }
+            case JournalOp::CANCEL:
+                return engine.cancelOrder(record.order_id);
+            case JournalOp::AMEND:
+                return engine.amendOrder(record.order_id, record.price, record.quantity, timestamp);
+        }
+        return false;
+    }
+
+} // namespace OrderBook
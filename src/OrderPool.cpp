@@ -0,0 +1,94 @@
+/**
+ * @file OrderPool.cpp
+ * @brief Recycling order allocator implementation
+ */
+
+#include "OrderPool.h"
+#include <algorithm>
+#include <new>
+
+namespace OrderBook {
+
+    OrderPool::OrderPool(size_t slots_per_chunk)
+        : slots_per_chunk_(std::max<size_t>(slots_per_chunk, 1))
+        , slot_size_(0)
+        , free_list_(nullptr)
+        , live_count_(0)
+        , capacity_(0)
+    {
+    }
+
+    OrderPool::~OrderPool() {
+        for (void* chunk : chunks_) {
+            ::operator delete(chunk);
+        }
+    }
+
+    void* OrderPool::allocate(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // The first request fixes the slot size (the allocate_shared block)
+        if (slot_size_ == 0) {
+            slot_size_ = std::max(bytes, sizeof(FreeSlot));
+            slot_size_ = (slot_size_ + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        }
+
+        if (bytes > slot_size_) {
+            return ::operator new(bytes);
+        }
+
+        if (!free_list_) {
+            grow();
+        }
+
+        FreeSlot* slot = free_list_;
+        free_list_ = slot->next;
+        live_count_++;
+        return slot;
+    }
+
+    void OrderPool::deallocate(void* ptr, size_t bytes) {
+        if (!ptr) return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (bytes > slot_size_) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+        slot->next = free_list_;
+        free_list_ = slot;
+        live_count_--;
+    }
+
+    size_t OrderPool::getLiveCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return live_count_;
+    }
+
+    size_t OrderPool::getCapacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    size_t OrderPool::getReservedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_ * slot_size_;
+    }
+
+    void OrderPool::grow() {
+        char* chunk = static_cast<char*>(::operator new(slot_size_ * slots_per_chunk_));
+        chunks_.push_back(chunk);
+
+        // Thread the new slots onto the free list in address order
+        for (size_t i = slots_per_chunk_; i-- > 0; ) {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + i * slot_size_);
+            slot->next = free_list_;
+            free_list_ = slot;
+        }
+        capacity_ += slots_per_chunk_;
+    }
+
+} // namespace OrderBook
@@ -4,6 +4,7 @@
  */
 
 #include "PerformanceMonitor.h"
+#include "ThreadPool.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -11,10 +12,88 @@
 #include <iomanip>
 #include <iostream>
 
+#if defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
 namespace OrderBook {
 
+    size_t LatencyHistogram::bucketIndex(uint64_t value_ns) {
+        if (value_ns < (uint64_t(1) << kSubBucketBits)) {
+            return static_cast<size_t>(value_ns);
+        }
+        unsigned msb = 63 - __builtin_clzll(value_ns);
+        unsigned shift = msb - (kSubBucketBits - 1);
+        uint64_t top = value_ns >> shift;
+        return (size_t(1) << kSubBucketBits) + (shift - 1) * kHalf + (top - kHalf);
+    }
+
+    uint64_t LatencyHistogram::bucketLowerBound(size_t index) {
+        if (index < (size_t(1) << kSubBucketBits)) {
+            return index;
+        }
+        size_t offset = index - (size_t(1) << kSubBucketBits);
+        unsigned shift = static_cast<unsigned>(offset / kHalf) + 1;
+        uint64_t top = offset % kHalf + kHalf;
+        return top << shift;
+    }
+
+    uint64_t LatencyHistogram::bucketWidth(size_t index) {
+        if (index < (size_t(1) << kSubBucketBits)) {
+            return 1;
+        }
+        size_t offset = index - (size_t(1) << kSubBucketBits);
+        return uint64_t(1) << (offset / kHalf + 1);
+    }
+
+    void LatencyHistogram::record(uint64_t value_ns) {
+        counts[bucketIndex(value_ns)]++;
+        total++;
+        if (value_ns < min) min = value_ns;
+        if (value_ns > max) max = value_ns;
+        double v = static_cast<double>(value_ns);
+        sum += v;
+        sum_squares += v * v;
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        sum += other.sum;
+        sum_squares += other.sum_squares;
+    }
+
+    double LatencyHistogram::percentile(double percentile) const {
+        if (total == 0) return 0.0;
+
+        uint64_t target = static_cast<uint64_t>(percentile * (total - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen > target) {
+                double mid = bucketLowerBound(i) + (bucketWidth(i) - 1) / 2.0;
+                return std::min(std::max(mid, static_cast<double>(min)), static_cast<double>(max));
+            }
+        }
+        return static_cast<double>(max);
+    }
+
+    void LatencyHistogram::clear() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        min = UINT64_MAX;
+        max = 0;
+        sum = 0.0;
+        sum_squares = 0.0;
+    }
+
     PerformanceMonitor::PerformanceMonitor(bool enable_detailed_logging)
         : detailed_logging_enabled_(enable_detailed_logging)
+        , sample_budget_(0)
     {
     }
 
@@ -45,16 +124,26 @@ namespace OrderBook {
         
         std::lock_guard<std::mutex> lock(global_mutex_);
         
+        size_t operations = operation_data_.size();
         auto& data = operation_data_[operation_type];
+        size_t sample_capacity = data.latencies.capacity();
+        size_t detailed_capacity = detailed_measurements_.capacity();
         {
             std::lock_guard<std::mutex> data_lock(data.mutex);
             data.latencies.push_back(latency_ns);
+            
+            if (sample_budget_ > 0) {
+                data.histogram.record(latency_ns);
+                if (data.latencies.size() >= sample_budget_) {
+                    spillSamples(operation_type, data);
+                }
+            }
         }
         
         data.total_count.fetch_add(1);
         data.total_latency.fetch_add(latency_ns);
         
-        if (detailed_logging_enabled_) {
+        if (detailed_logging_enabled_ && sample_budget_ == 0) {
             LatencyMeasurement measurement;
             measurement.start_time = std::chrono::high_resolution_clock::now() - 
                                    std::chrono::nanoseconds(latency_ns);
@@ -64,6 +153,11 @@ namespace OrderBook {
             
             detailed_measurements_.push_back(measurement);
         }
+        
+        if (operation_data_.size() != operations || data.latencies.capacity() != sample_capacity ||
+            detailed_measurements_.capacity() != detailed_capacity) {
+            sample_memory_.set(sampleBytesLocked());
+        }
     }
 
     PerformanceStats PerformanceMonitor::getStats(const std::string& operation_type) const {
@@ -75,12 +169,57 @@ namespace OrderBook {
         }
         
         std::lock_guard<std::mutex> data_lock(it->second.mutex);
+        if (sample_budget_ > 0) {
+            return calculateStats(it->second.histogram);
+        }
         return calculateStats(it->second.latencies);
     }
 
+    PerformanceStats PerformanceMonitor::getStats(const std::string& operation_type, ThreadPool& pool) const {
+        std::vector<uint64_t> latencies;
+        {
+            std::lock_guard<std::mutex> lock(global_mutex_);
+            
+            auto it = operation_data_.find(operation_type);
+            if (it == operation_data_.end()) {
+                return PerformanceStats();
+            }
+            
+            std::lock_guard<std::mutex> data_lock(it->second.mutex);
+            if (sample_budget_ > 0) {
+                return calculateStats(it->second.histogram);
+            }
+            // Copy out so recording is not blocked while the pool works
+            latencies = it->second.latencies;
+        }
+        return calculateStats(latencies, pool);
+    }
+
+    void PerformanceMonitor::reserve(const std::string& operation_type, size_t samples) {
+        std::lock_guard<std::mutex> lock(global_mutex_);
+        
+        auto& data = operation_data_[operation_type];
+        std::lock_guard<std::mutex> data_lock(data.mutex);
+        
+        // Writing the reserved range faults its pages in; clear() keeps the capacity
+        size_t existing = data.latencies.size();
+        data.latencies.resize(existing + samples);
+        data.latencies.resize(existing);
+        sample_memory_.set(sampleBytesLocked());
+    }
+
     PerformanceStats PerformanceMonitor::getOverallStats() const {
         std::lock_guard<std::mutex> lock(global_mutex_);
         
+        if (sample_budget_ > 0) {
+            LatencyHistogram merged;
+            for (const auto& [op_type, data] : operation_data_) {
+                std::lock_guard<std::mutex> data_lock(data.mutex);
+                merged.merge(data.histogram);
+            }
+            return calculateStats(merged);
+        }
+        
         std::vector<uint64_t> all_latencies;
         // uint64_t total_count = 0; // Not used
         
@@ -112,6 +251,22 @@ namespace OrderBook {
         
         operation_data_.clear();
         detailed_measurements_.clear();
+        sample_memory_.set(sampleBytesLocked());
+    }
+
+    MemoryStats PerformanceMonitor::getMemoryStats() const {
+        MemoryStats stats;
+        stats[MemoryCategory::LATENCY_SAMPLES] = sample_memory_.usage();
+        return stats;
+    }
+
+    size_t PerformanceMonitor::sampleBytesLocked() const {
+        size_t bytes = detailed_measurements_.capacity() * sizeof(LatencyMeasurement);
+        for (const auto& [op_type, data] : operation_data_) {
+            bytes += data.latencies.capacity() * sizeof(uint64_t);
+            bytes += data.histogram.counts.capacity() * sizeof(uint64_t);
+        }
+        return bytes;
     }
 
     bool PerformanceMonitor::exportToCSV(const std::string& filename) const {
@@ -162,9 +317,13 @@ namespace OrderBook {
             std::cout << "Median Latency: " << overall_stats.median_latency_ns << " ns" << std::endl;
             std::cout << "95th Percentile: " << overall_stats.p95_latency_ns << " ns" << std::endl;
             std::cout << "99th Percentile: " << overall_stats.p99_latency_ns << " ns" << std::endl;
+            std::cout << "99.9th Percentile: " << overall_stats.p999_latency_ns << " ns" << std::endl;
             std::cout << "Std Deviation: " << overall_stats.std_deviation_ns << " ns" << std::endl;
             std::cout << "Throughput: " << std::fixed << std::setprecision(2) 
                       << overall_stats.throughput_ops_per_sec << " ops/sec" << std::endl;
+            MemoryUsage samples = getMemoryStats()[MemoryCategory::LATENCY_SAMPLES];
+            std::cout << "Sample Memory: " << std::setprecision(1) << (samples.live_bytes / 1024.0)
+                      << " KB live, " << (samples.peak_bytes / 1024.0) << " KB peak" << std::endl;
             std::cout << "=======================================" << std::endl;
         } else {
             // Print specific operation stats
@@ -178,6 +337,7 @@ namespace OrderBook {
             std::cout << "Median Latency: " << stats.median_latency_ns << " ns" << std::endl;
             std::cout << "95th Percentile: " << stats.p95_latency_ns << " ns" << std::endl;
             std::cout << "99th Percentile: " << stats.p99_latency_ns << " ns" << std::endl;
+            std::cout << "99.9th Percentile: " << stats.p999_latency_ns << " ns" << std::endl;
             std::cout << "Throughput: " << std::fixed << std::setprecision(2) 
                       << stats.throughput_ops_per_sec << " ops/sec" << std::endl;
             std::cout << "================================" << std::endl;
@@ -203,6 +363,79 @@ namespace OrderBook {
         return total;
     }
 
+    void PerformanceMonitor::setSampleBudget(size_t max_samples, const std::string& spill_filename) {
+        std::lock_guard<std::mutex> lock(global_mutex_);
+        
+        sample_budget_ = max_samples;
+        if (spill_file_.is_open()) {
+            spill_file_.close();
+        }
+        if (max_samples > 0 && !spill_filename.empty()) {
+            spill_file_.open(spill_filename, std::ios::out | std::ios::trunc);
+            if (spill_file_.is_open()) {
+                spill_file_ << "operation_type,order_id,latency_ns,latency_us\n";
+            }
+        }
+        
+        // Seed the histograms with anything recorded before the budget was set
+        for (auto& [op_type, data] : operation_data_) {
+            std::lock_guard<std::mutex> data_lock(data.mutex);
+            data.histogram.clear();
+            for (uint64_t latency : data.latencies) {
+                data.histogram.record(latency);
+            }
+        }
+    }
+
+    void PerformanceMonitor::spillSamples(const std::string& operation_type, OperationData& data) {
+        if (spill_file_.is_open()) {
+            for (uint64_t latency : data.latencies) {
+                spill_file_ << operation_type << ",0," << latency << ","
+                            << std::fixed << std::setprecision(3) << (latency / 1000.0) << "\n";
+            }
+        }
+        data.latencies.clear();
+    }
+
+    size_t PerformanceMonitor::getResidentSetBytes() {
+#if defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        size_t total_pages = 0;
+        size_t resident_pages = 0;
+        if (statm >> total_pages >> resident_pages) {
+            return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+
+    PerformanceStats PerformanceMonitor::calculateStats(const LatencyHistogram& histogram) const {
+        PerformanceStats stats;
+        
+        if (histogram.total == 0) {
+            return stats;
+        }
+        
+        stats.total_operations = histogram.total;
+        stats.min_latency_ns = histogram.min;
+        stats.max_latency_ns = histogram.max;
+        stats.mean_latency_ns = histogram.sum / histogram.total;
+        stats.median_latency_ns = histogram.percentile(0.50);
+        stats.p95_latency_ns = histogram.percentile(0.95);
+        stats.p99_latency_ns = histogram.percentile(0.99);
+        stats.p999_latency_ns = histogram.percentile(0.999);
+        
+        double variance = histogram.sum_squares / histogram.total - 
+                          stats.mean_latency_ns * stats.mean_latency_ns;
+        stats.std_deviation_ns = std::sqrt(std::max(variance, 0.0));
+        
+        if (stats.mean_latency_ns > 0) {
+            stats.throughput_ops_per_sec = 1e9 / stats.mean_latency_ns;
+        }
+        
+        return stats;
+    }
+
     PerformanceStats PerformanceMonitor::calculateStats(const std::vector<uint64_t>& latencies) const {
         PerformanceStats stats;
         
@@ -233,6 +466,7 @@ namespace OrderBook {
         // Calculate percentiles
         stats.p95_latency_ns = getPercentile(sorted_latencies, 0.95);
         stats.p99_latency_ns = getPercentile(sorted_latencies, 0.99);
+        stats.p999_latency_ns = getPercentile(sorted_latencies, 0.999);
         
         // Calculate standard deviation
         double variance = 0.0;
@@ -251,6 +485,81 @@ namespace OrderBook {
         return stats;
     }
 
+    PerformanceStats PerformanceMonitor::calculateStats(const std::vector<uint64_t>& latencies, 
+                                                        ThreadPool& pool) const {
+        PerformanceStats stats;
+        
+        if (latencies.empty()) {
+            return stats;
+        }
+        
+        const size_t count = latencies.size();
+        stats.total_operations = count;
+        
+        // Sort one run per thread, then merge runs pairwise in parallel rounds
+        auto sorted_latencies = latencies;
+        const size_t runs = pool.getThreadCount() + 1;
+        const size_t run_length = (count + runs - 1) / runs;
+        pool.parallelFor(0, runs, 1, [&](size_t first, size_t last) {
+            for (size_t run = first; run < last; ++run) {
+                size_t lo = std::min(run * run_length, count);
+                size_t hi = std::min(lo + run_length, count);
+                std::sort(sorted_latencies.begin() + lo, sorted_latencies.begin() + hi);
+            }
+        });
+        for (size_t width = run_length; width < count; width *= 2) {
+            size_t pairs = (count + 2 * width - 1) / (2 * width);
+            pool.parallelFor(0, pairs, 1, [&](size_t first, size_t last) {
+                for (size_t pair = first; pair < last; ++pair) {
+                    size_t lo = pair * 2 * width;
+                    size_t mid = std::min(lo + width, count);
+                    size_t hi = std::min(lo + 2 * width, count);
+                    std::inplace_merge(sorted_latencies.begin() + lo, sorted_latencies.begin() + mid,
+                                       sorted_latencies.begin() + hi);
+                }
+            });
+        }
+        
+        stats.min_latency_ns = sorted_latencies.front();
+        stats.max_latency_ns = sorted_latencies.back();
+        
+        uint64_t sum = pool.parallelReduce(0, count, 0, uint64_t(0),
+            [&](size_t first, size_t last) {
+                return std::accumulate(sorted_latencies.begin() + first, sorted_latencies.begin() + last, 0ULL);
+            },
+            [](uint64_t a, uint64_t b) { return a + b; });
+        stats.mean_latency_ns = static_cast<double>(sum) / count;
+        
+        if (count % 2 == 0) {
+            stats.median_latency_ns = (sorted_latencies[count / 2 - 1] + sorted_latencies[count / 2]) / 2.0;
+        } else {
+            stats.median_latency_ns = sorted_latencies[count / 2];
+        }
+        
+        stats.p95_latency_ns = getPercentile(sorted_latencies, 0.95);
+        stats.p99_latency_ns = getPercentile(sorted_latencies, 0.99);
+        stats.p999_latency_ns = getPercentile(sorted_latencies, 0.999);
+        
+        const double mean = stats.mean_latency_ns;
+        double variance = pool.parallelReduce(0, count, 0, 0.0,
+            [&](size_t first, size_t last) {
+                double partial = 0.0;
+                for (size_t i = first; i < last; ++i) {
+                    double diff = latencies[i] - mean;
+                    partial += diff * diff;
+                }
+                return partial;
+            },
+            [](double a, double b) { return a + b; });
+        stats.std_deviation_ns = std::sqrt(variance / count);
+        
+        if (stats.mean_latency_ns > 0) {
+            stats.throughput_ops_per_sec = 1e9 / stats.mean_latency_ns;
+        }
+        
+        return stats;
+    }
+
     double PerformanceMonitor::getPercentile(const std::vector<uint64_t>& sorted_data, double percentile) const {
         if (sorted_data.empty()) return 0.0;
         
@@ -0,0 +1,212 @@
+/**
+ * @file PositionKeeper.cpp
+ * @brief Real-time position and P&L keeping implementation
+ */
+
+#include "PositionKeeper.h"
+#include "MatchingEngine.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace OrderBook {
+
+    double PositionSnapshot::totalPnl(uint32_t owner) const {
+        double total = 0.0;
+        for (uint32_t instrument = 0; instrument < instruments; ++instrument) {
+            const Position& position = at(owner, instrument);
+            total += position.realized_pnl + position.unrealizedPnl(marks[instrument]);
+        }
+        return total;
+    }
+
+    int64_t PositionSnapshot::netQuantity(uint32_t instrument) const {
+        int64_t net = 0;
+        for (uint32_t owner = 0; owner < owners; ++owner) {
+            net += at(owner, instrument).quantity;
+        }
+        return net;
+    }
+
+    PositionKeeper::PositionKeeper(const PositionKeeperConfig& config)
+        : config_(config)
+        , positions_(static_cast<size_t>(config.max_owners) * config.max_instruments)
+        , marks_(config.max_instruments, 0)
+        , running_(false)
+        , fills_applied_(0)
+        , fills_published_(0)
+        , fills_rejected_(0)
+        , snapshots_published_(0)
+        , publish_requested_(false)
+    {
+        auto make_snapshot = [this]() {
+            auto snapshot = std::make_shared<PositionSnapshot>();
+            snapshot->owners = config_.max_owners;
+            snapshot->instruments = config_.max_instruments;
+            snapshot->positions = positions_;
+            snapshot->marks = marks_;
+            return snapshot;
+        };
+        published_ = make_snapshot();
+        back_ = make_snapshot();
+    }
+
+    PositionKeeper::~PositionKeeper() {
+        stop();
+    }
+
+    PositionKeeper::FillRing& PositionKeeper::addProducer() {
+        rings_.push_back(std::make_unique<FillRing>());
+        return *rings_.back();
+    }
+
+    void PositionKeeper::attach(MatchingEngine& engine, uint32_t instrument) {
+        FillRing& ring = addProducer();
+        const auto& book = engine.getOrderBook();
+
+        engine.setTradeCallback([&ring, &book, instrument](const Trade& trade) {
+            auto best = book.getBestPrices();
+            ring.push(FillEvent{instrument, trade.buy_owner_id, trade.sell_owner_id,
+                                trade.price, trade.quantity, best.first, best.second});
+        });
+    }
+
+    void PositionKeeper::start() {
+        if (running_.exchange(true)) return;
+        consumer_ = std::thread(&PositionKeeper::consumerLoop, this);
+    }
+
+    void PositionKeeper::stop() {
+        if (!running_.exchange(false)) return;
+        if (consumer_.joinable()) {
+            consumer_.join();
+        }
+    }
+
+    void PositionKeeper::flush() {
+        uint64_t target = 0;
+        for (const auto& ring : rings_) {
+            target += ring->pushedCount();
+        }
+
+        while (fills_published_.load(std::memory_order_acquire) < target) {
+            if (!running_.load(std::memory_order_acquire)) break;
+            publish_requested_.store(true, std::memory_order_release);
+            std::this_thread::yield();
+        }
+    }
+
+    std::shared_ptr<const PositionSnapshot> PositionKeeper::snapshot() const {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        return published_;
+    }
+
+    void PositionKeeper::consumerLoop() {
+        using Clock = std::chrono::steady_clock;
+        const size_t batch = 1024;
+        auto last_publish = Clock::now();
+
+        while (true) {
+            // Read the flag before draining so the final pass sees every fill
+            bool running = running_.load(std::memory_order_acquire);
+
+            size_t drained = 0;
+            FillEvent fill;
+            for (auto& ring : rings_) {
+                for (size_t n = 0; n < batch && ring->tryPop(fill); ++n) {
+                    apply(fill);
+                    ++drained;
+                }
+            }
+
+            bool dirty = fills_applied_.load(std::memory_order_relaxed) !=
+                         fills_published_.load(std::memory_order_relaxed);
+            if (dirty) {
+                auto now = Clock::now();
+                // Publish on idle, on request, or at the configured cadence under load
+                if (drained == 0 || publish_requested_.exchange(false, std::memory_order_acq_rel) ||
+                    now - last_publish >= config_.publish_interval) {
+                    publish();
+                    last_publish = now;
+                }
+            }
+
+            if (drained == 0) {
+                if (!running) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void PositionKeeper::apply(const FillEvent& fill) {
+        if (fill.instrument < config_.max_instruments &&
+            fill.buy_owner < config_.max_owners &&
+            fill.sell_owner < config_.max_owners) {
+            const size_t instruments = config_.max_instruments;
+            int64_t quantity = static_cast<int64_t>(fill.quantity);
+
+            applyToPosition(positions_[fill.buy_owner * instruments + fill.instrument], quantity, fill.price);
+            applyToPosition(positions_[fill.sell_owner * instruments + fill.instrument], -quantity, fill.price);
+
+            // Mark to the mid when both sides are quoted, else to the fill
+            marks_[fill.instrument] = (fill.best_bid && fill.best_ask)
+                ? (fill.best_bid + fill.best_ask) / 2
+                : fill.price;
+        } else {
+            fills_rejected_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Single writer: a plain store is enough and keeps the hot path cheap
+        fills_applied_.store(fills_applied_.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+    }
+
+    void PositionKeeper::applyToPosition(Position& position, int64_t signed_quantity, uint64_t price) {
+        const double fill_price = static_cast<double>(price);
+        position.fills++;
+
+        if (position.quantity == 0 || (position.quantity > 0) == (signed_quantity > 0)) {
+            // Opening or adding: blend into the average cost
+            int64_t open = std::llabs(position.quantity);
+            int64_t added = std::llabs(signed_quantity);
+            position.average_cost = (position.average_cost * open + fill_price * added) / (open + added);
+            position.quantity += signed_quantity;
+            return;
+        }
+
+        // Reducing: realize P&L on the closed part at the average cost
+        int64_t closed = std::min(std::llabs(position.quantity), std::llabs(signed_quantity));
+        double direction = position.quantity > 0 ? 1.0 : -1.0;
+        position.realized_pnl += direction * closed * (fill_price - position.average_cost);
+        position.quantity += signed_quantity;
+
+        if (position.quantity == 0) {
+            position.average_cost = 0.0;
+        } else if ((position.quantity > 0) == (signed_quantity > 0)) {
+            // Flipped through flat: the remainder opens at the fill price
+            position.average_cost = fill_price;
+        }
+    }
+
+    void PositionKeeper::publish() {
+        // A reader still holds the old buffer: switch to a fresh one instead of waiting
+        if (back_.use_count() != 1) {
+            back_ = std::make_shared<PositionSnapshot>();
+            back_->owners = config_.max_owners;
+            back_->instruments = config_.max_instruments;
+        }
+
+        uint64_t sequence = fills_applied_.load(std::memory_order_relaxed);
+        back_->sequence = sequence;
+        back_->positions.assign(positions_.begin(), positions_.end());
+        back_->marks.assign(marks_.begin(), marks_.end());
+
+        {
+            std::lock_guard<std::mutex> lock(publish_mutex_);
+            std::swap(published_, back_);
+        }
+
+        fills_published_.store(sequence, std::memory_order_release);
+        snapshots_published_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+} // namespace OrderBook
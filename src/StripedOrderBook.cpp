@@ -0,0 +1,201 @@
+/**
+ * @file StripedOrderBook.cpp
+ * @brief StripedOrderBook implementation
+ */
+
+#include "StripedOrderBook.h"
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+
+namespace OrderBook {
+
+    StripedOrderBook::StripedOrderBook(const std::string& symbol, uint64_t min_price, uint64_t max_price)
+        : symbol_(symbol)
+        , min_price_(min_price)
+        , bids_(max_price >= min_price ? max_price - min_price + 1 : 0)
+        , asks_(bids_.size())
+        , bid_hint_(-1)
+        , ask_hint_(static_cast<int64_t>(bids_.size()))
+        , order_count_(0)
+        , trade_count_(0)
+        , total_volume_(0)
+        , escalations_(0)
+    {
+    }
+
+    bool StripedOrderBook::submitOrder(std::shared_ptr<Order> order) {
+        if (!order || order->getPrice() < min_price_) return false;
+        int64_t index = static_cast<int64_t>(order->getPrice() - min_price_);
+        if (index >= ladderSize()) return false;
+
+        {
+            std::shared_lock<RWSpinLock> shared(structure_lock_);
+            if (!crosses(order->getSide(), index)) {
+                if (!rest(order, index)) return false;
+
+                // Re-check now that this order is visible: a concurrent add on
+                // the other side either sees us or is seen here
+                if (!crosses(order->getSide(), index)) return true;
+                unrest(order->getId());
+            }
+        }
+
+        escalations_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<RWSpinLock> exclusive(structure_lock_);
+        return submitExclusive(order, index);
+    }
+
+    bool StripedOrderBook::cancelOrder(Order::OrderID order_id) {
+        std::shared_lock<RWSpinLock> shared(structure_lock_);
+        return unrest(order_id) != nullptr;
+    }
+
+    uint64_t StripedOrderBook::getBestBid() const {
+        int64_t index = bestBidIndex();
+        return index < 0 ? 0 : min_price_ + index;
+    }
+
+    uint64_t StripedOrderBook::getBestAsk() const {
+        int64_t index = bestAskIndex();
+        return index >= ladderSize() ? 0 : min_price_ + index;
+    }
+
+    std::pair<std::vector<std::pair<uint64_t, uint64_t>>,
+              std::vector<std::pair<uint64_t, uint64_t>>>
+    StripedOrderBook::getMarketDepth(size_t levels) const {
+        std::shared_lock<RWSpinLock> shared(structure_lock_);
+
+        std::vector<std::pair<uint64_t, uint64_t>> bid_levels;
+        std::vector<std::pair<uint64_t, uint64_t>> ask_levels;
+
+        for (int64_t i = bestBidIndex(); i >= 0 && bid_levels.size() < levels; --i) {
+            uint64_t quantity = bids_[i].total_quantity.load(std::memory_order_relaxed);
+            if (quantity > 0) bid_levels.emplace_back(min_price_ + i, quantity);
+        }
+        for (int64_t i = bestAskIndex(); i < ladderSize() && ask_levels.size() < levels; ++i) {
+            uint64_t quantity = asks_[i].total_quantity.load(std::memory_order_relaxed);
+            if (quantity > 0) ask_levels.emplace_back(min_price_ + i, quantity);
+        }
+
+        return {std::move(bid_levels), std::move(ask_levels)};
+    }
+
+    bool StripedOrderBook::crosses(OrderSide side, int64_t index) const {
+        // Sequentially consistent loads pair with the stores in rest()
+        if (side == OrderSide::BUY) {
+            for (int64_t i = std::max<int64_t>(ask_hint_.load(), 0); i <= index; ++i) {
+                if (asks_[i].order_count.load() > 0) return true;
+            }
+        } else {
+            for (int64_t i = std::min(bid_hint_.load(), ladderSize() - 1); i >= index; --i) {
+                if (bids_[i].order_count.load() > 0) return true;
+            }
+        }
+        return false;
+    }
+
+    int64_t StripedOrderBook::bestBidIndex() const {
+        int64_t i = bid_hint_.load(std::memory_order_acquire);
+        while (i >= 0 && bids_[i].order_count.load(std::memory_order_acquire) == 0) --i;
+        return i;
+    }
+
+    int64_t StripedOrderBook::bestAskIndex() const {
+        int64_t i = ask_hint_.load(std::memory_order_acquire);
+        while (i < ladderSize() && asks_[i].order_count.load(std::memory_order_acquire) == 0) ++i;
+        return i;
+    }
+
+    bool StripedOrderBook::rest(const std::shared_ptr<Order>& order, int64_t index) {
+        bool buy = order->getSide() == OrderSide::BUY;
+        Level& level = buy ? bids_[index] : asks_[index];
+
+        // Stripe then level, held together so a racing cancel finds both or neither
+        OrderStripe& stripe = stripeFor(order->getId());
+        {
+            std::lock_guard<SpinLock> stripe_guard(stripe.lock);
+            if (!stripe.orders.emplace(order->getId(), order).second) return false;
+
+            std::lock_guard<SpinLock> level_guard(level.lock);
+            level.orders.push_back(order);
+            level.total_quantity.fetch_add(order->getRemainingQuantity(), std::memory_order_relaxed);
+            level.order_count.fetch_add(1);
+        }
+        order_count_.fetch_add(1, std::memory_order_relaxed);
+
+        // Hints only ever widen here; the exclusive path tightens them
+        std::atomic<int64_t>& hint = buy ? bid_hint_ : ask_hint_;
+        int64_t current = hint.load();
+        while (buy ? current < index : current > index) {
+            if (hint.compare_exchange_weak(current, index)) break;
+        }
+        return true;
+    }
+
+    std::shared_ptr<Order> StripedOrderBook::unrest(Order::OrderID order_id) {
+        OrderStripe& stripe = stripeFor(order_id);
+        std::lock_guard<SpinLock> stripe_guard(stripe.lock);
+
+        auto it = stripe.orders.find(order_id);
+        if (it == stripe.orders.end()) return nullptr;
+        std::shared_ptr<Order> order = std::move(it->second);
+        stripe.orders.erase(it);
+
+        int64_t index = static_cast<int64_t>(order->getPrice() - min_price_);
+        Level& level = (order->getSide() == OrderSide::BUY) ? bids_[index] : asks_[index];
+        {
+            std::lock_guard<SpinLock> level_guard(level.lock);
+            auto pos = std::find(level.orders.begin(), level.orders.end(), order);
+            if (pos != level.orders.end()) {
+                level.orders.erase(pos);
+                level.total_quantity.fetch_sub(order->getRemainingQuantity(), std::memory_order_relaxed);
+                level.order_count.fetch_sub(1);
+            }
+        }
+        order_count_.fetch_sub(1, std::memory_order_relaxed);
+        return order;
+    }
+
+    bool StripedOrderBook::submitExclusive(const std::shared_ptr<Order>& order, int64_t index) {
+        // Nothing else runs: level and stripe locks are uncontended from here on
+        OrderStripe& own_stripe = stripeFor(order->getId());
+        if (own_stripe.orders.count(order->getId())) return false;
+
+        bool buy = order->getSide() == OrderSide::BUY;
+        int64_t i = buy ? bestAskIndex() : bestBidIndex();
+        while (!order->isFilled() && (buy ? i <= index : i >= index) && i >= 0 && i < ladderSize()) {
+            Level& level = buy ? asks_[i] : bids_[i];
+            size_t consumed = 0;
+            while (!order->isFilled() && consumed < level.orders.size()) {
+                const auto& resting = level.orders[consumed];
+                uint64_t quantity = std::min(order->getRemainingQuantity(), resting->getRemainingQuantity());
+                order->reduceQuantity(quantity);
+                resting->reduceQuantity(quantity);
+                level.total_quantity.fetch_sub(quantity, std::memory_order_relaxed);
+                trade_count_.fetch_add(1, std::memory_order_relaxed);
+                total_volume_.fetch_add(quantity, std::memory_order_relaxed);
+
+                if (resting->isFilled()) {
+                    stripeFor(resting->getId()).orders.erase(resting->getId());
+                    consumed++;
+                }
+            }
+            if (consumed > 0) {
+                level.orders.erase(level.orders.begin(), level.orders.begin() + consumed);
+                level.order_count.fetch_sub(static_cast<uint32_t>(consumed));
+                order_count_.fetch_sub(consumed, std::memory_order_relaxed);
+            }
+            i += buy ? 1 : -1;
+        }
+
+        if (!order->isFilled()) {
+            rest(order, index);
+        }
+
+        bid_hint_.store(bestBidIndex());
+        ask_hint_.store(bestAskIndex());
+        return true;
+    }
+
+} // namespace OrderBook
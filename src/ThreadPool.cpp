@@ -12,9 +12,31 @@
 namespace OrderBook {
 
     ThreadPool::ThreadPool(size_t num_threads) 
-        : stop_(false)
+        : ThreadPool(num_threads, nullptr)
+    {
+    }
+
+    ThreadPool::ThreadPool(const ElasticConfig& config)
+        : ThreadPool(std::max<size_t>(config.min_workers, 1), &config)
+    {
+    }
+
+    ThreadPool::ThreadPool(size_t num_threads, const ElasticConfig* elastic)
+        : live_workers_(0)
+        , idle_workers_(0)
+        , pending_(0)
+        , next_sequence_(0)
+        , lane_policy_(LanePolicy::STRICT)
+        , stop_(false)
+        , queue_capacity_(0)
         , tasks_completed_(0)
         , tasks_submitted_(0)
+        , elastic_(elastic != nullptr)
+        , last_dequeue_(Clock::now())
+        , last_queue_delay_ns_(0)
+        , last_grow_(last_dequeue_)
+        , grow_count_(0)
+        , shrink_count_(0)
     {
         if (num_threads == 0) {
             num_threads = std::thread::hardware_concurrency();
@@ -23,10 +45,21 @@ namespace OrderBook {
             }
         }
         
-        workers_.reserve(num_threads);
+        if (elastic_) {
+            elastic_config_ = *elastic;
+            elastic_config_.min_workers = num_threads;
+            elastic_config_.max_workers = std::max(elastic->max_workers, num_threads);
+        }
         
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back(&ThreadPool::worker, this);
+        // Default to a backlog of 1024 tasks per worker before reporting full
+        size_t max_workers = elastic_ ? elastic_config_.max_workers : num_threads;
+        queue_capacity_.store(max_workers * 1024);
+        
+        workers_.reserve(max_workers);
+        addWorkersLocked(num_threads);
+        
+        if (elastic_) {
+            supervisor_ = std::thread(&ThreadPool::supervisor, this);
         }
     }
 
@@ -34,26 +67,136 @@ namespace OrderBook {
         stop();
     }
 
+    void ThreadPool::addWorkersLocked(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            workers_.emplace_back(&ThreadPool::worker, this);
+            live_workers_.fetch_add(1);
+        }
+    }
+
+    std::vector<ResizeEvent> ThreadPool::getResizeEvents() const {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return resize_events_;
+    }
+
+    void ThreadPool::recordResizeLocked(size_t from, size_t to, uint64_t trigger_ns) {
+        if (to > from) grow_count_++; else shrink_count_++;
+        if (resize_events_.size() >= kMaxResizeEvents) {
+            resize_events_.erase(resize_events_.begin());
+        }
+        resize_events_.push_back(ResizeEvent{Clock::now(), from, to, trigger_ns});
+    }
+
+    void ThreadPool::supervisor() {
+        const uint64_t target_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            elastic_config_.target_queue_delay).count();
+        
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        while (!stop_.load()) {
+            supervisor_condition_.wait_for(lock, elastic_config_.sample_interval);
+            if (stop_.load()) break;
+            
+            // Reap workers that retired since the last pass
+            std::vector<std::thread> exited;
+            for (auto id : retired_) {
+                auto it = std::find_if(workers_.begin(), workers_.end(),
+                                       [id](const std::thread& t) { return t.get_id() == id; });
+                if (it != workers_.end()) {
+                    exited.push_back(std::move(*it));
+                    workers_.erase(it);
+                }
+            }
+            retired_.clear();
+            
+            // Grow when work is waiting, nobody is idle, and it has waited too long
+            auto now = Clock::now();
+            size_t live = live_workers_.load();
+            if (pending_ > 0 && idle_workers_ == 0 && live < elastic_config_.max_workers &&
+                now - last_grow_ >= elastic_config_.target_queue_delay) {
+                uint64_t waiting_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_dequeue_).count();
+                uint64_t delay_ns = std::max(waiting_ns, last_queue_delay_ns_);
+                if (delay_ns > target_ns) {
+                    addWorkersLocked(1);
+                    recordResizeLocked(live, live + 1, delay_ns);
+                    last_grow_ = now;
+                }
+            }
+            
+            if (!exited.empty()) {
+                lock.unlock();
+                for (auto& thread : exited) {
+                    thread.join();
+                }
+                lock.lock();
+            }
+        }
+    }
+
     size_t ThreadPool::getPendingTaskCount() const {
         std::lock_guard<std::mutex> lock(queue_mutex_);
-        return tasks_.size();
+        return pending_;
+    }
+
+    void ThreadPool::setLanePolicy(LanePolicy policy, std::array<uint32_t, 3> weights) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        lane_policy_ = policy;
+        for (size_t i = 0; i < kLaneCount; ++i) {
+            lanes_[i].weight = std::max<uint32_t>(weights[i], 1);
+            lanes_[i].credit = 0;
+        }
+    }
+
+    LaneStats ThreadPool::getLaneStats(TaskPriority priority) const {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        const Lane& lane = lanes_[static_cast<size_t>(priority)];
+        LaneStats stats = lane.stats;
+        stats.pending = lane.heap.size();
+        return stats;
+    }
+
+    void ThreadPool::resetLaneStats() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        for (auto& lane : lanes_) {
+            lane.stats = LaneStats();
+        }
     }
 
     void ThreadPool::stop() {
+        std::vector<std::thread> workers;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             stop_.store(true);
         }
         
         condition_.notify_all();
+        supervisor_condition_.notify_all();
+        if (supervisor_.joinable()) {
+            supervisor_.join();
+        }
         
-        for (auto& worker : workers_) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            workers.swap(workers_);
+        }
+        for (auto& worker : workers) {
             if (worker.joinable()) {
                 worker.join();
             }
         }
     }
 
+    void ThreadPool::notifyWorkers(size_t task_count) {
+        // Waking more workers than tasks only adds contention on the queue
+        // live_workers_, not workers_: the elastic supervisor resizes workers_ concurrently
+        if (task_count >= live_workers_.load()) {
+            condition_.notify_all();
+        } else {
+            for (size_t i = 0; i < task_count; ++i) {
+                condition_.notify_one();
+            }
+        }
+    }
+
     void ThreadPool::waitForAll() {
         while (getPendingTaskCount() > 0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -63,30 +206,140 @@ namespace OrderBook {
     std::string ThreadPool::getStats() const {
         std::ostringstream oss;
         oss << "ThreadPool Statistics:\n";
-        oss << "  Worker Threads: " << workers_.size() << "\n";
+        oss << "  Worker Threads: " << live_workers_.load() << "\n";
+        if (elastic_) {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            oss << "  Elastic: " << elastic_config_.min_workers << "-" << elastic_config_.max_workers
+                << " workers, grew " << grow_count_ << " times, shrank " << shrink_count_ << " times\n";
+        }
         oss << "  Tasks Submitted: " << tasks_submitted_.load() << "\n";
         oss << "  Tasks Completed: " << tasks_completed_.load() << "\n";
         oss << "  Pending Tasks: " << getPendingTaskCount() << "\n";
         oss << "  Stopped: " << (stop_.load() ? "Yes" : "No") << "\n";
+        MemoryUsage queues = queue_memory_.usage();
+        oss << "  Task Queue Memory: " << std::fixed << std::setprecision(1) << (queues.live_bytes / 1024.0)
+            << " KB live, " << (queues.peak_bytes / 1024.0) << " KB peak\n";
+        
+        static const char* lane_names[kLaneCount] = {"Critical", "Normal", "Bulk"};
+        for (size_t i = 0; i < kLaneCount; ++i) {
+            LaneStats stats = getLaneStats(static_cast<TaskPriority>(i));
+            if (stats.executed == 0) continue;
+            oss << "  " << lane_names[i] << " Lane: " << stats.executed << " tasks, queue delay p50 "
+                << std::fixed << std::setprecision(0) << stats.queue_delay.percentile(0.50)
+                << " ns, p99 " << stats.queue_delay.percentile(0.99)
+                << " ns, max " << stats.queue_delay.max << " ns, "
+                << stats.deadline_misses << " deadline misses\n";
+        }
         return oss.str();
     }
 
+    MemoryStats ThreadPool::getMemoryStats() const {
+        MemoryStats stats;
+        stats[MemoryCategory::TASK_QUEUES] = queue_memory_.usage();
+        return stats;
+    }
+
+    bool ThreadPool::runsLater(const QueuedTask& lhs, const QueuedTask& rhs) {
+        // Max-heap comparator yielding earliest deadline first, then enqueue order
+        if (lhs.deadline != rhs.deadline) return lhs.deadline > rhs.deadline;
+        return lhs.sequence > rhs.sequence;
+    }
+
+    void ThreadPool::enqueueLocked(const TaskOptions& options, std::function<void()> func) {
+        Lane& lane = lanes_[static_cast<size_t>(options.priority)];
+        size_t capacity = lane.heap.capacity();
+        lane.heap.push_back(QueuedTask{options.deadline, next_sequence_++, Clock::now(), std::move(func)});
+        if (lane.heap.capacity() != capacity) {
+            size_t bytes = 0;
+            for (const Lane& each : lanes_) {
+                bytes += each.heap.capacity() * sizeof(QueuedTask);
+            }
+            queue_memory_.set(bytes);
+        }
+        std::push_heap(lane.heap.begin(), lane.heap.end(), runsLater);
+        pending_++;
+    }
+
+    std::function<void()> ThreadPool::dequeueLocked() {
+        size_t chosen = kLaneCount;
+        
+        if (lane_policy_ == LanePolicy::STRICT) {
+            for (size_t i = 0; i < kLaneCount && chosen == kLaneCount; ++i) {
+                if (!lanes_[i].heap.empty()) chosen = i;
+            }
+        } else {
+            // Smooth weighted round robin over the non-empty lanes
+            int64_t total_weight = 0;
+            for (size_t i = 0; i < kLaneCount; ++i) {
+                if (lanes_[i].heap.empty()) continue;
+                lanes_[i].credit += lanes_[i].weight;
+                total_weight += lanes_[i].weight;
+                if (chosen == kLaneCount || lanes_[i].credit > lanes_[chosen].credit) {
+                    chosen = i;
+                }
+            }
+            lanes_[chosen].credit -= total_weight;
+        }
+        
+        Lane& lane = lanes_[chosen];
+        std::pop_heap(lane.heap.begin(), lane.heap.end(), runsLater);
+        QueuedTask task = std::move(lane.heap.back());
+        lane.heap.pop_back();
+        pending_--;
+        
+        auto now = Clock::now();
+        uint64_t delay_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - task.enqueued).count();
+        lane.stats.queue_delay.record(delay_ns);
+        last_dequeue_ = now;
+        last_queue_delay_ns_ = delay_ns;
+        lane.stats.executed++;
+        if (now > task.deadline) {
+            lane.stats.deadline_misses++;
+        }
+        
+        return std::move(task.func);
+    }
+
     void ThreadPool::worker() {
         while (true) {
             std::function<void()> task;
+            size_t pending = 0;
             
             {
                 std::unique_lock<std::mutex> lock(queue_mutex_);
-                condition_.wait(lock, [this] { return stop_.load() || !tasks_.empty(); });
+                auto ready = [this] { return stop_.load() || pending_ > 0; };
+                
+                idle_workers_++;
+                bool woken = true;
+                if (elastic_) {
+                    woken = condition_.wait_for(lock, elastic_config_.idle_timeout, ready);
+                } else {
+                    condition_.wait(lock, ready);
+                }
+                idle_workers_--;
+                
+                if (!woken) {
+                    // Idle timeout: retire unless already at the floor
+                    size_t live = live_workers_.load();
+                    if (live > elastic_config_.min_workers) {
+                        live_workers_.fetch_sub(1);
+                        retired_.push_back(std::this_thread::get_id());
+                        recordResizeLocked(live, live - 1, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            elastic_config_.idle_timeout).count());
+                        return;
+                    }
+                    continue;
+                }
                 
-                if (stop_.load() && tasks_.empty()) {
+                if (stop_.load() && pending_ == 0) {
                     return;
                 }
                 
-                task = std::move(tasks_.front());
-                tasks_.pop();
+                task = dequeueLocked();
+                pending = pending_;
             }
             
+            OB_PROBE1(task_start, pending);
             try {
                 task();
                 tasks_completed_.fetch_add(1);
@@ -94,6 +347,7 @@ namespace OrderBook {
                 // Log error but continue processing
                 std::cerr << "ThreadPool task error: " << e.what() << std::endl;
             }
+            OB_PROBE0(task_end);
         }
     }
 
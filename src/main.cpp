@@ -13,8 +13,21 @@
 #include "ThreadPool.h"
 #include "PerformanceMonitor.h"
 #include "Order.h"
+#include "FuzzHarness.h"
+#include "JitterMonitor.h"
+#include "OrderPool.h"
+#include "PositionKeeper.h"
+#include "StripedOrderBook.h"
+#include "EpochManager.h"
+#include "BTreePriceIndex.h"
+#include "TieredPriceIndex.h"
+#include "OrderJournal.h"
+#include "SharedMemory.h"
+#include "JournalCodec.h"
+#include "EventArchive.h"
 #include <iostream>
 #include <random>
+#include <array>
 #include <chrono>
 #include <vector>
 #include <thread>
@@ -22,6 +35,17 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <unordered_map>
+#include <memory_resource>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace OrderBook;
 
@@ -40,6 +64,26 @@ struct SimulationConfig {
     bool enable_performance_monitoring = true; ///< Enable performance monitoring
     std::string symbol = "AAPL";          ///< Trading symbol
     size_t batch_size = 100;              ///< Batch size for processing
+    uint64_t seed = 0;                    ///< RNG seed for reproducible runs (0 = random)
+    bool warmup = false;                  ///< Warm the engine up before live flow
+    uint64_t soak_seconds = 0;            ///< Soak run length (0 = run --orders orders)
+    size_t memory_budget = 65536;         ///< Trades/samples kept in memory during soak
+    size_t max_resting_orders = 100000;   ///< Resting order budget during soak
+    std::vector<int> cores;               ///< Cores for jitter measurement (empty = all)
+    uint64_t duration_ms = 1000;          ///< Jitter measurement time per core
+    uint32_t num_owners = 64;             ///< Accounts orders are spread over for --positions
+    bool lazy_cancel = false;             ///< Tombstone cancels in the book
+    size_t failover_at = 0;               ///< Inputs before the --standby primary fails (0 = 3/4)
+    size_t num_shards = 4;                ///< Engine processes for --shards
+    uint32_t num_instruments = 16;        ///< Instruments spread over the shards
+    size_t scale_max_orders = 1000000;    ///< Largest book for --scaling-bench
+    size_t scale_levels = 0;              ///< Levels per side for --scaling-bench (0 = from depth)
+    size_t scale_queue_depth = 16;        ///< Orders per level for --scaling-bench
+    std::vector<int> reader_counts = {0, 1, 4, 16};      ///< Reader thread counts for --reader-bench
+    uint64_t read_rate = 0;                              ///< Reads/s per reader (0 = unthrottled)
+    std::array<uint32_t, 3> read_mix = {1, 1, 1};        ///< Depth:top:lookup read weights
+    uint32_t tier_window = TieredPriceIndex<PriceLevel>::kDefaultWindow; ///< Dense tier width for --tier-bench
+    std::string archive_dir;              ///< Event archive directory (empty = no archive; lookups use ./archive)
 };
 
 /**
@@ -55,7 +99,29 @@ public:
         , quantity_dist_(config.min_quantity, config.max_quantity)
         , side_dist_(0, 1)
         , order_id_counter_(1)
+        , pool_(nullptr)
+        , owner_count_(0)
     {
+        if (config.seed != 0) {
+            rng_.seed(config.seed);
+        }
+    }
+
+    /**
+     * @brief Allocate generated orders from a recycling pool
+     * @param pool Pool to use, nullptr for the default heap
+     */
+    void setOrderPool(OrderPool* pool) { pool_ = pool; }
+
+    /**
+     * @brief Spread generated orders over a number of owners
+     * @param owners Owner count, 0 leaves every order with owner 0
+     */
+    void setOwnerCount(uint32_t owners) {
+        owner_count_ = owners;
+        if (owners > 0) {
+            owner_dist_ = std::uniform_int_distribution<uint32_t>(0, owners - 1);
+        }
     }
 
     /**
@@ -85,9 +151,13 @@ public:
         OrderSide side = (side_dist_(rng_) == 0) ? OrderSide::BUY : OrderSide::SELL;
         
         auto now = std::chrono::high_resolution_clock::now();
-        auto order = std::make_shared<Order>(
-            order_id_counter_++, side, price, quantity, now
-        );
+        auto order = pool_
+            ? pool_->create(order_id_counter_++, side, price, quantity, now)
+            : std::make_shared<Order>(order_id_counter_++, side, price, quantity, now);
+        
+        if (owner_count_ > 0) {
+            order->setOwner(owner_dist_(rng_));
+        }
         
         return order;
     }
@@ -142,36 +212,145 @@ private:
     std::uniform_int_distribution<uint64_t> quantity_dist_;
     std::uniform_int_distribution<int> side_dist_;
     std::atomic<uint64_t> order_id_counter_;
+    OrderPool* pool_;
+    uint32_t owner_count_;
+    std::uniform_int_distribution<uint32_t> owner_dist_;
 };
 
+/**
+ * @brief Submit one order under TIME_OPERATION and time the whole call
+ * @param latency_ns Set to the submission latency, monitor overhead included
+ * @return Whether the engine accepted the order
+ */
+bool submitTimed(MatchingEngine& engine, PerformanceMonitor& monitor,
+                 const std::shared_ptr<Order>& order, uint64_t& latency_ns) {
+    auto start = std::chrono::high_resolution_clock::now();
+    bool accepted;
+    {
+        TIME_OPERATION(monitor, "order_submission", order->getId());
+        accepted = engine.submitOrder(order);
+    }
+    latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    return accepted;
+}
+
+/**
+ * @brief Submit orders one at a time and record each submission latency
+ * @return Per-order latencies in nanoseconds
+ */
+std::vector<uint64_t> timeFirstOrders(MatchingEngine& engine, PerformanceMonitor& monitor,
+                                      const std::vector<std::shared_ptr<Order>>& orders,
+                                      size_t count) {
+    std::vector<uint64_t> latencies;
+    latencies.reserve(count);
+    
+    for (size_t i = 0; i < count && i < orders.size(); ++i) {
+        uint64_t latency_ns;
+        submitTimed(engine, monitor, orders[i], latency_ns);
+        latencies.push_back(latency_ns);
+    }
+    
+    return latencies;
+}
+
+/**
+ * @brief Print first-order and early-flow latency figures
+ */
+void printFirstOrderLatency(const std::string& label, const std::vector<uint64_t>& latencies) {
+    if (latencies.empty()) return;
+    
+    auto mean_of_first = [&latencies](size_t n) {
+        n = std::min(n, latencies.size());
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += latencies[i];
+        return static_cast<double>(sum) / n;
+    };
+    
+    std::cout << label << " First Order Latency: " << latencies.front() << " ns" << std::endl;
+    std::cout << label << " First 100 Orders Mean: " << std::fixed << std::setprecision(2)
+              << mean_of_first(100) << " ns" << std::endl;
+    std::cout << label << " First 1000 Orders Mean: " << mean_of_first(1000) << " ns" << std::endl;
+}
+
 /**
  * @brief Benchmark different data structure implementations
  */
-void runBenchmark() {
+void runBenchmark(const SimulationConfig& sim_config) {
     std::cout << "\n=== Running Benchmark Tests ===" << std::endl;
     
     SimulationConfig config;
     config.num_orders = 50000;
     config.num_threads = 4;
     
+    const size_t first_orders = 1000;
+    
     PerformanceMonitor monitor(true);
     MatchingEngine engine(config.symbol);
-    engine.setCSVLogging(true, "benchmark_trades.csv");
+    engine.setLazyCancel(sim_config.lazy_cancel);
+    if (sim_config.enable_csv_logging) {
+        engine.setCSVLogging(true, "benchmark_trades.csv");
+    }
     
     OrderGenerator generator(config);
     
     std::cout << "Generating " << config.num_orders << " orders..." << std::endl;
     auto orders = generator.generateBatch(config.num_orders);
     
+    if (sim_config.warmup) {
+        // Cold-start reference: the same opening flow on a fresh engine and
+        // monitor, timed the same way and logging to CSV exactly when the
+        // warm engine does. Its log goes to a scratch file, removed after.
+        std::vector<std::shared_ptr<Order>> cold_orders;
+        for (size_t i = 0; i < first_orders && i < orders.size(); ++i) {
+            cold_orders.push_back(std::make_shared<Order>(*orders[i]));
+        }
+        std::filesystem::path cold_csv = std::filesystem::temp_directory_path() /
+                                         ("benchmark_cold_trades_" + std::to_string(getpid()) + ".csv");
+        std::vector<uint64_t> cold_latencies;
+        {
+            PerformanceMonitor cold_monitor(true);
+            MatchingEngine cold_engine(config.symbol);
+            cold_engine.setLazyCancel(sim_config.lazy_cancel);
+            if (sim_config.enable_csv_logging) {
+                cold_engine.setCSVLogging(true, cold_csv.string());
+            }
+            cold_latencies = timeFirstOrders(cold_engine, cold_monitor, cold_orders, first_orders);
+        }
+        std::filesystem::remove(cold_csv);
+        
+        std::cout << "Warming up engine..." << std::endl;
+        WarmupConfig warmup_config;
+        warmup_config.mid_price = config.base_price;
+        warmup_config.price_range = config.price_range;
+        warmup_config.reserve_orders = config.num_orders;
+        warmup_config.reserve_trades = config.num_orders;
+        
+        auto warmup_start = std::chrono::high_resolution_clock::now();
+        engine.warmup(warmup_config);
+        monitor.reserve("order_submission", config.num_orders);
+        auto warmup_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - warmup_start).count();
+        
+        std::cout << "Warmup Time: " << warmup_time << " microseconds" << std::endl;
+        printFirstOrderLatency("Cold", cold_latencies);
+    }
+    
     std::cout << "Processing orders..." << std::endl;
     auto start_time = std::chrono::high_resolution_clock::now();
     
+    std::vector<uint64_t> first_latencies;
+    first_latencies.reserve(first_orders);
+    
     size_t processed = 0;
     for (const auto& order : orders) {
-        TIME_OPERATION(monitor, "order_submission", order->getId());
-        if (engine.submitOrder(order)) {
+        uint64_t latency_ns;
+        if (submitTimed(engine, monitor, order, latency_ns)) {
             processed++;
         }
+        if (first_latencies.size() < first_orders) {
+            first_latencies.push_back(latency_ns);
+        }
     }
     
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -183,6 +362,7 @@ void runBenchmark() {
     std::cout << "Total Time: " << total_time << " microseconds" << std::endl;
     std::cout << "Throughput: " << (processed * 1000000.0 / total_time) 
               << " orders/second" << std::endl;
+    printFirstOrderLatency(sim_config.warmup ? "Warm" : "Cold", first_latencies);
     
     monitor.printStats();
     std::cout << engine.getMarketStats() << std::endl;
@@ -206,6 +386,25 @@ void runMultiThreadedSimulation(const SimulationConfig& config) {
         engine.setCSVLogging(true, "simulation_trades.csv");
     }
     
+    std::unique_ptr<EventArchiveWriter> archive;
+    if (!config.archive_dir.empty()) {
+        ArchiveConfig archive_config;
+        archive_config.directory = config.archive_dir;
+        archive = std::make_unique<EventArchiveWriter>(archive_config);
+        engine.setArchive(archive.get());
+    }
+    
+    if (config.warmup) {
+        std::cout << "Warming up engine..." << std::endl;
+        WarmupConfig warmup_config;
+        warmup_config.mid_price = config.base_price;
+        warmup_config.price_range = config.price_range;
+        warmup_config.reserve_orders = config.num_orders;
+        warmup_config.reserve_trades = config.num_orders;
+        engine.warmup(warmup_config);
+        monitor.reserve("order_submission", config.num_orders);
+    }
+    
     OrderGenerator generator(config);
     
     // Generate orders
@@ -217,18 +416,18 @@ void runMultiThreadedSimulation(const SimulationConfig& config) {
     auto start_time = std::chrono::high_resolution_clock::now();
     
     std::atomic<size_t> processed_count(0);
-    std::vector<std::future<size_t>> futures;
     
-    // Submit batches to thread pool
+    // Split into [begin, end) batches and enqueue them in one go
+    std::vector<std::pair<size_t, size_t>> batches;
     for (size_t i = 0; i < orders.size(); i += config.batch_size) {
-        size_t batch_end = std::min(i + config.batch_size, orders.size());
-        std::vector<std::shared_ptr<Order>> batch(
-            orders.begin() + i, orders.begin() + batch_end
-        );
-        
-        auto future = thread_pool.submit([&engine, &monitor, &processed_count, batch]() {
+        batches.emplace_back(i, std::min(i + config.batch_size, orders.size()));
+    }
+    
+    auto futures = thread_pool.submitBulk(batches,
+        [&engine, &monitor, &processed_count, &orders](const std::pair<size_t, size_t>& batch) {
             size_t batch_processed = 0;
-            for (const auto& order : batch) {
+            for (size_t i = batch.first; i < batch.second; ++i) {
+                const auto& order = orders[i];
                 TIME_OPERATION(monitor, "order_submission", order->getId());
                 if (engine.submitOrder(order)) {
                     batch_processed++;
@@ -237,9 +436,6 @@ void runMultiThreadedSimulation(const SimulationConfig& config) {
             }
             return batch_processed;
         });
-        
-        futures.push_back(std::move(future));
-    }
     
     // Wait for all batches to complete
     size_t total_processed = 0;
@@ -264,6 +460,13 @@ void runMultiThreadedSimulation(const SimulationConfig& config) {
     
     std::cout << engine.getMarketStats() << std::endl;
     std::cout << thread_pool.getStats() << std::endl;
+    
+    if (archive) {
+        engine.setArchive(nullptr);
+        archive->close();
+        std::cout << "Archived " << archive->getEventCount() << " events and " << archive->getTradeCount()
+                  << " trades to " << config.archive_dir << "/" << std::endl;
+    }
 }
 
 /**
@@ -314,39 +517,2772 @@ void runAggressiveSimulation(const SimulationConfig& config) {
 }
 
 /**
- * @brief Print usage information
+ * @brief Differentially fuzz the matching engine against the reference book
+ * @return true if no divergence was found
  */
-void printUsage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " [OPTIONS]" << std::endl;
-    std::cout << "Options:" << std::endl;
-    std::cout << "  --benchmark          Run benchmark tests" << std::endl;
-    std::cout << "  --aggressive         Run aggressive order simulation" << std::endl;
-    std::cout << "  --orders N           Number of orders (default: 100000)" << std::endl;
-    std::cout << "  --threads N          Number of threads (default: 4)" << std::endl;
-    std::cout << "  --symbol SYMBOL      Trading symbol (default: AAPL)" << std::endl;
-    std::cout << "  --no-csv             Disable CSV logging" << std::endl;
-    std::cout << "  --no-perf            Disable performance monitoring" << std::endl;
-    std::cout << "  --help               Show this help message" << std::endl;
+bool runFuzz(const SimulationConfig& config) {
+    std::cout << "\n=== Differential Fuzzing ===" << std::endl;
+    
+    FuzzConfig fuzz_config;
+    fuzz_config.seed = config.seed != 0 ? config.seed : std::random_device{}();
+    fuzz_config.num_commands = config.num_orders;
+    fuzz_config.lazy_cancel = config.lazy_cancel;
+    
+    std::cout << "Seed: " << fuzz_config.seed << std::endl;
+    std::cout << "Commands: " << fuzz_config.num_commands << std::endl;
+    
+    DifferentialFuzzer fuzzer(fuzz_config);
+    FuzzResult result = fuzzer.run();
+    
+    std::cout << "\nFuzz Results:" << std::endl;
+    std::cout << "Episodes: " << result.episodes << std::endl;
+    std::cout << "Commands Run: " << result.commands_run << std::endl;
+    std::cout << "Trades Compared: " << result.trades_compared << std::endl;
+    std::cout << "Throughput: " << std::fixed << std::setprecision(0)
+              << (result.commands_run / std::max(result.elapsed_seconds, 1e-9))
+              << " commands/second" << std::endl;
+    
+    if (result.passed) {
+        std::cout << "No divergence found" << std::endl;
+        return true;
+    }
+    
+    std::cout << "DIVERGENCE: " << result.failure << std::endl;
+    std::cout << "Minimized reproducer (" << result.minimized.size() << " commands):" << std::endl;
+    for (const auto& cmd : result.minimized) {
+        std::cout << "  " << cmd.toString() << std::endl;
+    }
+    std::cout << "Replay: " << fuzzer.replay(result.minimized) << std::endl;
+    return false;
 }
 
 /**
- * @brief Parse command line arguments
+ * @brief Measure platform noise per core and report it next to engine latency
  */
-SimulationConfig parseArguments(int argc, char* argv[]) {
-    SimulationConfig config;
+void runJitterAnalysis(const SimulationConfig& config) {
+    std::cout << "\n=== OS Jitter Analysis ===" << std::endl;
     
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
+    JitterConfig jitter_config;
+    jitter_config.cores = config.cores;
+    jitter_config.duration_ms = config.duration_ms;
+    
+    JitterMonitor jitter(jitter_config);
+    auto reports = jitter.run();
+    jitter.printReports(reports);
+    
+    // Engine latency on the first measured core, for side-by-side reading
+    int engine_core = reports.empty() ? -1 : reports.front().core;
+    bool pinned = JitterMonitor::pinCurrentThread(engine_core);
+    
+    PerformanceMonitor monitor(false);
+    MatchingEngine engine(config.symbol);
+    engine.setConsoleLogging(false);
+    
+    OrderGenerator generator(config);
+    auto orders = generator.generateBatch(config.num_orders);
+    monitor.reserve("order_submission", orders.size());
+    
+    for (const auto& order : orders) {
+        TIME_OPERATION(monitor, "order_submission", order->getId());
+        engine.submitOrder(order);
+    }
+    
+    auto stats = monitor.getStats("order_submission");
+    std::cout << "\n=== Engine vs Platform Noise (core " << engine_core
+              << (pinned ? ", pinned" : ", unpinned") << ") ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "" << std::right
+              << std::setw(12) << "engine ns" << std::setw(12) << "gap ns" << std::endl;
+    
+    const CoreJitterReport* core_report = reports.empty() ? nullptr : &reports.front();
+    auto row = [&](const char* label, double engine_ns, uint64_t gap_ns) {
+        std::cout << std::left << std::setw(12) << label << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(12) << engine_ns
+                  << std::setw(12) << gap_ns << std::endl;
+    };
+    row("p50", stats.median_latency_ns, core_report ? core_report->gapPercentile(0.50) : 0);
+    row("p99", stats.p99_latency_ns, core_report ? core_report->gapPercentile(0.99) : 0);
+    row("p99.9", stats.p999_latency_ns, core_report ? core_report->gapPercentile(0.999) : 0);
+    row("max", static_cast<double>(stats.max_latency_ns), core_report ? core_report->max_gap_ns : 0);
+    std::cout << "Engine tail samples at or above the platform's worst gap are "
+              << "likely the box, not the engine." << std::endl;
+}
+
+/**
+ * @brief Long-running soak with every structure on a fixed memory budget
+ *
+ * Orders come from a recycling pool and are generated on the fly, trades
+ * and latency samples stream to CSV (when enabled) through bounded
+ * buffers, and the oldest orders are cancelled once the resting budget is
+ * reached. Resident set size is sampled throughout so flat memory can be
+ * demonstrated over 24-hour runs.
+ */
+void runSoak(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "\n=== Bounded-Memory Soak ===" << std::endl;
+    if (config.soak_seconds > 0) {
+        std::cout << "Duration: " << config.soak_seconds << " seconds" << std::endl;
+    } else {
+        std::cout << "Orders: " << config.num_orders << std::endl;
+    }
+    std::cout << "Memory Budget: " << config.memory_budget << " trades/samples, "
+              << config.max_resting_orders << " resting orders" << std::endl;
+    
+    // Declared first so it outlives every order it hands out
+    OrderPool pool;
+    
+    PerformanceMonitor monitor(false);
+    monitor.setSampleBudget(config.memory_budget, 
+                            config.enable_csv_logging ? "soak_latency.csv" : "");
+    
+    MatchingEngine engine(config.symbol);
+    engine.setConsoleLogging(false);
+    engine.setLazyCancel(config.lazy_cancel);
+    engine.setTradeRetention(config.memory_budget);
+    if (config.enable_csv_logging) {
+        engine.setCSVLogging(true, "soak_trades.csv");
+    }
+    
+    OrderGenerator generator(config);
+    generator.setOrderPool(&pool);
+    
+    // Ring of recently issued IDs: the order leaving the window is cancelled
+    std::vector<Order::OrderID> window(std::max<size_t>(config.max_resting_orders, 1), 0);
+    
+    const uint64_t duration_ns = config.soak_seconds * 1000000000ULL;
+    const uint64_t row_every_orders = std::max<uint64_t>(config.num_orders / 10, 1);
+    const uint64_t row_every_ns = std::max<uint64_t>(duration_ns / 20, 1000000000ULL);
+    
+    std::vector<size_t> rss_samples;
+    size_t baseline_sample = SIZE_MAX;      // First sample with a full resting window
+    auto start = Clock::now();
+    auto last_row = start;
+    uint64_t orders_done = 0;
+    uint64_t orders_at_last_row = UINT64_MAX;
+    
+    auto printRow = [&](double elapsed) {
+        orders_at_last_row = orders_done;
+        size_t rss = PerformanceMonitor::getResidentSetBytes();
+        if (baseline_sample == SIZE_MAX && orders_done >= window.size()) {
+            baseline_sample = rss_samples.size();
+        }
+        rss_samples.push_back(rss);
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(9) << elapsed
+                  << std::setw(14) << orders_done
+                  << std::setw(10) << (rss / (1024.0 * 1024.0))
+                  << std::setw(10) << engine.getOrderBook().getOrderCount()
+                  << std::setw(12) << pool.getCapacity()
+                  << std::setw(10) << engine.getTrades().size()
+                  << std::setw(14) << engine.getTradeCount() << std::endl;
+    };
+    
+    std::cout << std::setw(9) << "secs" << std::setw(14) << "orders" << std::setw(10) << "rss MB"
+              << std::setw(10) << "resting" << std::setw(12) << "pool slots"
+              << std::setw(10) << "trades" << std::setw(14) << "total trades" << std::endl;
+    
+    while (true) {
+        if (duration_ns == 0 && orders_done >= config.num_orders) break;
         
-        if (arg == "--help") {
-            printUsage(argv[0]);
-            exit(0);
-        } else if (arg == "--benchmark") {
-            runBenchmark();
-            exit(0);
-        } else if (arg == "--aggressive") {
-            runAggressiveSimulation(config);
+        size_t slot = orders_done % window.size();
+        if (orders_done >= window.size()) {
+            engine.cancelOrder(window[slot]);
+        }
+        
+        auto order = generator.generateOrder();
+        window[slot] = order->getId();
+        {
+            TIME_OPERATION(monitor, "order_submission", order->getId());
+            engine.submitOrder(order);
+        }
+        orders_done++;
+        
+        bool row_due = (duration_ns == 0) ? (orders_done % row_every_orders == 0)
+                                          : (orders_done % 4096 == 0);
+        if (row_due) {
+            auto now = Clock::now();
+            uint64_t since_start = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+            uint64_t since_row = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_row).count();
+            
+            if (duration_ns == 0 || since_row >= row_every_ns) {
+                printRow(since_start / 1e9);
+                last_row = now;
+            }
+            if (duration_ns > 0 && since_start >= duration_ns) break;
+        }
+    }
+    
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    if (orders_at_last_row != orders_done) {
+        printRow(elapsed);
+    }
+    
+    std::cout << "\nSoak Results:" << std::endl;
+    std::cout << "Orders Processed: " << orders_done << std::endl;
+    std::cout << "Throughput: " << std::fixed << std::setprecision(0) 
+              << (orders_done / std::max(elapsed, 1e-9)) << " orders/second" << std::endl;
+    
+    // Compare against the first sample taken after the resting window filled up
+    if (baseline_sample != SIZE_MAX && baseline_sample + 1 < rss_samples.size()) {
+        size_t baseline = rss_samples[baseline_sample];
+        size_t peak = *std::max_element(rss_samples.begin() + baseline_sample, rss_samples.end());
+        double growth = baseline ? 100.0 * (static_cast<double>(rss_samples.back()) - baseline) / baseline : 0.0;
+        std::cout << "RSS Baseline: " << std::setprecision(1) << (baseline / (1024.0 * 1024.0)) << " MB" << std::endl;
+        std::cout << "RSS Peak: " << (peak / (1024.0 * 1024.0)) << " MB" << std::endl;
+        std::cout << "RSS Growth After Baseline: " << std::setprecision(2) << growth << "%" 
+                  << (growth < 5.0 ? " (flat)" : " (GROWING)") << std::endl;
+    } else {
+        std::cout << "Run too short to fill the resting order window; no RSS baseline" << std::endl;
+    }
+    
+    monitor.printStats();
+    std::cout << engine.getMarketStats() << std::endl;
+}
+
+/**
+ * @brief Keep live positions across several instruments while risk reads snapshots
+ *
+ * Runs one engine and matcher thread per instrument (--threads), with orders
+ * spread over --owners accounts, while the main thread reads snapshots and
+ * checks that every one nets to zero per instrument. Then measures the keeper
+ * alone on a synthetic fill stream.
+ */
+void runPositionKeeping(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    const uint32_t instruments = static_cast<uint32_t>(std::max<size_t>(config.num_threads, 1));
+    const uint32_t owners = std::max<uint32_t>(config.num_owners, 1);
+    const size_t orders_per_instrument = config.num_orders / instruments;
+    
+    std::cout << "\n=== Position Keeping ===" << std::endl;
+    std::cout << "Instruments: " << instruments << ", Owners: " << owners
+              << ", Orders per Instrument: " << orders_per_instrument << std::endl;
+    
+    PositionKeeperConfig keeper_config;
+    keeper_config.max_owners = owners;
+    keeper_config.max_instruments = instruments;
+    PositionKeeper keeper(keeper_config);
+    
+    std::vector<std::unique_ptr<MatchingEngine>> engines;
+    for (uint32_t i = 0; i < instruments; ++i) {
+        engines.push_back(std::make_unique<MatchingEngine>(config.symbol + "." + std::to_string(i)));
+        engines.back()->setConsoleLogging(false);
+        keeper.attach(*engines.back(), i);
+    }
+    keeper.start();
+    
+    std::atomic<uint32_t> matchers_running(instruments);
+    std::vector<std::thread> matchers;
+    auto start = Clock::now();
+    
+    for (uint32_t i = 0; i < instruments; ++i) {
+        matchers.emplace_back([&, i]() {
+            SimulationConfig instrument_config = config;
+            if (config.seed != 0) instrument_config.seed = config.seed + i;
+            OrderGenerator generator(instrument_config);
+            generator.setOwnerCount(owners);
+            
+            for (size_t n = 0; n < orders_per_instrument; ++n) {
+                engines[i]->submitOrder(generator.generateOrder());
+            }
+            matchers_running.fetch_sub(1);
+        });
+    }
+    
+    // Risk reader: every snapshot must be internally consistent
+    uint64_t snapshots_read = 0, torn_snapshots = 0;
+    while (matchers_running.load() > 0) {
+        auto snapshot = keeper.snapshot();
+        for (uint32_t i = 0; i < instruments; ++i) {
+            if (snapshot->netQuantity(i) != 0) {
+                torn_snapshots++;
+                break;
+            }
+        }
+        snapshots_read++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    for (auto& matcher : matchers) {
+        matcher.join();
+    }
+    keeper.flush();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    
+    uint64_t trades = 0;
+    for (const auto& engine : engines) {
+        trades += engine->getTradeCount();
+    }
+    
+    auto snapshot = keeper.snapshot();
+    double total_pnl = 0.0;
+    std::vector<std::pair<double, uint32_t>> ranked;
+    for (uint32_t owner = 0; owner < owners; ++owner) {
+        double pnl = snapshot->totalPnl(owner);
+        total_pnl += pnl;
+        ranked.emplace_back(pnl, owner);
+    }
+    std::sort(ranked.begin(), ranked.end(), std::greater<>());
+    
+    std::cout << "Fills: " << trades << " executed, " << snapshot->sequence << " applied, "
+              << keeper.getFillsRejected() << " rejected" << std::endl;
+    std::cout << "Matching Throughput: " << std::fixed << std::setprecision(0)
+              << (trades / std::max(elapsed, 1e-9)) << " fills/second" << std::endl;
+    std::cout << "Snapshots: " << keeper.getSnapshotsPublished() << " published, "
+              << snapshots_read << " read by risk, " << torn_snapshots << " inconsistent" << std::endl;
+    
+    std::cout << "\nTop Owners by P&L (bps x qty):" << std::endl;
+    std::cout << std::setw(8) << "owner" << std::setw(16) << "total P&L";
+    for (uint32_t i = 0; i < std::min<uint32_t>(instruments, 4); ++i) {
+        std::cout << std::setw(12) << ("pos " + std::to_string(i));
+    }
+    std::cout << std::endl;
+    for (size_t r = 0; r < std::min<size_t>(ranked.size(), 5); ++r) {
+        uint32_t owner = ranked[r].second;
+        std::cout << std::setw(8) << owner << std::setw(16) << std::setprecision(1) << ranked[r].first;
+        for (uint32_t i = 0; i < std::min<uint32_t>(instruments, 4); ++i) {
+            std::cout << std::setw(12) << snapshot->at(owner, i).quantity;
+        }
+        std::cout << std::endl;
+    }
+    
+    // Every fill moves P&L between two owners at a shared mark, so the total is zero
+    bool balanced = std::abs(total_pnl) < 1e-6 * std::max(1.0, static_cast<double>(trades)) &&
+                    snapshot->sequence == trades && torn_snapshots == 0;
+    std::cout << "Net P&L Across Owners: " << std::setprecision(4) << total_pnl
+              << (balanced ? " (balanced)" : " (MISMATCH)") << std::endl;
+    
+    // Keeper alone: how many fills per second the consumer can absorb
+    PositionKeeper bench_keeper(keeper_config);
+    auto& ring = bench_keeper.addProducer();
+    bench_keeper.start();
+    
+    std::mt19937 rng(config.seed != 0 ? config.seed : 42);
+    std::uniform_int_distribution<uint32_t> owner_dist(0, owners - 1);
+    std::uniform_int_distribution<uint64_t> price_dist(config.base_price - 10, config.base_price + 10);
+    const size_t bench_fills = std::max<size_t>(config.num_orders * 10, 1000000);
+    
+    std::vector<FillEvent> fills(4096);
+    for (auto& fill : fills) {
+        uint64_t price = price_dist(rng);
+        fill = FillEvent{owner_dist(rng) % instruments, owner_dist(rng), owner_dist(rng),
+                         price, 1 + rng() % 100, price - 1, price + 1};
+    }
+    
+    auto bench_start = Clock::now();
+    for (size_t n = 0; n < bench_fills; ++n) {
+        ring.push(fills[n & (fills.size() - 1)]);
+    }
+    bench_keeper.flush();
+    double bench_elapsed = std::chrono::duration<double>(Clock::now() - bench_start).count();
+    bench_keeper.stop();
+    
+    std::cout << "Keeper Throughput: " << std::setprecision(0)
+              << (bench_fills / std::max(bench_elapsed, 1e-9)) << " fills/second ("
+              << bench_fills << " synthetic fills)" << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Compare critical-task queueing delay behind bulk work across lane policies
+ *
+ * Queues a backlog of bulk tasks with a critical task after every batch,
+ * first with everything in one FIFO lane, then with strict priority and
+ * weighted lanes, and reports how long each kind waited to start.
+ */
+void runLaneScheduling(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    const size_t bulk_tasks = std::max<size_t>(config.num_orders / 100, 100);
+    const size_t critical_tasks = std::max<size_t>(bulk_tasks / 10, 10);
+    const auto bulk_work = std::chrono::microseconds(20);
+    const auto critical_budget = std::chrono::microseconds(1000);
+    
+    std::cout << "\n=== ThreadPool Lane Scheduling ===" << std::endl;
+    std::cout << "Workers: " << config.num_threads << ", Bulk Tasks: " << bulk_tasks
+              << " x " << bulk_work.count() << " us, Critical Tasks: " << critical_tasks
+              << " (deadline " << critical_budget.count() << " us)" << std::endl;
+    
+    auto spin = [](std::chrono::nanoseconds work) {
+        auto until = Clock::now() + work;
+        while (Clock::now() < until) {}
+    };
+    
+    struct Scenario {
+        const char* name;
+        bool use_lanes;
+        LanePolicy policy;
+    };
+    const Scenario scenarios[] = {
+        {"single FIFO", false, LanePolicy::STRICT},
+        {"strict lanes", true, LanePolicy::STRICT},
+        {"weighted 8:4:1", true, LanePolicy::WEIGHTED},
+    };
+    
+    std::string lane_report;
+    std::cout << std::left << std::setw(16) << "policy" << std::right
+              << std::setw(14) << "crit p50 ns" << std::setw(14) << "crit p99 ns"
+              << std::setw(14) << "crit max ns" << std::setw(10) << "missed"
+              << std::setw(14) << "bulk p99 us" << std::endl;
+    
+    for (const auto& scenario : scenarios) {
+        ThreadPool pool(config.num_threads);
+        pool.setLanePolicy(scenario.policy);
+        
+        // Start delay measured from the submitter's side, so the FIFO run is comparable
+        std::mutex delay_mutex;
+        LatencyHistogram critical_delay, bulk_delay;
+        auto timed = [&](LatencyHistogram& histogram, Clock::time_point submitted, std::chrono::nanoseconds work) {
+            uint64_t delay = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - submitted).count();
+            {
+                std::lock_guard<std::mutex> lock(delay_mutex);
+                histogram.record(delay);
+            }
+            spin(work);
+        };
+        
+        TaskOptions bulk_options;
+        bulk_options.priority = scenario.use_lanes ? TaskPriority::BULK : TaskPriority::NORMAL;
+        
+        // One critical task lands behind every batch of bulk tasks in the backlog
+        std::vector<std::future<void>> futures;
+        const size_t bulk_per_critical = bulk_tasks / critical_tasks;
+        for (size_t i = 0; i < bulk_tasks; ++i) {
+            futures.push_back(pool.schedule(bulk_options, timed, std::ref(bulk_delay), Clock::now(),
+                                            std::chrono::nanoseconds(bulk_work)));
+            if ((i + 1) % bulk_per_critical == 0) {
+                TaskOptions critical_options = scenario.use_lanes
+                    ? TaskOptions::within(TaskPriority::CRITICAL, critical_budget)
+                    : TaskOptions();
+                futures.push_back(pool.schedule(critical_options, timed, std::ref(critical_delay), Clock::now(),
+                                                std::chrono::nanoseconds(std::chrono::microseconds(1))));
+            }
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+        
+        uint64_t missed = 0;
+        for (size_t b = LatencyHistogram::bucketIndex(
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(critical_budget).count() + 1);
+             b < critical_delay.counts.size(); ++b) {
+            missed += critical_delay.counts[b];
+        }
+        
+        std::cout << std::left << std::setw(16) << scenario.name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << critical_delay.percentile(0.50)
+                  << std::setw(14) << critical_delay.percentile(0.99)
+                  << std::setw(14) << critical_delay.max
+                  << std::setw(10) << missed
+                  << std::setw(14) << (bulk_delay.percentile(0.99) / 1000.0) << std::endl;
+        
+        if (scenario.use_lanes && scenario.policy == LanePolicy::STRICT) {
+            lane_report = pool.getStats();
+        }
+    }
+    
+    std::cout << "\nPool-side lane statistics (strict lanes):\n" << lane_report;
+    std::cout << "Lane scheduling comparison complete" << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Compare a fixed ThreadPool against an elastic one on bursty load
+ *
+ * Bursts of short tasks separated by idle gaps: a pool sized for the burst
+ * idles between them, a minimal pool queues during them. Reports wall time,
+ * CPU time, queueing delay and the elastic pool's resize decisions.
+ */
+void runPoolBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    const size_t max_workers = std::max<size_t>(config.num_threads, 1);
+    const size_t bursts = 10;
+    const size_t tasks_per_burst = std::max<size_t>(config.num_orders / 200, 50);
+    const auto task_work = std::chrono::microseconds(20);
+    const auto idle_gap = std::chrono::milliseconds(50);
+    
+    std::cout << "\n=== ThreadPool Sizing Benchmark ===" << std::endl;
+    std::cout << bursts << " bursts of " << tasks_per_burst << " x " << task_work.count()
+              << " us tasks, " << idle_gap.count() << " ms idle between bursts" << std::endl;
+    
+    auto cpuSeconds = []() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    };
+    
+    auto runLoad = [&](ThreadPool& pool) {
+        std::vector<int> burst(tasks_per_burst);
+        for (size_t b = 0; b < bursts; ++b) {
+            auto futures = pool.submitBulk(burst, [task_work](int) {
+                auto until = Clock::now() + task_work;
+                while (Clock::now() < until) {}
+            });
+            for (auto& future : futures) {
+                future.get();
+            }
+            std::this_thread::sleep_for(idle_gap);
+        }
+    };
+    
+    std::cout << std::left << std::setw(22) << "pool" << std::right
+              << std::setw(10) << "wall ms" << std::setw(10) << "cpu ms"
+              << std::setw(12) << "tasks/s" << std::setw(14) << "p99 wait us"
+              << std::setw(10) << "workers" << std::setw(10) << "resizes" << std::endl;
+    
+    auto report = [&](const std::string& name, ThreadPool& pool) {
+        double cpu_start = cpuSeconds();
+        auto start = Clock::now();
+        runLoad(pool);
+        double wall = std::chrono::duration<double>(Clock::now() - start).count();
+        double cpu = cpuSeconds() - cpu_start;
+        
+        // Throughput over busy time only; the idle gaps are the same for every pool
+        double busy = std::max(wall - bursts * std::chrono::duration<double>(idle_gap).count(), 1e-9);
+        LaneStats stats = pool.getLaneStats(TaskPriority::NORMAL);
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << (wall * 1000.0) << std::setw(10) << (cpu * 1000.0)
+                  << std::setw(12) << (bursts * tasks_per_burst / busy)
+                  << std::setw(14) << (stats.queue_delay.percentile(0.99) / 1000.0)
+                  << std::setw(10) << pool.getThreadCount()
+                  << std::setw(10) << pool.getResizeEvents().size() << std::endl;
+    };
+    
+    {
+        ThreadPool pool(max_workers);
+        report("fixed " + std::to_string(max_workers), pool);
+    }
+    {
+        ThreadPool pool(1);
+        report("fixed 1", pool);
+    }
+    
+    ElasticConfig elastic;
+    elastic.min_workers = 1;
+    elastic.max_workers = max_workers;
+    elastic.target_queue_delay = std::chrono::microseconds(200);
+    elastic.idle_timeout = std::chrono::milliseconds(20);
+    ThreadPool pool(elastic);
+    report("elastic 1-" + std::to_string(max_workers), pool);
+    
+    auto events = pool.getResizeEvents();
+    if (!events.empty()) {
+        const size_t shown = std::min<size_t>(events.size(), 12);
+        std::cout << "\nElastic resize decisions (last " << shown << " of " << events.size() << "):" << std::endl;
+        auto first = events.front().when;
+        for (auto it = events.end() - shown; it != events.end(); ++it) {
+            const auto& event = *it;
+            std::cout << "  +" << std::setw(6) << std::setprecision(1)
+                      << std::chrono::duration<double, std::milli>(event.when - first).count() << " ms  "
+                      << event.from << " -> " << event.to << " workers ("
+                      << (event.to > event.from ? "queue delay " : "idle ")
+                      << std::setprecision(0) << (event.trigger_ns / 1000.0) << " us)" << std::endl;
+        }
+    }
+    std::cout << pool.getStats();
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Aggregate trade analytics for batch runs over trade storage
+ */
+struct TradeAnalytics {
+    uint64_t trades = 0;
+    uint64_t volume = 0;
+    double notional = 0.0;
+    uint64_t min_price = UINT64_MAX;
+    uint64_t max_price = 0;
+    
+    void add(const Trade& trade) {
+        trades++;
+        volume += trade.quantity;
+        notional += static_cast<double>(trade.price) * trade.quantity;
+        min_price = std::min(min_price, trade.price);
+        max_price = std::max(max_price, trade.price);
+    }
+    
+    TradeAnalytics& merge(const TradeAnalytics& other) {
+        trades += other.trades;
+        volume += other.volume;
+        notional += other.notional;
+        min_price = std::min(min_price, other.min_price);
+        max_price = std::max(max_price, other.max_price);
+        return *this;
+    }
+    
+    double vwap() const { return volume ? notional / volume : 0.0; }
+};
+
+/**
+ * @brief Time serial vs ThreadPool::parallelFor/parallelReduce on offline work
+ *
+ * Covers latency statistics over a large sample set, analytics over stored
+ * trades, materializing a book snapshot for restore, and a nested
+ * parallelReduce issued from inside a pool task.
+ */
+void runParallelBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    auto millis = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    
+    ThreadPool pool(config.num_threads);
+    std::mt19937_64 rng(config.seed != 0 ? config.seed : 42);
+    
+    std::cout << "\n=== Parallel Primitives Benchmark ===" << std::endl;
+    std::cout << "Workers: " << pool.getThreadCount() << " (+ calling thread)" << std::endl;
+    std::cout << std::left << std::setw(28) << "workload" << std::right
+              << std::setw(12) << "serial ms" << std::setw(14) << "parallel ms"
+              << std::setw(10) << "match" << std::endl;
+    
+    auto row = [](const std::string& name, double serial_ms, double parallel_ms, bool match) {
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << serial_ms << std::setw(14) << parallel_ms
+                  << std::setw(10) << (match ? "yes" : "NO") << std::endl;
+    };
+    bool all_match = true;
+    
+    // Latency statistics over a large sample set
+    {
+        const size_t samples = std::max<size_t>(config.num_orders * 10, 1000000);
+        PerformanceMonitor monitor(false);
+        monitor.reserve("order_submission", samples);
+        std::lognormal_distribution<double> latency(7.0, 0.8);
+        for (size_t i = 0; i < samples; ++i) {
+            monitor.recordOperation(static_cast<uint64_t>(latency(rng)), "order_submission");
+        }
+        
+        auto start = Clock::now();
+        auto serial = monitor.getStats("order_submission");
+        double serial_ms = millis(start);
+        start = Clock::now();
+        auto parallel = monitor.getStats("order_submission", pool);
+        double parallel_ms = millis(start);
+        
+        bool match = serial.total_operations == parallel.total_operations &&
+                     serial.median_latency_ns == parallel.median_latency_ns &&
+                     serial.p99_latency_ns == parallel.p99_latency_ns &&
+                     serial.p999_latency_ns == parallel.p999_latency_ns &&
+                     serial.mean_latency_ns == parallel.mean_latency_ns &&
+                     std::abs(serial.std_deviation_ns - parallel.std_deviation_ns) <= 1e-9 * serial.std_deviation_ns;
+        all_match &= match;
+        row("stats (" + std::to_string(samples / 1000) + "K samples)", serial_ms, parallel_ms, match);
+    }
+    
+    // Analytics over stored trades
+    {
+        MatchingEngine engine(config.symbol);
+        engine.setConsoleLogging(false);
+        OrderGenerator generator(config);
+        for (size_t i = 0; i < config.num_orders; ++i) {
+            engine.submitOrder(generator.generateOrder());
+        }
+        const auto& trades = engine.getTrades();
+        
+        auto start = Clock::now();
+        TradeAnalytics serial;
+        for (const auto& trade : trades) {
+            serial.add(trade);
+        }
+        double serial_ms = millis(start);
+        
+        start = Clock::now();
+        TradeAnalytics parallel = pool.parallelReduce(0, trades.size(), 0, TradeAnalytics(),
+            [&trades](size_t first, size_t last) {
+                TradeAnalytics chunk;
+                for (size_t i = first; i < last; ++i) {
+                    chunk.add(trades[i]);
+                }
+                return chunk;
+            },
+            [](TradeAnalytics total, const TradeAnalytics& chunk) { return total.merge(chunk); });
+        double parallel_ms = millis(start);
+        
+        bool match = serial.trades == parallel.trades && serial.volume == parallel.volume &&
+                     serial.min_price == parallel.min_price && serial.max_price == parallel.max_price &&
+                     std::abs(serial.vwap() - parallel.vwap()) < 1e-6;
+        all_match &= match;
+        row("trade analytics (" + std::to_string(trades.size() / 1000) + "K)", serial_ms, parallel_ms, match);
+        std::cout << "  VWAP " << std::setprecision(2) << parallel.vwap() << ", volume " << parallel.volume
+                  << ", range " << parallel.min_price << "-" << parallel.max_price << std::endl;
+    }
+    
+    // Bulk book restore: materialize a resting snapshot, then insert in order
+    {
+        struct RestingOrder {
+            Order::OrderID id;
+            OrderSide side;
+            uint64_t price;
+            uint64_t quantity;
+        };
+        const size_t resting = std::max<size_t>(config.num_orders, 100000);
+        std::uniform_int_distribution<uint64_t> offset(1, config.price_range);
+        std::uniform_int_distribution<uint64_t> quantity(config.min_quantity, config.max_quantity);
+        std::vector<RestingOrder> snapshot(resting);
+        for (size_t i = 0; i < resting; ++i) {
+            bool buy = (i & 1) == 0;
+            snapshot[i] = RestingOrder{i + 1, buy ? OrderSide::BUY : OrderSide::SELL,
+                                       buy ? config.base_price - offset(rng) : config.base_price + offset(rng),
+                                       quantity(rng)};
+        }
+        
+        auto materialize = [&snapshot](std::vector<std::shared_ptr<Order>>& orders, size_t first, size_t last) {
+            auto timestamp = std::chrono::high_resolution_clock::time_point();
+            for (size_t i = first; i < last; ++i) {
+                const auto& r = snapshot[i];
+                // Snapshot order is time priority, so the index stands in for the timestamp
+                orders[i] = std::make_shared<Order>(r.id, r.side, r.price, r.quantity,
+                                                    timestamp + std::chrono::nanoseconds(i));
+            }
+        };
+        
+        std::vector<std::shared_ptr<Order>> serial_orders(resting);
+        auto start = Clock::now();
+        materialize(serial_orders, 0, resting);
+        double serial_ms = millis(start);
+        
+        std::vector<std::shared_ptr<Order>> parallel_orders(resting);
+        start = Clock::now();
+        pool.parallelFor(0, resting, 0, [&](size_t first, size_t last) {
+            materialize(parallel_orders, first, last);
+        });
+        double parallel_ms = millis(start);
+        
+        OrderBook::OrderBook book(config.symbol);
+        for (const auto& order : parallel_orders) {
+            book.addOrder(order);
+        }
+        bool match = book.getOrderCount() == resting;
+        all_match &= match;
+        row("book restore (" + std::to_string(resting / 1000) + "K orders)", serial_ms, parallel_ms, match);
+    }
+    
+    // Nested use: a pool task that itself fans out must not deadlock
+    {
+        const size_t n = 1000000;
+        auto future = pool.submit([&pool, n]() {
+            return pool.parallelReduce(0, n, 0, uint64_t(0),
+                [](size_t first, size_t last) {
+                    uint64_t sum = 0;
+                    for (size_t i = first; i < last; ++i) sum += i;
+                    return sum;
+                },
+                [](uint64_t a, uint64_t b) { return a + b; });
+        });
+        bool match = future.get() == static_cast<uint64_t>(n) * (n - 1) / 2;
+        all_match &= match;
+        std::cout << "Nested parallelReduce inside a pool task: " << (match ? "ok" : "WRONG") << std::endl;
+    }
+    
+    std::cout << (all_match ? "All parallel results match serial" : "Parallel results DIFFER from serial") << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Matching latency with concurrent market-data readers
+ *
+ * One thread submits a fixed order stream while K reader threads (for
+ * each K in --readers) poll depth, top of book and order lookups in the
+ * --read-mix proportions, each at up to --read-rate reads per second.
+ * Depth is read through getMarketDepth() under the shared book lock,
+ * then through the epoch-protected DepthSnapshot.
+ *
+ * Staleness is how long the result had been out of date when the read
+ * returned. It is measured from when the matcher finished the first
+ * order the read was not guaranteed to see, or zero if the matcher
+ * finished nothing while the read was in flight.
+ */
+void runReaderBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    const size_t depth_levels = 10;
+    enum ReadKind : uint8_t { DEPTH, TOP, LOOKUP };
+    
+    // Weighted round-robin over the read kinds
+    std::vector<ReadKind> pattern;
+    for (ReadKind kind : {DEPTH, TOP, LOOKUP}) {
+        pattern.insert(pattern.end(), config.read_mix[kind], kind);
+    }
+    if (pattern.empty()) pattern.push_back(DEPTH);
+    const auto interval = config.read_rate
+        ? std::chrono::nanoseconds(1000000000 / config.read_rate) : std::chrono::nanoseconds(0);
+    
+    std::cout << "\n=== Reader Concurrency Benchmark ===" << std::endl;
+    std::cout << "Orders: " << config.num_orders << ", read mix depth:top:lookup "
+              << config.read_mix[DEPTH] << ":" << config.read_mix[TOP] << ":" << config.read_mix[LOOKUP]
+              << " (" << depth_levels << " depth levels), ";
+    if (config.read_rate) {
+        std::cout << config.read_rate << " reads/s per reader" << std::endl;
+    } else {
+        std::cout << "unthrottled" << std::endl;
+    }
+    
+    // Same order stream for every reader count
+    SimulationConfig generator_config = config;
+    if (generator_config.seed == 0) generator_config.seed = 42;
+    OrderGenerator generator(generator_config);
+    auto orders = generator.generateBatch(config.num_orders);
+    
+    std::cout << std::left << std::setw(8) << "depth" << std::setw(9) << "readers" << std::right
+              << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+              << std::setw(11) << "p99.9 ns" << std::setw(11) << "max ns"
+              << std::setw(12) << "orders/s" << std::setw(12) << "reads/s"
+              << std::setw(14) << "stale p50 us" << std::setw(14) << "stale p99 us" << std::endl;
+    
+    uint64_t retired = 0;
+    uint64_t reclaimed = 0;
+    for (bool use_epochs : {false, true}) {
+        for (int readers : config.reader_counts) {
+            EpochManager epochs;
+            MatchingEngine engine(config.symbol);
+            engine.setConsoleLogging(false);
+            if (use_epochs) {
+                engine.setEpochManager(&epochs);
+            }
+            const OrderBook::OrderBook& book = engine.getOrderBook();
+            
+            // Fresh copies: matching mutates the orders
+            std::vector<std::shared_ptr<Order>> stream;
+            stream.reserve(orders.size());
+            for (const auto& order : orders) {
+                stream.push_back(std::make_shared<Order>(*order));
+            }
+            
+            // completed_ns[i] is when order i finished; completed counts them
+            std::vector<int64_t> completed_ns(stream.size(), 0);
+            std::atomic<size_t> completed(0);
+            auto now_ns = []() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+            };
+            
+            std::atomic<bool> running(true);
+            std::atomic<uint64_t> total_reads(0);
+            std::mutex staleness_mutex;
+            LatencyHistogram staleness;
+            std::vector<std::thread> reader_threads;
+            for (int r = 0; r < readers; ++r) {
+                reader_threads.emplace_back([&, r]() {
+                    LatencyHistogram local_staleness;
+                    std::mt19937_64 rng(r + 1);
+                    uint64_t reads = 0;
+                    uint64_t seen = 0;
+                    auto next = Clock::now();
+                    while (running.load(std::memory_order_relaxed)) {
+                        if (interval.count()) {
+                            next += interval;
+                            auto now = Clock::now();
+                            if (next > now) {
+                                std::this_thread::sleep_until(next);
+                            } else if (now - next > interval) {
+                                next = now;   // fell behind: don't burst to catch up
+                            }
+                        }
+                        
+                        size_t before = completed.load(std::memory_order_acquire);
+                        switch (pattern[(reads + r) % pattern.size()]) {
+                            case DEPTH:
+                                if (use_epochs) {
+                                    book.visitDepthSnapshot([&seen](const DepthSnapshot& snapshot) {
+                                        seen += snapshot.bid_count + snapshot.ask_count;
+                                    });
+                                } else {
+                                    auto depth = book.getMarketDepth(depth_levels);
+                                    seen += depth.first.size() + depth.second.size();
+                                }
+                                break;
+                            case TOP:
+                                seen += book.getTopOfBook().bid_quantity;
+                                break;
+                            case LOOKUP:
+                                seen += book.getOrder(stream[rng() % std::max<size_t>(before, 1)]->getId()) != nullptr;
+                                break;
+                        }
+                        size_t after = completed.load(std::memory_order_acquire);
+                        local_staleness.record(after > before ? now_ns() - completed_ns[before] : 0);
+                        reads++;
+                    }
+                    total_reads.fetch_add(reads);
+                    {
+                        std::lock_guard<std::mutex> lock(staleness_mutex);
+                        staleness.merge(local_staleness);
+                    }
+                    volatile uint64_t sink = seen;
+                    (void)sink;
+                });
+            }
+            
+            LatencyHistogram latency;
+            auto start = Clock::now();
+            for (size_t i = 0; i < stream.size(); ++i) {
+                auto submitted = Clock::now();
+                engine.submitOrder(stream[i]);
+                auto done = Clock::now();
+                latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - submitted).count());
+                completed_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(done.time_since_epoch()).count();
+                completed.store(i + 1, std::memory_order_release);
+            }
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            
+            running.store(false);
+            for (auto& thread : reader_threads) {
+                thread.join();
+            }
+            retired += epochs.getRetiredCount();
+            reclaimed += epochs.getReclaimedCount();
+            
+            std::cout << std::left << std::setw(8) << (use_epochs ? "epoch" : "locked")
+                      << std::setw(9) << readers << std::right << std::fixed << std::setprecision(0)
+                      << std::setw(10) << latency.percentile(0.50)
+                      << std::setw(10) << latency.percentile(0.99)
+                      << std::setw(11) << latency.percentile(0.999)
+                      << std::setw(11) << latency.max
+                      << std::setw(12) << (stream.size() / elapsed)
+                      << std::setw(12) << (total_reads.load() / elapsed) << std::setprecision(1)
+                      << std::setw(14) << (staleness.total ? staleness.percentile(0.50) / 1000.0 : 0.0)
+                      << std::setw(14) << (staleness.total ? staleness.percentile(0.99) / 1000.0 : 0.0) << std::endl;
+        }
+    }
+    
+    std::cout << "Epoch reclamation: " << retired << " retired, " << reclaimed
+              << " freed during the runs (rest freed with each manager)" << std::endl;
+    std::cout << "Reader benchmark complete" << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Passive-heavy flow on the single-lock engine vs the striped book
+ *
+ * Each thread replays its own mix of passive adds away from the touch,
+ * cancels of its recent orders and a few crossing orders. The same
+ * per-thread streams run through MatchingEngine (one matching mutex) and
+ * StripedOrderBook (per-level locks) at 1 to 16 threads.
+ */
+void runStripedBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    const size_t thread_counts[] = {1, 2, 4, 8, 16};
+    
+    struct Op {
+        bool cancel;
+        OrderSide side;
+        uint64_t price;
+        uint64_t quantity;
+        Order::OrderID id;
+    };
+    
+    const uint64_t min_price = config.base_price - config.price_range;
+    const uint64_t max_price = config.base_price + config.price_range;
+    
+    std::cout << "\n=== Striped Order Book Benchmark ===" << std::endl;
+    std::cout << "Operations: " << config.num_orders
+              << " (88% passive add, 10% cancel, 2% crossing) over prices "
+              << min_price << "-" << max_price << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(16) << "single ops/s" << std::setw(16) << "striped ops/s"
+              << std::setw(10) << "speedup" << std::setw(14) << "escalated" << std::endl;
+    
+    bool all_consistent = true;
+    for (size_t threads : thread_counts) {
+        // Per-thread streams with disjoint order IDs
+        std::vector<std::vector<Op>> streams(threads);
+        const size_t per_thread = std::max<size_t>(config.num_orders / threads, 1);
+        for (size_t t = 0; t < threads; ++t) {
+            std::mt19937_64 rng((config.seed ? config.seed : 42) + t);
+            std::uniform_int_distribution<int> action_dist(0, 99);
+            std::uniform_int_distribution<uint64_t> offset_dist(1, config.price_range);
+            std::uniform_int_distribution<uint64_t> qty_dist(config.min_quantity, config.max_quantity);
+            Order::OrderID next_id = (t + 1) * (per_thread + 1) * 4;
+            std::vector<Order::OrderID> live;
+            
+            streams[t].reserve(per_thread);
+            for (size_t i = 0; i < per_thread; ++i) {
+                int action = action_dist(rng);
+                OrderSide side = (action & 1) ? OrderSide::BUY : OrderSide::SELL;
+                if (action < 10 && !live.empty()) {
+                    size_t pick = rng() % live.size();
+                    streams[t].push_back({true, side, 0, 0, live[pick]});
+                    live[pick] = live.back();
+                    live.pop_back();
+                    continue;
+                }
+                uint64_t offset = offset_dist(rng);
+                bool crossing = action >= 98;
+                uint64_t price = (side == OrderSide::BUY) == crossing
+                    ? std::min(config.base_price + offset, max_price)
+                    : std::max(config.base_price - offset, min_price);
+                streams[t].push_back({false, side, price, qty_dist(rng), next_id});
+                if (!crossing) live.push_back(next_id);
+                next_id++;
+            }
+        }
+        
+        auto timeRun = [&](auto&& apply) {
+            std::vector<std::thread> workers;
+            std::atomic<size_t> ready(0);
+            std::atomic<bool> go(false);
+            for (size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t]() {
+                    ready.fetch_add(1);
+                    while (!go.load()) std::this_thread::yield();
+                    for (const auto& op : streams[t]) apply(op);
+                });
+            }
+            while (ready.load() < threads) std::this_thread::yield();
+            auto start = Clock::now();
+            go.store(true);
+            for (auto& worker : workers) worker.join();
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        };
+        
+        auto makeOrder = [](const Op& op) {
+            return std::make_shared<Order>(op.id, op.side, op.price, op.quantity,
+                                           std::chrono::high_resolution_clock::now());
+        };
+        
+        MatchingEngine engine(config.symbol);
+        engine.setConsoleLogging(false);
+        double single_time = timeRun([&](const Op& op) {
+            if (op.cancel) engine.cancelOrder(op.id);
+            else engine.submitOrder(makeOrder(op));
+        });
+        
+        StripedOrderBook striped(config.symbol, min_price, max_price);
+        double striped_time = timeRun([&](const Op& op) {
+            if (op.cancel) striped.cancelOrder(op.id);
+            else striped.submitOrder(makeOrder(op));
+        });
+        
+        uint64_t best_bid = striped.getBestBid();
+        uint64_t best_ask = striped.getBestAsk();
+        if (best_bid != 0 && best_ask != 0 && best_bid >= best_ask) {
+            all_consistent = false;
+        }
+        // Single-threaded, both books see one order sequence and must trade the same volume
+        if (threads == 1 && (engine.getTotalVolume() != striped.getTotalVolume() ||
+                             engine.getOrderBook().getOrderCount() != striped.getOrderCount())) {
+            all_consistent = false;
+            std::cout << "Single-thread mismatch: volume " << engine.getTotalVolume() << " vs "
+                      << striped.getTotalVolume() << ", resting " << engine.getOrderBook().getOrderCount()
+                      << " vs " << striped.getOrderCount() << std::endl;
+        }
+        
+        size_t ops = per_thread * threads;
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(16) << (ops / single_time)
+                  << std::setw(16) << (ops / striped_time)
+                  << std::setw(9) << std::setprecision(2) << (single_time / striped_time) << "x"
+                  << std::setw(14) << striped.getEscalations() << std::endl;
+    }
+    
+    std::cout << (all_consistent ? "Striped book consistent after every run" : "Striped book INCONSISTENT") << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Memory resource that counts what reaches the global heap
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    void reset() { allocations = 0; bytes = 0; }
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override {
+        allocations++;
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void* p, size_t size, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * @brief Compare book memory strategies on add/cancel/match flow
+ *
+ * Each engine runs the stream once to warm up, is cleared, and then runs
+ * it again timed. Book containers draw from a counting upstream, so the
+ * table shows how many container allocations still reach the global
+ * heap once the book's own resource is warm.
+ */
+void runAllocationBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "\n=== Book Memory Benchmark ===" << std::endl;
+    std::cout << "Orders: " << config.num_orders << " (every 10th followed by a cancel), "
+              << "warm pass then timed pass" << std::endl;
+    
+    SimulationConfig generator_config = config;
+    if (generator_config.seed == 0) generator_config.seed = 42;
+    OrderGenerator generator(generator_config);
+    auto orders = generator.generateBatch(config.num_orders);
+    
+    auto copies = [&orders]() {
+        std::vector<std::shared_ptr<Order>> stream;
+        stream.reserve(orders.size());
+        for (const auto& order : orders) {
+            stream.push_back(std::make_shared<Order>(*order));
+        }
+        return stream;
+    };
+    
+    std::cout << std::left << std::setw(12) << "memory" << std::right
+              << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+              << std::setw(12) << "p99.9 ns" << std::setw(14) << "ops/s"
+              << std::setw(16) << "heap allocs" << std::setw(12) << "heap MB" << std::endl;
+    
+    const std::pair<BookMemory, const char*> modes[] = {
+        {BookMemory::HEAP, "heap"},
+        {BookMemory::POOL, "pool"},
+        {BookMemory::MONOTONIC, "monotonic"},
+    };
+    bool pool_clean = true;
+    for (const auto& [memory, name] : modes) {
+        CountingResource upstream;
+        MatchingEngine engine(config.symbol, memory, &upstream);
+        engine.setConsoleLogging(false);
+        engine.setTradeRetention(65536);
+        
+        auto run = [&engine](const std::vector<std::shared_ptr<Order>>& stream, LatencyHistogram* latency) {
+            for (size_t i = 0; i < stream.size(); ++i) {
+                auto start = Clock::now();
+                engine.submitOrder(stream[i]);
+                if (i % 10 == 9) {
+                    engine.cancelOrder(stream[i - 5]->getId());
+                }
+                if (latency) {
+                    latency->record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                }
+            }
+        };
+        
+        run(copies(), nullptr);
+        engine.clear();
+        
+        auto stream = copies();
+        LatencyHistogram latency;
+        upstream.reset();
+        auto start = Clock::now();
+        run(stream, &latency);
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        
+        if (memory == BookMemory::POOL && upstream.allocations > 0) {
+            pool_clean = false;
+        }
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << latency.percentile(0.50)
+                  << std::setw(10) << latency.percentile(0.99)
+                  << std::setw(12) << latency.percentile(0.999)
+                  << std::setw(14) << (stream.size() / elapsed)
+                  << std::setw(16) << upstream.allocations
+                  << std::setw(12) << std::setprecision(2) << (upstream.bytes / (1024.0 * 1024.0)) << std::endl;
+    }
+    
+    std::cout << (pool_clean ? "Warm pool made no heap allocations" 
+                             : "Warm pool still allocated from the heap") << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Per-operation timings for one price index
+ */
+struct IndexTimings {
+    double build_ns = 0;    ///< Per level, inserting in random order
+    double find_ns = 0;     ///< Lookup of a resting price
+    double churn_ns = 0;    ///< Insert and erase of a level inside the range
+    double touch_ns = 0;    ///< New best level, read best bid/ask, remove it
+    uint64_t checksum = 0;  ///< Folds every result so both indexes can be compared
+};
+
+/**
+ * @brief Drive one price index through the same operation streams
+ */
+template<typename Index>
+IndexTimings timePriceIndex(std::pmr::memory_resource* memory, const std::vector<uint64_t>& levels,
+                            const std::vector<uint64_t>& lookups, const std::vector<uint64_t>& inserts) {
+    using Clock = std::chrono::steady_clock;
+    auto per_op = [](Clock::time_point start, size_t ops) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+    };
+    
+    IndexTimings timings;
+    Index index(memory);
+    
+    auto start = Clock::now();
+    for (uint64_t price : levels) {
+        index.try_emplace(price, price);
+    }
+    timings.build_ns = per_op(start, levels.size());
+    
+    start = Clock::now();
+    for (uint64_t price : lookups) {
+        auto it = index.find(price);
+        timings.checksum += (it != index.end()) ? it->second.price : 1;
+    }
+    timings.find_ns = per_op(start, lookups.size());
+    
+    start = Clock::now();
+    for (uint64_t price : inserts) {
+        auto [it, created] = index.try_emplace(price, price);
+        timings.checksum += created;
+        index.erase(it);
+    }
+    timings.churn_ns = per_op(start, inserts.size());
+    
+    start = Clock::now();
+    for (size_t i = 0; i < inserts.size(); ++i) {
+        uint64_t price = (i & 1) ? index.rbegin()->first + 1 : index.begin()->first - 1;
+        auto [it, created] = index.try_emplace(price, price);
+        timings.checksum += index.begin()->first ^ index.rbegin()->first;
+        index.erase(it);
+    }
+    timings.touch_ns = per_op(start, inserts.size());
+    
+    for (const auto& [price, level] : index) {
+        timings.checksum = timings.checksum * 31 + price + level.price;
+    }
+    return timings;
+}
+
+/**
+ * @brief Compare std::map and the B+-tree as the book's price index
+ *
+ * Levels sit on even ticks and churn on odd ones, so every churn insert
+ * creates a level and every erase removes one. Both indexes draw from
+ * identical pool resources.
+ */
+void runIndexBenchmark(const SimulationConfig& config) {
+    std::cout << "\n=== Price Index Benchmark ===" << std::endl;
+    std::cout << "Operations per test: " << config.num_orders << " (ns/op, map vs B+-tree)" << std::endl;
+    
+    std::mt19937_64 rng(config.seed ? config.seed : 42);
+    size_t ops = std::max<size_t>(config.num_orders, 1);
+    
+    std::cout << std::left << std::setw(10) << "levels" << std::setw(8) << "op" << std::right
+              << std::setw(12) << "map" << std::setw(12) << "btree" << std::setw(10) << "speedup" << std::endl;
+    
+    bool all_match = true;
+    for (size_t level_count : {size_t(10), size_t(1000), size_t(100000)}) {
+        const uint64_t base = 1000000;
+        std::vector<uint64_t> levels(level_count);
+        for (size_t i = 0; i < level_count; ++i) levels[i] = base + 2 * i;
+        std::shuffle(levels.begin(), levels.end(), rng);
+        
+        std::uniform_int_distribution<size_t> pick(0, level_count - 1);
+        std::vector<uint64_t> lookups(ops);
+        std::vector<uint64_t> inserts(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            lookups[i] = levels[pick(rng)];
+            inserts[i] = base + 2 * pick(rng) + 1;
+        }
+        
+        std::pmr::unsynchronized_pool_resource map_memory;
+        std::pmr::unsynchronized_pool_resource btree_memory;
+        auto map = timePriceIndex<std::pmr::map<uint64_t, PriceLevel>>(&map_memory, levels, lookups, inserts);
+        auto btree = timePriceIndex<BTreePriceIndex<PriceLevel>>(&btree_memory, levels, lookups, inserts);
+        all_match = all_match && (map.checksum == btree.checksum);
+        
+        const std::tuple<const char*, double, double> rows[] = {
+            {"build", map.build_ns, btree.build_ns},
+            {"find", map.find_ns, btree.find_ns},
+            {"churn", map.churn_ns, btree.churn_ns},
+            {"touch", map.touch_ns, btree.touch_ns},
+        };
+        for (const auto& [name, map_ns, btree_ns] : rows) {
+            std::cout << std::left << std::setw(10) << level_count << std::setw(8) << name << std::right
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12) << map_ns << std::setw(12) << btree_ns
+                      << std::setw(9) << std::setprecision(2) << (map_ns / btree_ns) << "x" << std::endl;
+        }
+    }
+    
+    std::cout << (all_match ? "B+-tree index matches std::map" : "B+-tree index DIVERGES from std::map") << std::endl;
+#ifdef ORDERBOOK_BTREE_INDEX
+    std::cout << "OrderBook price index: B+-tree" << std::endl;
+#else
+    std::cout << "OrderBook price index: std::map (build with -DORDERBOOK_BTREE_INDEX to switch)" << std::endl;
+#endif
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief One level operation in the tiered index benchmark
+ */
+struct TierOp {
+    bool buy;
+    bool add;           ///< Add quantity, else remove it
+    uint64_t price;
+    uint64_t quantity;
+};
+
+/**
+ * @brief Replay level operations against one bid/ask index pair
+ * @return Nanoseconds per timed operation
+ */
+template<typename Index>
+double replayLevelFlow(Index& bids, Index& asks, const std::vector<TierOp>& ops, uint64_t& checksum) {
+    auto apply = [&bids, &asks, &checksum](const TierOp& op) {
+        Index& index = op.buy ? bids : asks;
+        if (op.add) {
+            auto [it, created] = index.try_emplace(op.price, op.price);
+            it->second.total_quantity += op.quantity;
+        } else {
+            auto it = index.find(op.price);
+            if (it != index.end()) {
+                uint64_t taken = std::min(op.quantity, it->second.total_quantity);
+                it->second.total_quantity -= taken;
+                checksum += taken;
+                if (it->second.total_quantity == 0) index.erase(it);
+            }
+        }
+        checksum += (bids.empty() ? 0 : bids.rbegin()->first) ^ (asks.empty() ? 0 : asks.begin()->first);
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& op : ops) apply(op);
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    
+    for (const Index* index : {&bids, &asks}) {
+        for (const auto& [price, level] : *index) {
+            checksum = checksum * 31 + price + level.total_quantity;
+        }
+    }
+    return elapsed / std::max<size_t>(ops.size(), 1);
+}
+
+/**
+ * @brief Compare price indexes on flow concentrated at the touch
+ *
+ * The mid price random-walks, each step trading through the level it
+ * crosses. 99% of adds and removes land within a few dozen ticks of the
+ * mid, and the rest anywhere in a 100k-tick tail, which is also seeded
+ * with deep levels before timing starts.
+ */
+void runTierBenchmark(const SimulationConfig& config) {
+    std::cout << "\n=== Tiered Price Index Benchmark ===" << std::endl;
+    std::cout << "Level operations: " << config.num_orders << ", window: " << config.tier_window << " ticks" << std::endl;
+    
+    std::mt19937_64 rng(config.seed ? config.seed : 42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::exponential_distribution<double> near_touch(1.0 / 8.0);
+    std::uniform_int_distribution<uint64_t> tail(0, 100000);
+    std::uniform_int_distribution<uint64_t> quantity(1, 500);
+    
+    const uint64_t start_mid = 10000000;
+    std::vector<TierOp> preload;
+    for (int i = 0; i < 4000; ++i) {
+        bool buy = i & 1;
+        uint64_t distance = 1 + tail(rng);
+        preload.push_back({buy, true, buy ? start_mid - distance : start_mid + distance, quantity(rng)});
+    }
+    
+    uint64_t mid = start_mid;
+    std::vector<TierOp> ops;
+    ops.reserve(config.num_orders);
+    while (ops.size() < config.num_orders) {
+        if (unit(rng) < 0.05) {
+            // The mid moves by trading through the level next to it
+            bool up = unit(rng) < 0.5;
+            ops.push_back({!up, false, up ? mid + 1 : mid - 1, UINT64_MAX});
+            mid += up ? 1 : -1;
+            continue;
+        }
+        bool buy = unit(rng) < 0.5;
+        uint64_t distance = 1 + (unit(rng) < 0.01 ? tail(rng) : static_cast<uint64_t>(near_touch(rng)));
+        ops.push_back({buy, unit(rng) < 0.55, buy ? mid - distance : mid + distance, quantity(rng)});
+    }
+    
+    uint64_t map_sum = 0, btree_sum = 0, tiered_sum = 0;
+    
+    std::pmr::unsynchronized_pool_resource map_memory;
+    std::pmr::map<uint64_t, PriceLevel> map_bids(&map_memory), map_asks(&map_memory);
+    replayLevelFlow(map_bids, map_asks, preload, map_sum);
+    double map_ns = replayLevelFlow(map_bids, map_asks, ops, map_sum);
+    
+    std::pmr::unsynchronized_pool_resource btree_memory;
+    BTreePriceIndex<PriceLevel> btree_bids(&btree_memory), btree_asks(&btree_memory);
+    replayLevelFlow(btree_bids, btree_asks, preload, btree_sum);
+    double btree_ns = replayLevelFlow(btree_bids, btree_asks, ops, btree_sum);
+    
+    using Tiered = TieredPriceIndex<PriceLevel>;
+    std::pmr::unsynchronized_pool_resource tiered_memory;
+    Tiered tiered_bids(Tiered::Touch::HIGH, &tiered_memory, config.tier_window);
+    Tiered tiered_asks(Tiered::Touch::LOW, &tiered_memory, config.tier_window);
+    replayLevelFlow(tiered_bids, tiered_asks, preload, tiered_sum);
+    auto counters = [&tiered_bids, &tiered_asks]() {
+        return std::make_tuple(tiered_bids.getHotOperations() + tiered_asks.getHotOperations(),
+                               tiered_bids.getColdOperations() + tiered_asks.getColdOperations(),
+                               tiered_bids.getMigrations() + tiered_asks.getMigrations());
+    };
+    auto [hot_before, cold_before, migrations_before] = counters();
+    double tiered_ns = replayLevelFlow(tiered_bids, tiered_asks, ops, tiered_sum);
+    auto [hot_after, cold_after, migrations_after] = counters();
+    uint64_t hot = hot_after - hot_before;
+    uint64_t cold = cold_after - cold_before;
+    
+    std::cout << std::left << std::setw(12) << "index" << std::right << std::setw(10) << "ns/op"
+              << std::setw(10) << "speedup" << std::endl;
+    const std::pair<const char*, double> rows[] = {{"map", map_ns}, {"btree", btree_ns}, {"tiered", tiered_ns}};
+    for (const auto& [name, ns] : rows) {
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << ns << std::setw(9) << std::setprecision(2) << (map_ns / ns) << "x" << std::endl;
+    }
+    
+    std::cout << "Dense tier served " << std::setprecision(2) << (100.0 * hot / std::max<uint64_t>(hot + cold, 1))
+              << "% of level operations; " << (tiered_bids.getHotLevels() + tiered_asks.getHotLevels()) << " of "
+              << (tiered_bids.size() + tiered_asks.size()) << " levels hot, "
+              << (migrations_after - migrations_before) << " migrations" << std::endl;
+    
+    bool match = map_sum == btree_sum && map_sum == tiered_sum;
+    std::cout << (match ? "Tiered index matches std::map" : "Tiered index DIVERGES from std::map") << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Compare eager and lazy cancellation on deep level queues
+ *
+ * The same resting book (--orders orders over 20 levels a side) is built
+ * in each mode, half of it is cancelled in random order with every cancel
+ * timed, and the rest is swept by crossing orders. The deferred mode only
+ * compacts between the two phases, as a maintenance thread would.
+ */
+void runCancelBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "\n=== Cancel Benchmark ===" << std::endl;
+    
+    const size_t levels_per_side = 20;
+    const uint64_t mid = config.base_price;
+    std::mt19937_64 rng(config.seed ? config.seed : 42);
+    std::uniform_int_distribution<uint64_t> level(1, levels_per_side);
+    std::uniform_int_distribution<uint64_t> quantity(config.min_quantity, config.max_quantity);
+    
+    struct Spec { OrderSide side; uint64_t price; uint64_t quantity; };
+    std::vector<Spec> specs(config.num_orders);
+    for (size_t i = 0; i < specs.size(); ++i) {
+        OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+        specs[i] = {side, side == OrderSide::BUY ? mid - level(rng) : mid + level(rng), quantity(rng)};
+    }
+    std::vector<Order::OrderID> cancels(specs.size());
+    for (size_t i = 0; i < cancels.size(); ++i) cancels[i] = i + 1;
+    std::shuffle(cancels.begin(), cancels.end(), rng);
+    cancels.resize(cancels.size() / 2);
+    
+    std::cout << "Resting orders: " << specs.size() << " over " << 2 * levels_per_side
+              << " levels, cancels: " << cancels.size() << std::endl;
+    std::cout << std::left << std::setw(10) << "mode" << std::right
+              << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns" << std::setw(12) << "p99.9 ns"
+              << std::setw(13) << "tombstones" << std::setw(14) << "compact ms" << std::setw(12) << "sweep ms" << std::endl;
+    
+    struct Mode { const char* name; bool lazy; double ratio; };
+    const Mode modes[] = {{"eager", false, 0.5}, {"lazy", true, 0.5}, {"deferred", true, 2.0}};
+    
+    bool consistent = true;
+    uint64_t reference_volume = 0;
+    size_t reference_trades = 0;
+    for (const auto& mode : modes) {
+        MatchingEngine engine(config.symbol);
+        engine.setConsoleLogging(false);
+        engine.setTradeRetention(65536);
+        engine.setLazyCancel(mode.lazy, mode.ratio);
+        
+        auto now = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < specs.size(); ++i) {
+            engine.submitOrder(std::make_shared<Order>(i + 1, specs[i].side, specs[i].price, specs[i].quantity, now));
+        }
+        
+        LatencyHistogram latency;
+        for (auto id : cancels) {
+            auto start = Clock::now();
+            engine.cancelOrder(id);
+            latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+        size_t tombstones = engine.getOrderBook().getTombstoneCount();
+        
+        auto compact_start = Clock::now();
+        engine.compactTombstones();
+        double compact_ms = std::chrono::duration<double, std::milli>(Clock::now() - compact_start).count();
+        
+        // Sweep each side with crossing orders of 1000 lots
+        auto sweep_start = Clock::now();
+        Order::OrderID next_id = specs.size() + 1;
+        for (OrderSide side : {OrderSide::BUY, OrderSide::SELL}) {
+            uint64_t limit = side == OrderSide::BUY ? mid + levels_per_side : mid - levels_per_side;
+            while (side == OrderSide::BUY ? engine.getOrderBook().getBestAsk() != 0
+                                          : engine.getOrderBook().getBestBid() != 0) {
+                engine.submitOrder(std::make_shared<Order>(next_id++, side, limit, 1000, now));
+            }
+            engine.cancelOrder(next_id - 1);   // Any unfilled remainder of the last sweep
+        }
+        double sweep_ms = std::chrono::duration<double, std::milli>(Clock::now() - sweep_start).count();
+        
+        if (&mode == &modes[0]) {
+            reference_volume = engine.getTotalVolume();
+            reference_trades = engine.getTradeCount();
+        } else if (engine.getTotalVolume() != reference_volume || engine.getTradeCount() != reference_trades) {
+            consistent = false;
+        }
+        if (engine.getOrderBook().getOrderCount() != 0) consistent = false;
+        
+        std::cout << std::left << std::setw(10) << mode.name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << latency.percentile(0.50)
+                  << std::setw(10) << latency.percentile(0.99)
+                  << std::setw(12) << latency.percentile(0.999)
+                  << std::setw(13) << tombstones
+                  << std::setw(14) << std::setprecision(2) << compact_ms
+                  << std::setw(12) << sweep_ms << std::endl;
+    }
+    
+    std::cout << (consistent ? "Lazy cancel matches eager cancel" : "Lazy cancel DIVERGES from eager cancel") << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Standby results, written by the standby process for the launcher
+ */
+struct StandbyReport {
+    uint64_t applied = 0;             ///< Journal records applied before promotion
+    uint64_t mismatches = 0;          ///< Records after which the checksums differed
+    uint64_t taken_over = 0;          ///< Inputs processed after promotion
+    double lag_p50_us = 0;
+    double lag_p99_us = 0;
+    double lag_max_us = 0;
+    double apply_rate = 0;            ///< Records per second of apply time
+    double detect_us = 0;             ///< Primary death to standby noticing
+    double failover_ms = 0;           ///< Primary death to standby accepting input
+    BookChecksum final_checksum;
+};
+
+/**
+ * @brief Shared memory between the launcher, primary and standby
+ */
+struct StandbyLink {
+    JournalRing journal;
+    std::atomic<int64_t> primary_death_ns{0};
+    StandbyReport report;
+};
+
+/**
+ * @brief Primary plus hot standby over a shared-memory journal, with failover
+ *
+ * The launcher forks a primary and a standby process. The primary applies
+ * each input and publishes it, with its book checksum, to a journal ring
+ * in shared memory; the standby applies the same records and checks its
+ * checksum after every one. The primary "crashes" (_exit without cleanup)
+ * after --failover-at inputs. The standby notices through EOF on a pipe
+ * only the primary holds open, drains the ring, promotes itself and
+ * processes the rest of the stream. Its final book is then compared with
+ * an uninterrupted single-process run.
+ */
+void runStandby(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    auto now_ns = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    };
+    
+    std::cout << "\n=== Hot Standby Replication ===" << std::endl;
+    
+    // Input stream: generated orders with a cancel after every 10th
+    SimulationConfig generator_config = config;
+    if (generator_config.seed == 0) generator_config.seed = 42;
+    OrderGenerator generator(generator_config);
+    auto orders = generator.generateBatch(config.num_orders);
+    std::vector<JournalRecord> inputs;
+    inputs.reserve(orders.size() + orders.size() / 10);
+    for (size_t i = 0; i < orders.size(); ++i) {
+        JournalRecord record;
+        record.op = JournalOp::SUBMIT;
+        record.order_id = orders[i]->getId();
+        record.side = orders[i]->getSide();
+        record.price = orders[i]->getPrice();
+        record.quantity = orders[i]->getQuantity();
+        record.timestamp = orders[i]->getTimestamp().time_since_epoch().count();
+        record.owner = orders[i]->getOwner();
+        inputs.push_back(record);
+        if (i % 10 == 9) {
+            JournalRecord cancel;
+            cancel.op = JournalOp::CANCEL;
+            cancel.order_id = orders[i - 5]->getId();
+            inputs.push_back(cancel);
+        }
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) inputs[i].sequence = i + 1;
+    
+    size_t failover_at = config.failover_at ? std::min(config.failover_at, inputs.size()) : inputs.size() * 3 / 4;
+    std::cout << "Inputs: " << inputs.size() << ", primary fails after " << failover_at << std::endl;
+    
+    StandbyLink* link = createShared<StandbyLink>();
+    int liveness[2];
+    if (pipe(liveness) != 0) {
+        destroyShared(link);
+        throw std::runtime_error("runStandby: pipe failed");
+    }
+    std::cout.flush();
+    
+    pid_t standby = fork();
+    if (standby == 0) {
+        close(liveness[1]);
+        fcntl(liveness[0], F_SETFL, O_NONBLOCK);
+        
+        MatchingEngine engine(config.symbol);
+        engine.setConsoleLogging(false);
+        engine.setTradeRetention(65536);
+        StandbyReport& report = link->report;
+        LatencyHistogram lag;
+        double apply_seconds = 0;
+        
+        auto apply = [&](const JournalRecord& record) {
+            auto start = Clock::now();
+            applyJournalRecord(engine, record);
+            auto done = Clock::now();
+            apply_seconds += std::chrono::duration<double>(done - start).count();
+            if (engine.getOrderBook().getChecksum() != record.checksum) report.mismatches++;
+            lag.record(now_ns() - record.published_ns);
+            report.applied++;
+        };
+        
+        JournalRecord record;
+        int64_t detected_ns = 0;
+        while (!detected_ns) {
+            if (link->journal.tryPop(record)) {
+                apply(record);
+                continue;
+            }
+            char byte;
+            if (read(liveness[0], &byte, 1) == 0) {
+                // EOF: the primary is gone. Whatever it published is still in the ring
+                detected_ns = now_ns();
+                while (link->journal.tryPop(record)) apply(record);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        
+        // Promoted: carry on with the inputs the primary never published
+        int64_t promoted_ns = now_ns();
+        for (size_t i = report.applied; i < inputs.size(); ++i) {
+            applyJournalRecord(engine, inputs[i]);
+            report.taken_over++;
+        }
+        
+        int64_t death_ns = link->primary_death_ns.load();
+        report.lag_p50_us = lag.percentile(0.50) / 1000.0;
+        report.lag_p99_us = lag.percentile(0.99) / 1000.0;
+        report.lag_max_us = lag.max / 1000.0;
+        report.apply_rate = report.applied / std::max(apply_seconds, 1e-9);
+        report.detect_us = (detected_ns - death_ns) / 1000.0;
+        report.failover_ms = (promoted_ns - death_ns) / 1e6;
+        report.final_checksum = engine.getOrderBook().getChecksum();
+        _exit(0);
+    }
+    
+    pid_t primary = fork();
+    if (primary == 0) {
+        close(liveness[0]);
+        MatchingEngine engine(config.symbol);
+        engine.setConsoleLogging(false);
+        engine.setTradeRetention(65536);
+        for (size_t i = 0; i < failover_at; ++i) {
+            JournalRecord record = inputs[i];
+            applyJournalRecord(engine, record);
+            record.checksum = engine.getOrderBook().getChecksum();
+            record.published_ns = now_ns();
+            link->journal.push(record);
+        }
+        // Crash: no destructors, no flushing; the kernel closes the pipe
+        link->primary_death_ns.store(now_ns());
+        _exit(0);
+    }
+    
+    close(liveness[0]);
+    close(liveness[1]);
+    int status = 0;
+    waitpid(primary, &status, 0);
+    waitpid(standby, &status, 0);
+    bool standby_ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    
+    // What the book should look like had the primary never failed
+    MatchingEngine reference(config.symbol);
+    reference.setConsoleLogging(false);
+    reference.setTradeRetention(65536);
+    for (const auto& record : inputs) applyJournalRecord(reference, record);
+    BookChecksum expected = reference.getOrderBook().getChecksum();
+    
+    const StandbyReport& report = link->report;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Standby applied " << report.applied << " journal records, "
+              << report.mismatches << " checksum mismatches" << std::endl;
+    std::cout << "Replication lag: p50 " << report.lag_p50_us << " us, p99 " << report.lag_p99_us
+              << " us, max " << report.lag_max_us << " us" << std::endl;
+    std::cout << "Apply throughput: " << std::setprecision(0) << report.apply_rate << " records/s" << std::endl;
+    std::cout << "Failover: death detected after " << std::setprecision(1) << report.detect_us
+              << " us, standby promoted after " << std::setprecision(3) << report.failover_ms << " ms" << std::endl;
+    std::cout << "Promoted standby processed the remaining " << report.taken_over << " inputs" << std::endl;
+    
+    bool verified = standby_ok && report.mismatches == 0 && report.applied == failover_at &&
+                    report.final_checksum == expected;
+    std::cout << (verified ? "Standby book verified identical" : "Standby book DIVERGED")
+              << " (sequence " << report.final_checksum.sequence << " vs " << expected.sequence
+              << ", hash " << std::hex << report.final_checksum.hash << " vs " << expected.hash
+              << std::dec << ")" << std::endl;
+    std::cout << "=======================================" << std::endl;
+    
+    destroyShared(link);
+}
+
+/**
+ * @brief Client order as routed to a shard
+ */
+struct RoutedOrder {
+    uint64_t order_id = 0;
+    uint64_t price = 0;
+    uint64_t quantity = 0;
+    int64_t routed_ns = 0;            ///< Steady clock when the router forwarded it
+    uint32_t instrument = 0;
+    OrderSide side = OrderSide::BUY;
+    bool end = false;                 ///< End of stream marker
+};
+
+/**
+ * @brief Execution report from a shard to the aggregator
+ */
+struct ExecutionReport {
+    uint64_t buy_order_id = 0;
+    uint64_t sell_order_id = 0;
+    uint64_t price = 0;
+    uint64_t quantity = 0;
+    int64_t routed_ns = 0;            ///< Routing time of the aggressing order
+    uint32_t instrument = 0;
+    bool end = false;                 ///< Shard finished; its ShardStats are final
+};
+
+/**
+ * @brief Per-shard counters, final once the shard sends its end report
+ */
+struct ShardStats {
+    uint64_t orders = 0;
+    uint64_t trades = 0;
+    uint64_t instruments = 0;
+    double busy_seconds = 0;          ///< Time spent inside the engines
+};
+
+/**
+ * @brief Shared memory for the --shards topology
+ *
+ * Each shard has its own input ring (router -> shard) and report ring
+ * (shard -> aggregator), so every ring keeps exactly one producer and
+ * one consumer.
+ */
+struct ShardTopology {
+    static constexpr size_t kMaxShards = 16;
+    static constexpr size_t kMaxInstruments = 1024;
+    
+    std::array<SpscRing<RoutedOrder, 4096>, kMaxShards> inputs;
+    std::array<SpscRing<ExecutionReport, 4096>, kMaxShards> reports;
+    std::array<ShardStats, kMaxShards> shard_stats;
+    std::atomic<int64_t> start_ns{0};
+    
+    // Written by the aggregator
+    std::array<uint64_t, kMaxInstruments> trades{};
+    std::array<uint64_t, kMaxInstruments> volume{};
+    int64_t finish_ns = 0;
+    double report_p50_us = 0;
+    double report_p99_us = 0;
+    double report_max_us = 0;
+};
+
+/**
+ * @brief Shared-nothing sharded engines behind a router process
+ *
+ * Forks N shard processes, each owning the instruments with
+ * instrument % N == shard and one MatchingEngine per instrument, plus a
+ * router that fans the client order stream out to the shards and an
+ * aggregator that merges execution reports and shard statistics. The
+ * processes share nothing but SPSC rings in one anonymous mapping. The
+ * merged result is checked against a single-process run of the same
+ * stream, which also serves as the throughput baseline.
+ */
+void runShards(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    auto now_ns = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    };
+    
+    const size_t shards = std::min(std::max<size_t>(config.num_shards, 1), ShardTopology::kMaxShards);
+    const uint32_t instruments = std::min<uint32_t>(std::max<uint32_t>(config.num_instruments, 1),
+                                                    ShardTopology::kMaxInstruments);
+    
+    std::cout << "\n=== Sharded Engines ===" << std::endl;
+    std::cout << "Shards: " << shards << ", Instruments: " << instruments
+              << ", Orders: " << config.num_orders << std::endl;
+    
+    // Client order stream, instruments drawn uniformly
+    SimulationConfig generator_config = config;
+    if (generator_config.seed == 0) generator_config.seed = 42;
+    OrderGenerator generator(generator_config);
+    std::mt19937_64 rng(generator_config.seed);
+    std::uniform_int_distribution<uint32_t> instrument_dist(0, instruments - 1);
+    std::vector<RoutedOrder> stream;
+    stream.reserve(config.num_orders);
+    for (const auto& order : generator.generateBatch(config.num_orders)) {
+        RoutedOrder routed;
+        routed.order_id = order->getId();
+        routed.side = order->getSide();
+        routed.price = order->getPrice();
+        routed.quantity = order->getQuantity();
+        routed.instrument = instrument_dist(rng);
+        stream.push_back(routed);
+    }
+    
+    auto makeEngines = [&](size_t count, size_t shard) {
+        std::vector<std::unique_ptr<MatchingEngine>> engines;
+        for (size_t i = 0; i < count; ++i) {
+            engines.push_back(std::make_unique<MatchingEngine>(
+                config.symbol + "." + std::to_string(i * shards + shard)));
+            engines.back()->setConsoleLogging(false);
+            engines.back()->setTradeRetention(65536);
+        }
+        return engines;
+    };
+    auto submit = [](MatchingEngine& engine, const RoutedOrder& routed) {
+        engine.submitOrder(std::make_shared<Order>(routed.order_id, routed.side, routed.price, routed.quantity,
+                                                   std::chrono::high_resolution_clock::now()));
+    };
+    
+    ShardTopology* topology = createShared<ShardTopology>();
+    std::vector<pid_t> children;
+    std::cout.flush();
+    
+    for (size_t shard = 0; shard < shards; ++shard) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            auto& input = topology->inputs[shard];
+            auto& reports = topology->reports[shard];
+            ShardStats& stats = topology->shard_stats[shard];
+            
+            // Instrument i lives on shard i % shards, at local slot i / shards
+            auto engines = makeEngines((instruments - shard + shards - 1) / shards, shard);
+            RoutedOrder current;
+            for (size_t slot = 0; slot < engines.size(); ++slot) {
+                uint32_t instrument = static_cast<uint32_t>(slot * shards + shard);
+                engines[slot]->setTradeCallback([&, instrument](const Trade& trade) {
+                    ExecutionReport report;
+                    report.buy_order_id = trade.buy_order_id;
+                    report.sell_order_id = trade.sell_order_id;
+                    report.price = trade.price;
+                    report.quantity = trade.quantity;
+                    report.routed_ns = current.routed_ns;
+                    report.instrument = instrument;
+                    reports.push(report);
+                    stats.trades++;
+                });
+            }
+            stats.instruments = engines.size();
+            
+            while (true) {
+                if (!input.tryPop(current)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (current.end) break;
+                auto start = Clock::now();
+                submit(*engines[current.instrument / shards], current);
+                stats.busy_seconds += std::chrono::duration<double>(Clock::now() - start).count();
+                stats.orders++;
+            }
+            
+            ExecutionReport end;
+            end.end = true;
+            reports.push(end);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    
+    // Aggregator: merges every shard's report ring
+    pid_t aggregator = fork();
+    if (aggregator == 0) {
+        LatencyHistogram report_latency;
+        size_t finished = 0;
+        ExecutionReport report;
+        while (finished < shards) {
+            bool idle = true;
+            for (size_t shard = 0; shard < shards; ++shard) {
+                while (topology->reports[shard].tryPop(report)) {
+                    idle = false;
+                    if (report.end) {
+                        finished++;
+                        break;
+                    }
+                    report_latency.record(now_ns() - report.routed_ns);
+                    topology->trades[report.instrument]++;
+                    topology->volume[report.instrument] += report.quantity;
+                }
+            }
+            if (idle) std::this_thread::yield();
+        }
+        topology->finish_ns = now_ns();
+        topology->report_p50_us = report_latency.percentile(0.50) / 1000.0;
+        topology->report_p99_us = report_latency.percentile(0.99) / 1000.0;
+        topology->report_max_us = report_latency.max / 1000.0;
+        _exit(0);
+    }
+    children.push_back(aggregator);
+    
+    // Router: fans the client stream out by instrument
+    pid_t router = fork();
+    if (router == 0) {
+        topology->start_ns.store(now_ns());
+        for (RoutedOrder routed : stream) {
+            routed.routed_ns = now_ns();
+            topology->inputs[routed.instrument % shards].push(routed);
+        }
+        RoutedOrder end;
+        end.end = true;
+        for (size_t shard = 0; shard < shards; ++shard) {
+            topology->inputs[shard].push(end);
+        }
+        _exit(0);
+    }
+    children.push_back(router);
+    
+    bool children_ok = true;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        children_ok = children_ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    
+    // Same stream through one process, one engine per instrument
+    auto engines = makeEngines(instruments, 0);
+    std::vector<uint64_t> expected_trades(instruments, 0), expected_volume(instruments, 0);
+    for (uint32_t i = 0; i < instruments; ++i) {
+        engines[i]->setTradeCallback([&, i](const Trade& trade) {
+            expected_trades[i]++;
+            expected_volume[i] += trade.quantity;
+        });
+    }
+    auto single_start = Clock::now();
+    for (const auto& routed : stream) {
+        submit(*engines[routed.instrument], routed);
+    }
+    double single_elapsed = std::chrono::duration<double>(Clock::now() - single_start).count();
+    
+    bool matches = children_ok;
+    uint64_t total_trades = 0, total_volume = 0;
+    for (uint32_t i = 0; i < instruments; ++i) {
+        matches = matches && topology->trades[i] == expected_trades[i] && topology->volume[i] == expected_volume[i];
+        total_trades += topology->trades[i];
+        total_volume += topology->volume[i];
+    }
+    
+    std::cout << std::left << std::setw(8) << "shard" << std::right << std::setw(14) << "instruments"
+              << std::setw(12) << "orders" << std::setw(12) << "trades" << std::setw(14) << "busy (ms)" << std::endl;
+    for (size_t shard = 0; shard < shards; ++shard) {
+        const ShardStats& stats = topology->shard_stats[shard];
+        std::cout << std::left << std::setw(8) << shard << std::right << std::setw(14) << stats.instruments
+                  << std::setw(12) << stats.orders << std::setw(12) << stats.trades
+                  << std::setw(14) << std::fixed << std::setprecision(1) << (stats.busy_seconds * 1000.0) << std::endl;
+    }
+    
+    double sharded_elapsed = (topology->finish_ns - topology->start_ns.load()) / 1e9;
+    std::cout << "\nTrades: " << total_trades << ", Volume: " << total_volume << std::endl;
+    std::cout << "Router to aggregator: p50 " << std::setprecision(1) << topology->report_p50_us
+              << " us, p99 " << topology->report_p99_us << " us, max " << topology->report_max_us << " us" << std::endl;
+    std::cout << "Sharded throughput: " << std::setprecision(0)
+              << (config.num_orders / std::max(sharded_elapsed, 1e-9)) << " orders/second" << std::endl;
+    std::cout << "Single-process throughput: "
+              << (config.num_orders / std::max(single_elapsed, 1e-9)) << " orders/second" << std::endl;
+    std::cout << (matches ? "Sharded run matches single-process run" : "Sharded run DIVERGED from single-process run")
+              << std::endl;
+    std::cout << "=======================================" << std::endl;
+    
+    destroyShared(topology);
+}
+
+/**
+ * @brief Heap bytes currently handed out by malloc
+ */
+static size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/**
+ * @brief Add/cancel/match latency as the resting book outgrows the caches
+ *
+ * For each book size from 1k up to --scale-max resting orders, builds a
+ * book with --levels price levels per side (or --queue-depth orders per
+ * level), all of quantity 10, and measures the heap it takes. It then
+ * times three phases of up to 20k operations each:
+ * - passive adds at random levels
+ * - cancels of random resting orders
+ * - aggressive orders that each fill one order at the touch
+ *
+ * The working-set column places the book against the cache sizes the
+ * platform reports. The price index is the one this binary was built
+ * with, so run it once per backend build to get a curve per backend.
+ */
+void runScalingBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    constexpr uint64_t kQuantity = 10;
+    
+    const size_t l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE) > 0 ? sysconf(_SC_LEVEL1_DCACHE_SIZE) : 0;
+    const size_t l2 = sysconf(_SC_LEVEL2_CACHE_SIZE) > 0 ? sysconf(_SC_LEVEL2_CACHE_SIZE) : 0;
+    const size_t l3 = sysconf(_SC_LEVEL3_CACHE_SIZE) > 0 ? sysconf(_SC_LEVEL3_CACHE_SIZE) : 0;
+    auto fits = [&](double bytes) {
+        if (bytes <= l1) return "L1";
+        if (bytes <= l2) return "L2";
+        if (bytes <= l3) return "LLC";
+        return "DRAM";
+    };
+    
+    std::cout << "\n=== Book Size Scaling ===" << std::endl;
+    std::cout << "Price index: " << OrderBook::OrderBook::kPriceIndexName
+              << (config.lazy_cancel ? ", lazy cancel" : "") << std::endl;
+    std::cout << "Caches: L1d " << (l1 >> 10) << " KB, L2 " << (l2 >> 10) << " KB, LLC " << (l3 >> 10) << " KB" << std::endl;
+    std::cout << "Latency in ns (p50/p99/p99.9)" << std::endl;
+    std::cout << std::right << std::setw(10) << "orders" << std::setw(10) << "levels" << std::setw(7) << "depth"
+              << std::setw(9) << "B/order" << std::setw(6) << "fits"
+              << std::setw(20) << "add" << std::setw(20) << "cancel" << std::setw(20) << "match" << std::endl;
+    
+    std::mt19937_64 rng(config.seed ? config.seed : 42);
+    const size_t sizes[] = {1000, 10000, 100000, 1000000, 10000000, 50000000};
+    for (size_t size : sizes) {
+        if (size > config.scale_max_orders) break;
+        
+        const size_t depth_target = std::max<size_t>(config.scale_queue_depth, 1);
+        const size_t levels = std::max<size_t>(config.scale_levels ? config.scale_levels : size / (2 * depth_target), 1);
+        const size_t depth = std::max<size_t>(size / (2 * levels), 1);
+        const uint64_t mid = std::max<uint64_t>(config.base_price, levels + 16);
+        
+        std::vector<Order::OrderID> resting;
+        resting.reserve(2 * levels * depth);
+        size_t heap_before = heapInUse();
+        
+        MatchingEngine engine(config.symbol);
+        engine.setConsoleLogging(false);
+        engine.setTradeRetention(1024);
+        engine.setLazyCancel(config.lazy_cancel);
+        
+        Order::OrderID next_id = 1;
+        auto submit = [&](OrderSide side, uint64_t price) {
+            engine.submitOrder(std::make_shared<Order>(next_id, side, price, kQuantity,
+                                                       std::chrono::high_resolution_clock::now()));
+            return next_id++;
+        };
+        for (size_t d = 0; d < depth; ++d) {
+            for (size_t l = 0; l < levels; ++l) {
+                resting.push_back(submit(OrderSide::BUY, mid - 1 - l));
+                resting.push_back(submit(OrderSide::SELL, mid + 1 + l));
+            }
+        }
+        const size_t book_orders = engine.getOrderBook().getOrderCount();
+        const double bytes_per_order = double(heapInUse() - heap_before) / std::max<size_t>(book_orders, 1);
+        
+        const size_t samples = std::min<size_t>(20000, book_orders / 2);
+        std::uniform_int_distribution<size_t> level_dist(0, levels - 1);
+        auto timed = [](LatencyHistogram& histogram, auto&& op) {
+            auto start = Clock::now();
+            op();
+            histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        };
+        
+        LatencyHistogram add, cancel, match;
+        for (size_t i = 0; i < samples; ++i) {
+            bool buy = rng() & 1;
+            uint64_t price = buy ? mid - 1 - level_dist(rng) : mid + 1 + level_dist(rng);
+            timed(add, [&]() { submit(buy ? OrderSide::BUY : OrderSide::SELL, price); });
+        }
+        // Partial Fisher-Yates: cancel distinct random orders from the original book
+        for (size_t i = 0; i < samples; ++i) {
+            std::swap(resting[i], resting[i + rng() % (resting.size() - i)]);
+            Order::OrderID id = resting[i];
+            timed(cancel, [&]() { engine.cancelOrder(id); });
+        }
+        for (size_t i = 0; i < samples; ++i) {
+            bool buy = i & 1;
+            uint64_t price = buy ? engine.getOrderBook().getBestAsk() : engine.getOrderBook().getBestBid();
+            timed(match, [&]() { submit(buy ? OrderSide::BUY : OrderSide::SELL, price); });
+        }
+        
+        auto cell = [](const LatencyHistogram& histogram) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(0) << histogram.percentile(0.50) << "/"
+                << histogram.percentile(0.99) << "/" << histogram.percentile(0.999);
+            return out.str();
+        };
+        std::cout << std::setw(10) << book_orders << std::setw(10) << levels << std::setw(7) << depth
+                  << std::setw(9) << std::fixed << std::setprecision(1) << bytes_per_order
+                  << std::setw(6) << fits(bytes_per_order * book_orders)
+                  << std::setw(20) << cell(add) << std::setw(20) << cell(cancel) << std::setw(20) << cell(match)
+                  << std::endl;
+    }
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Size and speed of the delta + varint journal and trade log encoding
+ *
+ * Runs a generated order stream (with a cancel after every 10th order)
+ * through an engine, capturing every input as a JournalRecord with its
+ * checksum and every trade. Both streams are block-encoded and decoded
+ * back, and compared with fixed-width records and the CSV trade log.
+ * Decode speed is given in fixed-width bytes produced per second.
+ */
+void runCodecBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "\n=== Journal Encoding Benchmark ===" << std::endl;
+    
+    SimulationConfig generator_config = config;
+    if (generator_config.seed == 0) generator_config.seed = 42;
+    OrderGenerator generator(generator_config);
+    generator.setOwnerCount(config.num_owners);
+    auto orders = generator.generateBatch(config.num_orders);
+    
+    MatchingEngine engine(config.symbol);
+    engine.setConsoleLogging(false);
+    engine.setTradeRetention(1024);
+    std::vector<Trade> trades;
+    engine.setTradeCallback([&trades](const Trade& trade) { trades.push_back(trade); });
+    
+    std::vector<JournalRecord> journal;
+    journal.reserve(orders.size() + orders.size() / 10);
+    auto record = [&](JournalRecord input) {
+        input.sequence = journal.size() + 1;
+        applyJournalRecord(engine, input);
+        input.checksum = engine.getOrderBook().getChecksum();
+        input.published_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+        journal.push_back(input);
+    };
+    for (size_t i = 0; i < orders.size(); ++i) {
+        JournalRecord submit;
+        submit.op = JournalOp::SUBMIT;
+        submit.order_id = orders[i]->getId();
+        submit.side = orders[i]->getSide();
+        submit.price = orders[i]->getPrice();
+        submit.quantity = orders[i]->getQuantity();
+        submit.timestamp = orders[i]->getTimestamp().time_since_epoch().count();
+        submit.owner = orders[i]->getOwner();
+        record(submit);
+        if (i % 10 == 9) {
+            JournalRecord cancel;
+            cancel.op = JournalOp::CANCEL;
+            cancel.order_id = orders[i - 5]->getId();
+            record(cancel);
+        }
+    }
+    
+    size_t csv_bytes = 0;
+    for (const auto& trade : trades) {
+        csv_bytes += trade.toCSV().size() + 1;
+    }
+    
+    std::cout << std::left << std::setw(9) << "stream" << std::right << std::setw(10) << "records"
+              << std::setw(10) << "raw MB" << std::setw(10) << "CSV MB" << std::setw(12) << "encoded MB"
+              << std::setw(8) << "ratio" << std::setw(10) << "B/record"
+              << std::setw(13) << "encode MB/s" << std::setw(13) << "decode GB/s" << std::endl;
+    
+    bool round_trip = true;
+    auto report = [&](const char* name, size_t count, size_t record_bytes, size_t csv, size_t encoded,
+                      double encode_seconds, double decode_seconds, uint64_t decoded) {
+        double raw = double(count) * record_bytes;
+        std::cout << std::left << std::setw(9) << name << std::right << std::setw(10) << count
+                  << std::fixed << std::setprecision(2) << std::setw(10) << raw / 1e6;
+        if (csv) {
+            std::cout << std::setw(10) << csv / 1e6;
+        } else {
+            std::cout << std::setw(10) << "-";
+        }
+        std::cout << std::setw(12) << encoded / 1e6
+                  << std::setw(8) << std::setprecision(1) << raw / std::max<size_t>(encoded, 1)
+                  << std::setw(10) << double(encoded) / std::max<size_t>(count, 1)
+                  << std::setw(13) << std::setprecision(0) << raw / 1e6 / std::max(encode_seconds, 1e-9)
+                  << std::setw(13) << std::setprecision(2)
+                  << double(decoded) * record_bytes / 1e9 / std::max(decode_seconds, 1e-9) << std::endl;
+    };
+    
+    // Decode repeatedly for at least a quarter second to get a stable rate
+    auto timeDecode = [](auto&& decode_all) {
+        uint64_t decoded = 0;
+        auto start = Clock::now();
+        double elapsed = 0;
+        while (elapsed < 0.25) {
+            decoded += decode_all();
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        return std::make_pair(decoded, elapsed);
+    };
+    
+    {
+        JournalEncoder encoder;
+        auto start = Clock::now();
+        for (const auto& input : journal) encoder.append(input);
+        encoder.flush();
+        double encode_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const auto& bytes = encoder.bytes();
+        
+        JournalDecoder check(bytes.data(), bytes.size());
+        JournalRecord decoded;
+        size_t n = 0;
+        while (check.next(decoded)) {
+            const JournalRecord& original = journal[n++];
+            round_trip = round_trip && decoded.sequence == original.sequence &&
+                decoded.order_id == original.order_id && decoded.price == original.price &&
+                decoded.quantity == original.quantity && decoded.timestamp == original.timestamp &&
+                decoded.published_ns == original.published_ns && decoded.checksum == original.checksum &&
+                decoded.op == original.op && decoded.side == original.side && decoded.owner == original.owner;
+        }
+        round_trip = round_trip && n == journal.size();
+        
+        auto [count, seconds] = timeDecode([&bytes]() {
+            JournalDecoder decoder(bytes.data(), bytes.size());
+            JournalRecord out;
+            uint64_t records = 0;
+            while (decoder.next(out)) records++;
+            return records;
+        });
+        report("journal", journal.size(), sizeof(JournalRecord), 0, bytes.size(), encode_seconds, seconds, count);
+    }
+    {
+        TradeLogEncoder encoder;
+        auto start = Clock::now();
+        for (const auto& trade : trades) encoder.append(trade);
+        encoder.flush();
+        double encode_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const auto& bytes = encoder.bytes();
+        
+        TradeLogDecoder check(bytes.data(), bytes.size());
+        Trade decoded(0, 0, 0, 0, {});
+        size_t n = 0;
+        while (check.next(decoded)) {
+            const Trade& original = trades[n++];
+            round_trip = round_trip && decoded.buy_order_id == original.buy_order_id &&
+                decoded.sell_order_id == original.sell_order_id && decoded.price == original.price &&
+                decoded.quantity == original.quantity && decoded.timestamp == original.timestamp &&
+                decoded.buy_owner_id == original.buy_owner_id && decoded.sell_owner_id == original.sell_owner_id;
+        }
+        round_trip = round_trip && n == trades.size();
+        
+        auto [count, seconds] = timeDecode([&bytes]() {
+            TradeLogDecoder decoder(bytes.data(), bytes.size());
+            Trade out(0, 0, 0, 0, {});
+            uint64_t records = 0;
+            while (decoder.next(out)) records++;
+            return records;
+        });
+        report("trades", trades.size(), sizeof(Trade), csv_bytes, bytes.size(), encode_seconds, seconds, count);
+    }
+    
+    std::cout << (round_trip ? "Codec round trip verified" : "Codec round trip FAILED") << std::endl;
+    std::cout << "=======================================" << std::endl;
+}
+
+/**
+ * @brief Print one archived order event
+ */
+void printArchivedEvent(const JournalRecord& record) {
+    static const char* kOps[] = {"SUBMIT", "CANCEL", "AMEND"};
+    std::cout << "  " << kOps[static_cast<int>(record.op)] << " t=" << record.timestamp
+              << " #" << record.sequence << " order " << record.order_id;
+    if (record.op != JournalOp::CANCEL) {
+        std::cout << " " << (record.side == OrderSide::BUY ? "BUY" : "SELL")
+                  << " " << record.quantity << " @ " << record.price;
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Print one archived trade with its own timestamp
+ */
+void printArchivedTrade(const Trade& trade) {
+    std::cout << "  TRADE t=" << trade.timestamp.time_since_epoch().count() << " buy " << trade.buy_order_id
+              << " sell " << trade.sell_order_id << " " << trade.quantity << " @ " << trade.price << std::endl;
+}
+
+/**
+ * @brief Look up every archived event and trade of one order (--lookup-order)
+ */
+void runArchiveOrderLookup(const SimulationConfig& config, uint64_t order_id) {
+    using Clock = std::chrono::steady_clock;
+    std::string directory = config.archive_dir.empty() ? ArchiveConfig().directory : config.archive_dir;
+    
+    auto start = Clock::now();
+    EventArchiveReader archive(directory);
+    ArchiveQueryStats stats;
+    auto events = archive.eventsForOrder(order_id, &stats);
+    auto trades = archive.tradesForOrder(order_id, &stats);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    std::cout << "\n=== Archive Lookup: order " << order_id << " ===" << std::endl;
+    std::cout << "Events (" << events.size() << "):" << std::endl;
+    for (const auto& record : events) printArchivedEvent(record);
+    std::cout << "Trades (" << trades.size() << "):" << std::endl;
+    for (const auto& trade : trades) printArchivedTrade(trade);
+    std::cout << "Touched " << stats.toString() << " in " << std::fixed << std::setprecision(2)
+              << elapsed_ms << " ms" << std::endl;
+}
+
+/**
+ * @brief Archived events and trades in a time range (--lookup-time FROM,TO)
+ */
+void runArchiveTimeLookup(const SimulationConfig& config, int64_t from, int64_t to) {
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t kShown = 20;
+    std::string directory = config.archive_dir.empty() ? ArchiveConfig().directory : config.archive_dir;
+    
+    auto start = Clock::now();
+    EventArchiveReader archive(directory);
+    ArchiveQueryStats stats;
+    auto events = archive.eventsBetween(from, to, &stats);
+    auto trades = archive.tradesBetween(from, to, &stats);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    std::cout << "\n=== Archive Lookup: t in [" << from << ", " << to << "] ===" << std::endl;
+    std::cout << "Events (" << events.size() << "):" << std::endl;
+    for (size_t i = 0; i < std::min(events.size(), kShown); ++i) printArchivedEvent(events[i]);
+    if (events.size() > kShown) std::cout << "  ..." << std::endl;
+    std::cout << "Trades (" << trades.size() << "):" << std::endl;
+    for (size_t i = 0; i < std::min(trades.size(), kShown); ++i) printArchivedTrade(trades[i]);
+    if (trades.size() > kShown) std::cout << "  ..." << std::endl;
+    std::cout << "Touched " << stats.toString() << " in " << std::fixed << std::setprecision(2)
+              << elapsed_ms << " ms" << std::endl;
+}
+
+/**
+ * @brief Write a month of synthetic order flow to an archive and time audit lookups
+ *
+ * --orders events are spread evenly over 30 days; one in five is a
+ * cancel and one in three submits trades against a recent order. A
+ * fifth of the cancels hit a long-resting order from anywhere earlier
+ * in the month, which widens segment ID ranges so the bloom filters,
+ * not the ranges, have to rule segments out. By-order and by-time
+ * (one minute) lookups are checked against counts kept while writing.
+ *
+ * The archive goes to a fresh private directory under the temp
+ * directory, which is removed afterwards. --archive is ignored here: it
+ * names the real audit archive, which must never be written or deleted
+ * by a benchmark.
+ */
+void runArchiveBenchmark(const SimulationConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    namespace fs = std::filesystem;
+    constexpr size_t kQueries = 200;
+    constexpr int64_t kMonth = int64_t(30) * 24 * 3600 * 1000000000LL;
+    constexpr int64_t kMinute = int64_t(60) * 1000000000LL;
+    
+    std::cout << "\n=== Event Archive Benchmark ===" << std::endl;
+    
+    std::string scratch = (fs::temp_directory_path() / "archive_bench.XXXXXX").string();
+    if (!mkdtemp(scratch.data())) {
+        throw std::runtime_error("Cannot create a scratch directory for the archive benchmark");
+    }
+    ArchiveConfig archive_config;
+    archive_config.directory = scratch;
+    std::cout << "Archive: " << archive_config.directory << " (removed afterwards)" << std::endl;
+    
+    std::mt19937_64 rng(config.seed ? config.seed : 42);
+    size_t events = std::max<size_t>(config.num_orders, 1000);
+    int64_t t0 = std::chrono::high_resolution_clock::now().time_since_epoch().count() - kMonth;
+    int64_t step = std::max<int64_t>(kMonth / static_cast<int64_t>(events), 1);
+    
+    // Lookups are chosen up front so their expected answers can be counted while writing
+    std::vector<uint64_t> query_ids(kQueries);
+    std::vector<int64_t> query_starts(kQueries);
+    for (size_t i = 0; i < kQueries; ++i) {
+        query_ids[i] = 1 + rng() % (events * 3 / 4);
+        query_starts[i] = t0 + static_cast<int64_t>(rng() % static_cast<uint64_t>(kMonth - kMinute));
+    }
+    std::unordered_map<uint64_t, std::pair<size_t, size_t>> expected_by_order;
+    for (uint64_t id : query_ids) expected_by_order[id] = {0, 0};
+    std::vector<int64_t> trade_times;
+    
+    auto write_start = Clock::now();
+    uint64_t trade_count = 0;
+    {
+        EventArchiveWriter writer(archive_config);
+        uint64_t next_id = 1;
+        for (size_t i = 0; i < events; ++i) {
+            JournalRecord record;
+            record.sequence = i + 1;
+            record.timestamp = t0 + static_cast<int64_t>(i) * step;
+            uint64_t roll = rng() % 100;
+            if (roll < 20 && next_id > 1) {
+                record.op = JournalOp::CANCEL;
+                uint64_t back = roll < 4 ? 1 + rng() % (next_id - 1) : 1 + rng() % std::min<uint64_t>(next_id - 1, 1000);
+                record.order_id = next_id - back;
+            } else {
+                record.op = JournalOp::SUBMIT;
+                record.order_id = next_id++;
+                record.side = (rng() & 1) ? OrderSide::BUY : OrderSide::SELL;
+                record.price = config.base_price - config.price_range + rng() % (2 * config.price_range + 1);
+                record.quantity = config.min_quantity + rng() % (config.max_quantity - config.min_quantity + 1);
+                record.owner = static_cast<uint32_t>(rng() % config.num_owners);
+            }
+            writer.appendEvent(record);
+            auto expected = expected_by_order.find(record.order_id);
+            if (expected != expected_by_order.end()) expected->second.first++;
+            
+            if (record.op == JournalOp::SUBMIT && record.order_id > 1 && rng() % 3 == 0) {
+                uint64_t resting = record.order_id - 1 - rng() % std::min<uint64_t>(record.order_id - 1, 500);
+                bool buy = record.side == OrderSide::BUY;
+                Trade trade(buy ? record.order_id : resting, buy ? resting : record.order_id,
+                            record.price, record.quantity,
+                            std::chrono::high_resolution_clock::time_point(
+                                std::chrono::high_resolution_clock::duration(record.timestamp + 1000)));
+                writer.appendTrade(trade);
+                trade_times.push_back(record.timestamp + 1000);
+                for (uint64_t id : {trade.buy_order_id, trade.sell_order_id}) {
+                    auto it = expected_by_order.find(id);
+                    if (it != expected_by_order.end()) it->second.second++;
+                }
+                trade_count++;
+            }
+        }
+        writer.close();
+        std::cout << "Wrote " << writer.getEventCount() << " events and " << writer.getTradeCount()
+                  << " trades over 30 days into " << writer.getSegmentCount() << " segments" << std::endl;
+    }
+    double write_seconds = std::chrono::duration<double>(Clock::now() - write_start).count();
+    
+    uint64_t data_bytes = 0, index_bytes = 0;
+    for (const auto& entry : fs::directory_iterator(archive_config.directory)) {
+        (entry.path().extension() == ".seg" ? data_bytes : index_bytes) += entry.file_size();
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "Write rate: " << (events + trade_count) / write_seconds / 1e6 << "M records/s, "
+              << "data " << data_bytes / 1e6 << " MB (" << std::setprecision(2)
+              << double(data_bytes) / (events + trade_count) << " B/record), index "
+              << index_bytes / 1e6 << " MB" << std::endl;
+    
+    auto open_start = Clock::now();
+    EventArchiveReader archive(archive_config.directory);
+    std::cout << "Reader open: " << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(Clock::now() - open_start).count() << " ms for "
+              << archive.getEventSegments().size() + archive.getTradeSegments().size() << " segment summaries"
+              << std::endl;
+    
+    bool verified = true;
+    LatencyHistogram order_latency, time_latency;
+    ArchiveQueryStats order_stats, time_stats;
+    for (size_t i = 0; i < kQueries; ++i) {
+        auto start = Clock::now();
+        auto found_events = archive.eventsForOrder(query_ids[i], &order_stats);
+        auto found_trades = archive.tradesForOrder(query_ids[i], &order_stats);
+        order_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        const auto& expected = expected_by_order[query_ids[i]];
+        verified = verified && found_events.size() == expected.first && found_trades.size() == expected.second;
+    }
+    for (size_t i = 0; i < kQueries; ++i) {
+        int64_t from = query_starts[i], to = from + kMinute;
+        auto start = Clock::now();
+        auto found_events = archive.eventsBetween(from, to, &time_stats);
+        auto found_trades = archive.tradesBetween(from, to, &time_stats);
+        time_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        // Event i sits at t0 + i * step
+        int64_t first = std::max<int64_t>(0, (from - t0 + step - 1) / step);
+        int64_t last = std::min<int64_t>(static_cast<int64_t>(events) - 1, (to - t0) / step);
+        size_t expected_events = last >= first ? static_cast<size_t>(last - first + 1) : 0;
+        size_t expected_trades = std::upper_bound(trade_times.begin(), trade_times.end(), to) -
+                                 std::lower_bound(trade_times.begin(), trade_times.end(), from);
+        verified = verified && found_events.size() == expected_events && found_trades.size() == expected_trades;
+    }
+    
+    auto report = [&](const char* name, const LatencyHistogram& latency, const ArchiveQueryStats& stats) {
+        std::cout << std::left << std::setw(10) << name << std::right << std::setprecision(3)
+                  << std::setw(10) << latency.percentile(0.50) / 1e6
+                  << std::setw(10) << latency.percentile(0.99) / 1e6
+                  << std::setw(10) << latency.max / 1e6 << std::setprecision(1)
+                  << std::setw(10) << double(stats.segments_probed) / kQueries
+                  << std::setw(10) << double(stats.segments_read) / kQueries
+                  << std::setw(10) << double(stats.blocks_decoded) / kQueries
+                  << std::setw(10) << double(stats.bytes_read) / kQueries / 1024 << std::endl;
+    };
+    std::cout << "\nLookups (" << kQueries << " each, events + trades; of "
+              << archive.getEventSegments().size() + archive.getTradeSegments().size() << " segments)" << std::endl;
+    std::cout << std::left << std::setw(10) << "query" << std::right << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << std::setw(10) << "probed"
+              << std::setw(10) << "read" << std::setw(10) << "blocks" << std::setw(10) << "KB" << std::endl;
+    report("by-order", order_latency, order_stats);
+    report("by-time", time_latency, time_stats);
+    
+    fs::remove_all(archive_config.directory);
+    std::cout << (verified ? "Archive lookups verified" : "Archive lookups FAILED") << std::endl;
+    std::cout << "===============================" << std::endl;
+}
+
+/**
+ * @brief Check getMemoryStats() against a known sequence of adds, cancels, trades and tasks
+ *
+ * The book's ID index is reserved before the baseline is taken, so its
+ * bucket array does not grow and a full cancel must bring levels and
+ * index back to exactly the baseline bytes.
+ */
+void runMemoryCheck(const SimulationConfig& config) {
+    std::cout << "\n=== Memory Accounting Check ===" << std::endl;
+    
+    size_t order_count = std::max<size_t>(config.num_orders, 1);
+    bool verified = true;
+    auto expect = [&verified](bool condition, const std::string& what) {
+        std::cout << (condition ? "  ok    " : "  FAIL  ") << what << std::endl;
+        verified = verified && condition;
+    };
+    auto peaks_cover_live = [](const MemoryStats& stats) {
+        for (const MemoryUsage& usage : stats.categories) {
+            if (usage.peak_bytes < usage.live_bytes) return false;
+        }
+        return true;
+    };
+    auto live = [](const MemoryStats& stats, MemoryCategory category) { return stats[category].live_bytes; };
+    
+    // Book: a passive ladder on both sides, then cancel all of it
+    OrderBook::OrderBook book(config.symbol);
+    book.reserve(order_count);
+    MemoryStats baseline = book.getMemoryStats();
+    auto now = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < order_count; ++i) {
+        bool buy = i % 2 == 0;
+        uint64_t offset = 1 + (i / 2) % 100;
+        book.addOrder(std::make_shared<Order>(i + 1, buy ? OrderSide::BUY : OrderSide::SELL,
+                                              buy ? config.base_price - offset : config.base_price + offset,
+                                              100, now));
+    }
+    MemoryStats added = book.getMemoryStats();
+    for (size_t i = 0; i < order_count; ++i) {
+        book.cancelOrder(i + 1);
+    }
+    MemoryStats cancelled = book.getMemoryStats();
+    
+    std::cout << "Book after " << order_count << " adds:\n" << added.toString();
+    expect(live(added, MemoryCategory::LEVELS) > live(baseline, MemoryCategory::LEVELS), "levels grow with adds");
+    expect(live(added, MemoryCategory::ID_INDEX) > live(baseline, MemoryCategory::ID_INDEX), "id index grows with adds");
+    expect(live(cancelled, MemoryCategory::LEVELS) == live(baseline, MemoryCategory::LEVELS), "levels back to baseline after cancels");
+    expect(live(cancelled, MemoryCategory::ID_INDEX) == live(baseline, MemoryCategory::ID_INDEX), "id index back to baseline after cancels");
+    expect(live(cancelled, MemoryCategory::ORDERS) == 0, "no order records left after cancels");
+    expect(cancelled[MemoryCategory::LEVELS].peak_bytes >= live(added, MemoryCategory::LEVELS) &&
+           cancelled[MemoryCategory::ID_INDEX].peak_bytes >= live(added, MemoryCategory::ID_INDEX),
+           "book peaks keep the high-water mark");
+    expect(peaks_cover_live(baseline) && peaks_cover_live(added) && peaks_cover_live(cancelled), "book peak >= live");
+    
+    // Engine: crossing pairs, one trade each
+    MatchingEngine engine(config.symbol);
+    engine.setConsoleLogging(false);
+    MemoryStats before_trades = engine.getMemoryStats();
+    for (size_t i = 0; i < order_count; ++i) {
+        engine.submitOrder(std::make_shared<Order>(2 * i + 1, OrderSide::SELL, config.base_price, 100, now));
+        engine.submitOrder(std::make_shared<Order>(2 * i + 2, OrderSide::BUY, config.base_price, 100, now));
+    }
+    MemoryStats after_trades = engine.getMemoryStats();
+    expect(engine.getTradeCount() == order_count, "one trade per crossing pair");
+    expect(live(after_trades, MemoryCategory::TRADES) > live(before_trades, MemoryCategory::TRADES), "trades grow with fills");
+    expect(peaks_cover_live(after_trades), "engine peak >= live");
+    
+    // Pool: hold the only worker while tasks queue up behind it
+    ThreadPool pool(1);
+    MemoryStats before_tasks = pool.getMemoryStats();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    pool.submitDetached([released]() { released.wait(); });
+    std::vector<std::future<void>> queued;
+    for (size_t i = 0; i < 1000; ++i) {
+        queued.push_back(pool.submit([]() {}));
+    }
+    MemoryStats while_queued = pool.getMemoryStats();
+    release.set_value();
+    for (auto& future : queued) future.get();
+    expect(live(while_queued, MemoryCategory::TASK_QUEUES) > live(before_tasks, MemoryCategory::TASK_QUEUES),
+           "task queues grow with pending tasks");
+    expect(peaks_cover_live(while_queued) && peaks_cover_live(pool.getMemoryStats()), "pool peak >= live");
+    
+    std::cout << (verified ? "Memory accounting verified" : "Memory accounting WRONG") << std::endl;
+    std::cout << "===============================" << std::endl;
+}
+
+/**
+ * @brief Print usage information
+ */
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --benchmark          Run benchmark tests" << std::endl;
+    std::cout << "  --aggressive         Run aggressive order simulation" << std::endl;
+    std::cout << "  --fuzz               Differential fuzz engine vs reference book (--orders commands)" << std::endl;
+    std::cout << "  --jitter             Measure per-core OS jitter next to engine latency" << std::endl;
+    std::cout << "  --cores LIST         Cores for --jitter, e.g. 0-3,6 (default: all)" << std::endl;
+    std::cout << "  --duration-ms N      Jitter measurement time per core (default: 1000)" << std::endl;
+    std::cout << "  --orders N           Number of orders (default: 100000)" << std::endl;
+    std::cout << "  --threads N          Number of threads (default: 4)" << std::endl;
+    std::cout << "  --symbol SYMBOL      Trading symbol (default: AAPL)" << std::endl;
+    std::cout << "  --seed N             RNG seed for reproducible runs" << std::endl;
+    std::cout << "  --warmup             Warm the engine up before live flow (put before --benchmark)" << std::endl;
+    std::cout << "  --soak               Bounded-memory soak run with RSS reporting" << std::endl;
+    std::cout << "  --soak-seconds N     Run the soak for N seconds instead of --orders orders" << std::endl;
+    std::cout << "  --scaling-bench      Add/cancel/match latency and bytes per order vs book size" << std::endl;
+    std::cout << "  --scale-max N        Largest book for --scaling-bench, 1k to 50M (default: 1000000)" << std::endl;
+    std::cout << "  --levels N           Price levels per side for --scaling-bench (default: from depth)" << std::endl;
+    std::cout << "  --queue-depth N      Orders per level for --scaling-bench (default: 16)" << std::endl;
+    std::cout << "  --shards N           Router + N engine processes + aggregator over shared-memory rings" << std::endl;
+    std::cout << "  --instruments N      Instruments for --shards (default: 16)" << std::endl;
+    std::cout << "  --codec-bench        Delta + varint journal and trade log encoding: size and speed" << std::endl;
+    std::cout << "  --archive DIR        Archive order events and trades to DIR (default run; lookups: ./archive)" << std::endl;
+    std::cout << "  --lookup-order ID    Every archived event and trade of one order" << std::endl;
+    std::cout << "  --lookup-time T1,T2  Archived events and trades with T1 <= time <= T2 (clock ticks)" << std::endl;
+    std::cout << "  --archive-bench      Month of synthetic flow into an archive; by-order/by-time lookup latency" << std::endl;
+    std::cout << "  --memory-check       Check live/peak memory accounting against known adds, cancels, trades and tasks" << std::endl;
+    std::cout << "  --standby            Primary + hot standby over a shared-memory journal, with failover" << std::endl;
+    std::cout << "  --failover-at N      Inputs the --standby primary handles before failing (default: 3/4)" << std::endl;
+    std::cout << "  --cancel-bench       Eager vs lazy (tombstone) cancellation on deep queues" << std::endl;
+    std::cout << "  --lazy-cancel        Tombstone cancels in --benchmark, --soak and --fuzz (put first)" << std::endl;
+    std::cout << "  --tier-bench         Map vs B+-tree vs tiered price index on flow at the touch" << std::endl;
+    std::cout << "  --tier-window N      Dense tier width in ticks for --tier-bench (default: 256)" << std::endl;
+    std::cout << "  --index-bench        std::map vs B+-tree price index at 10, 1k and 100k levels" << std::endl;
+    std::cout << "  --alloc-bench        Heap vs pool vs monotonic book memory on add/cancel/match flow" << std::endl;
+    std::cout << "  --striped-bench      Single-lock vs per-level-lock book on passive flow, 1-16 threads" << std::endl;
+    std::cout << "  --reader-bench       Matching latency and reader staleness with concurrent readers" << std::endl;
+    std::cout << "  --readers LIST       Reader thread counts for --reader-bench (default: 0,1,4,16)" << std::endl;
+    std::cout << "  --read-rate N        Reads/s per reader for --reader-bench (default: unthrottled)" << std::endl;
+    std::cout << "  --read-mix D,T,L     Depth:top-of-book:lookup weights for --reader-bench (default: 1,1,1)" << std::endl;
+    std::cout << "  --parallel-bench     Serial vs parallelFor/parallelReduce on offline work" << std::endl;
+    std::cout << "  --pool-bench         Fixed vs elastic ThreadPool on bursty load" << std::endl;
+    std::cout << "  --lanes              Compare ThreadPool lane policies under bulk load" << std::endl;
+    std::cout << "  --positions          Live position/P&L keeping, one instrument per --threads" << std::endl;
+    std::cout << "  --owners N           Accounts for --positions (default: 64)" << std::endl;
+    std::cout << "  --no-csv             Disable CSV logging" << std::endl;
+    std::cout << "  --no-perf            Disable performance monitoring" << std::endl;
+    std::cout << "  --help               Show this help message" << std::endl;
+}
+
+/**
+ * @brief Parse command line arguments
+ */
+SimulationConfig parseArguments(int argc, char* argv[]) {
+    SimulationConfig config;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        
+        if (arg == "--help") {
+            printUsage(argv[0]);
+            exit(0);
+        } else if (arg == "--benchmark") {
+            runBenchmark(config);
+            exit(0);
+        } else if (arg == "--aggressive") {
+            runAggressiveSimulation(config);
+            exit(0);
+        } else if (arg == "--fuzz") {
+            exit(runFuzz(config) ? 0 : 1);
+        } else if (arg == "--jitter") {
+            runJitterAnalysis(config);
+            exit(0);
+        } else if (arg == "--cores" && i + 1 < argc) {
+            config.cores = JitterMonitor::parseCpuList(argv[++i]);
+        } else if (arg == "--duration-ms" && i + 1 < argc) {
+            config.duration_ms = std::stoull(argv[++i]);
+        } else if (arg == "--soak") {
+            runSoak(config);
+            exit(0);
+        } else if (arg == "--scaling-bench") {
+            runScalingBenchmark(config);
+            exit(0);
+        } else if (arg == "--scale-max" && i + 1 < argc) {
+            config.scale_max_orders = std::stoull(argv[++i]);
+        } else if (arg == "--levels" && i + 1 < argc) {
+            config.scale_levels = std::stoull(argv[++i]);
+        } else if (arg == "--queue-depth" && i + 1 < argc) {
+            config.scale_queue_depth = std::stoull(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            config.num_shards = std::stoul(argv[++i]);
+            runShards(config);
+            exit(0);
+        } else if (arg == "--instruments" && i + 1 < argc) {
+            config.num_instruments = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--codec-bench") {
+            runCodecBenchmark(config);
+            exit(0);
+        } else if (arg == "--archive" && i + 1 < argc) {
+            config.archive_dir = argv[++i];
+        } else if (arg == "--lookup-order" && i + 1 < argc) {
+            runArchiveOrderLookup(config, std::stoull(argv[++i]));
+            exit(0);
+        } else if (arg == "--lookup-time" && i + 1 < argc) {
+            std::string range = argv[++i];
+            size_t comma = range.find(',');
+            if (comma == std::string::npos) {
+                throw std::runtime_error("--lookup-time expects FROM,TO");
+            }
+            runArchiveTimeLookup(config, std::stoll(range.substr(0, comma)), std::stoll(range.substr(comma + 1)));
+            exit(0);
+        } else if (arg == "--archive-bench") {
+            runArchiveBenchmark(config);
+            exit(0);
+        } else if (arg == "--memory-check") {
+            runMemoryCheck(config);
+            exit(0);
+        } else if (arg == "--standby") {
+            runStandby(config);
+            exit(0);
+        } else if (arg == "--failover-at" && i + 1 < argc) {
+            config.failover_at = std::stoull(argv[++i]);
+        } else if (arg == "--cancel-bench") {
+            runCancelBenchmark(config);
+            exit(0);
+        } else if (arg == "--lazy-cancel") {
+            config.lazy_cancel = true;
+        } else if (arg == "--tier-bench") {
+            runTierBenchmark(config);
+            exit(0);
+        } else if (arg == "--tier-window" && i + 1 < argc) {
+            config.tier_window = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--index-bench") {
+            runIndexBenchmark(config);
+            exit(0);
+        } else if (arg == "--alloc-bench") {
+            runAllocationBenchmark(config);
+            exit(0);
+        } else if (arg == "--striped-bench") {
+            runStripedBenchmark(config);
+            exit(0);
+        } else if (arg == "--readers" && i + 1 < argc) {
+            config.reader_counts = JitterMonitor::parseCpuList(argv[++i]);
+        } else if (arg == "--read-rate" && i + 1 < argc) {
+            config.read_rate = std::stoull(argv[++i]);
+        } else if (arg == "--read-mix" && i + 1 < argc) {
+            std::stringstream mix(argv[++i]);
+            std::string weight;
+            for (auto& slot : config.read_mix) {
+                slot = std::getline(mix, weight, ',') ? static_cast<uint32_t>(std::stoul(weight)) : 0;
+            }
+        } else if (arg == "--reader-bench") {
+            runReaderBenchmark(config);
+            exit(0);
+        } else if (arg == "--parallel-bench") {
+            runParallelBenchmark(config);
+            exit(0);
+        } else if (arg == "--pool-bench") {
+            runPoolBenchmark(config);
+            exit(0);
+        } else if (arg == "--lanes") {
+            runLaneScheduling(config);
+            exit(0);
+        } else if (arg == "--positions") {
+            runPositionKeeping(config);
             exit(0);
+        } else if (arg == "--owners" && i + 1 < argc) {
+            config.num_owners = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--soak-seconds" && i + 1 < argc) {
+            config.soak_seconds = std::stoull(argv[++i]);
+        } else if (arg == "--warmup") {
+            config.warmup = true;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
         } else if (arg == "--orders" && i + 1 < argc) {
             config.num_orders = std::stoul(argv[++i]);
         } else if (arg == "--threads" && i + 1 < argc) {